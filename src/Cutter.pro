@@ -204,6 +204,15 @@ QMAKE_SUBSTITUTES += CutterConfig.h.in
 SOURCES += \
     Main.cpp \
     core/Cutter.cpp \
+    core/AnalysisDataStore.cpp \
+    core/CompactStringList.cpp \
+    core/StringScanner.cpp \
+    core/PatternScanner.cpp \
+    core/GadgetFinder.cpp \
+    core/ImmediateIndex.cpp \
+    core/TextIndex.cpp \
+    core/XrefGraph.cpp \
+    core/EntropyMap.cpp \
     widgets/DisassemblerGraphView.cpp \
     widgets/OverviewView.cpp \
     common/RichTextPainter.cpp \
@@ -279,7 +288,14 @@ SOURCES += \
     dialogs/OpenFileDialog.cpp \
     common/CommandTask.cpp \
     common/ProgressIndicator.cpp \
+    common/FilterIndex.cpp \
+    common/FuzzyIndex.cpp \
+    common/AddressDensityIndex.cpp \
+    common/IndexedFilterProxyModel.cpp \
+    common/ParallelSortFilterProxyModel.cpp \
+    common/CompactStorage.cpp \
     common/R2Task.cpp \
+    common/SearchTask.cpp \
     widgets/DebugActions.cpp \
     widgets/MemoryMapWidget.cpp \
     dialogs/preferences/DebugOptionsWidget.cpp \
@@ -311,10 +327,23 @@ SOURCES += \
     common/UpdateWorker.cpp \
     widgets/MemoryDockWidget.cpp \
     common/HighDpiPixmap.cpp \
-    widgets/GraphGridLayout.cpp
+    widgets/GraphGridLayout.cpp \
+    widgets/GraphLayeredLayout.cpp \
+    common/CallGraphTask.cpp \
+    widgets/CallGraphView.cpp \
+    widgets/CallGraphWidget.cpp
 
 HEADERS  += \
     core/Cutter.h \
+    core/AnalysisDataStore.h \
+    core/CompactStringList.h \
+    core/StringScanner.h \
+    core/PatternScanner.h \
+    core/GadgetFinder.h \
+    core/ImmediateIndex.h \
+    core/TextIndex.h \
+    core/XrefGraph.h \
+    core/EntropyMap.h \
     core/CutterCommon.h \
     core/CutterDescriptions.h \
     widgets/DisassemblerGraphView.h \
@@ -391,12 +420,19 @@ HEADERS  += \
     widgets/RegistersWidget.h \
     widgets/BacktraceWidget.h \
     dialogs/OpenFileDialog.h \
-    common/StringsTask.h \
-    common/FunctionsTask.h \
     common/CommandTask.h \
     common/ProgressIndicator.h \
+    common/KeyedListModel.h \
+    common/FilterIndex.h \
+    common/FuzzyIndex.h \
+    common/AddressDensityIndex.h \
+    common/IndexedFilterProxyModel.h \
+    common/ParallelSort.h \
+    common/ParallelSortFilterProxyModel.h \
+    common/CompactStorage.h \
     plugins/CutterPlugin.h \
     common/R2Task.h \
+    common/SearchTask.h \
     widgets/DebugActions.h \
     widgets/MemoryMapWidget.h \
     dialogs/preferences/DebugOptionsWidget.h \
@@ -431,7 +467,11 @@ HEADERS  += \
     widgets/MemoryDockWidget.h \
     common/HighDpiPixmap.h \
     widgets/GraphLayout.h \
-    widgets/GraphGridLayout.h
+    widgets/GraphGridLayout.h \
+    widgets/GraphLayeredLayout.h \
+    common/CallGraphTask.h \
+    widgets/CallGraphView.h \
+    widgets/CallGraphWidget.h
 
 FORMS    += \
     dialogs/AboutDialog.ui \
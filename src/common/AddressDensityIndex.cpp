@@ -0,0 +1,179 @@
+#include "common/AddressDensityIndex.h"
+
+#include <algorithm>
+#include <limits>
+
+void AddressDensityIndex::setRange(RVA newFrom, RVA newTo, int requestedBuckets)
+{
+    from = newFrom;
+    to = std::max(newFrom, newTo);
+    RVA span = to - from;
+    if (span == 0 || requestedBuckets <= 0) {
+        bucketSize = 1;
+        bucketCount = 0;
+    } else {
+        RVA buckets = std::min(span, static_cast<RVA>(requestedBuckets));
+        bucketSize = span / buckets + (span % buckets ? 1 : 0);
+        bucketCount = static_cast<size_t>(span / bucketSize + (span % bucketSize ? 1 : 0));
+    }
+
+    for (std::vector<quint64> &column : prefix) {
+        column.assign(bucketCount + 1, 0);
+    }
+    rwx.assign(bucketCount, 0);
+}
+
+void AddressDensityIndex::setSections(const QList<SectionDescription> &sections)
+{
+    RVA newFrom = RVA_MAX;
+    RVA newTo = 0;
+    for (const SectionDescription &section : sections) {
+        if (section.vsize == 0) {
+            continue;
+        }
+        newFrom = std::min(newFrom, section.vaddr);
+        newTo = std::max(newTo, section.vaddr + section.vsize);
+    }
+    if (newFrom >= newTo) {
+        setRange(0, 0);
+        return;
+    }
+    setRange(newFrom, newTo);
+
+    for (const SectionDescription &section : sections) {
+        if (section.vsize == 0) {
+            continue;
+        }
+        // Like "p-j", only r, w and x count, e.g. "-r-x" for a code section
+        ut8 perm = 0;
+        if (section.flags.contains('r')) {
+            perm |= 1 << 0;
+        }
+        if (section.flags.contains('w')) {
+            perm |= 1 << 1;
+        }
+        if (section.flags.contains('x')) {
+            perm |= 1 << 2;
+        }
+        size_t last = bucketOf(section.vaddr + section.vsize - 1);
+        for (size_t i = bucketOf(section.vaddr); i <= last; i++) {
+            rwx[i] |= perm;
+        }
+    }
+}
+
+void AddressDensityIndex::setFunctions(const QList<FunctionDescription> &functions)
+{
+    clear(Functions);
+    clear(InFunctions);
+    std::vector<quint64> &starts = prefix[Functions];
+    std::vector<quint64> &bytes = prefix[InFunctions];
+
+    for (const FunctionDescription &function : functions) {
+        if (function.offset >= from && function.offset < to) {
+            starts[bucketOf(function.offset) + 1]++;
+        }
+
+        RVA begin = std::max(function.offset, from);
+        RVA end = function.offset + function.size < function.offset
+                  ? to : std::min(function.offset + function.size, to);
+        while (begin < end) {
+            size_t bucket = bucketOf(begin);
+            RVA bucketEnd = std::min(from + (bucket + 1) * bucketSize, end);
+            bytes[bucket + 1] += bucketEnd - begin;
+            begin = bucketEnd;
+        }
+    }
+
+    accumulate(Functions);
+    accumulate(InFunctions);
+}
+
+void AddressDensityIndex::setAddresses(Column column, const std::vector<RVA> &addresses)
+{
+    clear(column);
+    std::vector<quint64> &counts = prefix[column];
+    for (RVA address : addresses) {
+        if (address >= from && address < to) {
+            counts[bucketOf(address) + 1]++;
+        }
+    }
+    accumulate(column);
+}
+
+void AddressDensityIndex::addAddresses(Column column, const std::vector<RVA> &addresses)
+{
+    if (bucketCount == 0) {
+        return;
+    }
+    std::vector<quint64> added(bucketCount, 0);
+    for (RVA address : addresses) {
+        if (address >= from && address < to) {
+            added[bucketOf(address)]++;
+        }
+    }
+    std::vector<quint64> &sums = prefix[column];
+    quint64 sum = 0;
+    for (size_t i = 0; i < bucketCount; i++) {
+        sum += added[i];
+        sums[i + 1] += sum;
+    }
+}
+
+BlockStatistics AddressDensityIndex::statistics(int blockCount) const
+{
+    BlockStatistics ret;
+    if (isEmpty() || blockCount <= 0) {
+        ret.from = ret.to = ret.blocksize = 0;
+        return ret;
+    }
+    ret.from = from;
+    ret.to = to;
+
+    RVA span = to - from;
+    RVA blocks = static_cast<RVA>(blockCount);
+    ret.blocksize = span / blocks + (span % blocks ? 1 : 0);
+
+    auto sum = [this](Column column, size_t begin, size_t end) {
+        quint64 count = prefix[column][end] - prefix[column][begin];
+        return static_cast<int>(std::min<quint64>(count, std::numeric_limits<int>::max()));
+    };
+
+    for (RVA addr = from; addr < to && addr >= from; addr += ret.blocksize) {
+        RVA size = std::min(ret.blocksize, to - addr);
+        size_t begin = bucketOf(addr);
+        // Blocks smaller than a bucket show the whole bucket
+        size_t end = std::max(begin + 1, addr + size >= to ? bucketCount : bucketOf(addr + size));
+
+        BlockDescription block;
+        block.addr = addr;
+        block.size = size;
+        block.functions = sum(Functions, begin, end);
+        block.inFunctions = sum(InFunctions, begin, end);
+        block.strings = sum(Strings, begin, end);
+        block.symbols = sum(Symbols, begin, end);
+        block.flags = sum(Flags, begin, end);
+        block.comments = sum(Comments, begin, end);
+        block.rwx = rwx[begin];
+        ret.blocks << block;
+    }
+    return ret;
+}
+
+size_t AddressDensityIndex::bucketOf(RVA address) const
+{
+    return static_cast<size_t>((address - from) / bucketSize);
+}
+
+void AddressDensityIndex::clear(Column column)
+{
+    prefix[column].assign(bucketCount + 1, 0);
+}
+
+void AddressDensityIndex::accumulate(Column column)
+{
+    std::vector<quint64> &sums = prefix[column];
+    for (size_t i = 1; i < sums.size(); i++) {
+        sums[i] += sums[i - 1];
+    }
+}
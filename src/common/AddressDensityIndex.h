@@ -0,0 +1,78 @@
+#ifndef ADDRESSDENSITYINDEX_H
+#define ADDRESSDENSITYINDEX_H
+
+#include <QList>
+
+#include <array>
+#include <vector>
+
+#include "core/CutterCommon.h"
+#include "core/CutterDescriptions.h"
+
+/**
+ * @brief What is where in the address space, at a fixed resolution, for overviews like the
+ * VisualNavbar.
+ *
+ * The range covered by the sections is split into equally sized buckets and every column holds
+ * the prefix sums of its per-bucket counts. Any number of blocks can then be computed from it
+ * in linear time of the block count, without asking the core again. Columns are filled
+ * independently, so a change to the flags doesn't require the functions to be counted again.
+ */
+class AddressDensityIndex
+{
+public:
+    enum Column { Functions, InFunctions, Strings, Symbols, Flags, Comments, ColumnCount };
+
+    static const int defaultBucketCount = 1 << 16;
+
+    /**
+     * @brief Cover from to to, which clears all columns
+     */
+    void setRange(RVA from, RVA to, int bucketCount = defaultBucketCount);
+    /**
+     * @brief Cover the sections and take the permissions from them
+     */
+    void setSections(const QList<SectionDescription> &sections);
+
+    bool isEmpty() const                        { return to <= from; }
+    RVA getFrom() const                         { return from; }
+    RVA getTo() const                           { return to; }
+
+    /**
+     * @brief Count the function starts and the bytes in functions
+     */
+    void setFunctions(const QList<FunctionDescription> &functions);
+
+    /**
+     * @brief Replace the counts of column by one per address of addresses
+     */
+    void setAddresses(Column column, const std::vector<RVA> &addresses);
+    /**
+     * @brief Add one per address of addresses to column, without clearing it
+     */
+    void addAddresses(Column column, const std::vector<RVA> &addresses);
+
+    /**
+     * @brief Aggregate the buckets into blockCount blocks of the same size, like "p-j"
+     */
+    BlockStatistics statistics(int blockCount) const;
+
+private:
+    RVA from = 0;
+    RVA to = 0;
+    RVA bucketSize = 1;
+    size_t bucketCount = 0;
+
+    // prefix[column][i] is the sum of the counts of the buckets before bucket i
+    std::array<std::vector<quint64>, ColumnCount> prefix;
+    std::vector<ut8> rwx;
+
+    size_t bucketOf(RVA address) const;
+    void clear(Column column);
+    /**
+     * @brief Turn per-bucket counts, stored shifted by one, into prefix sums
+     */
+    void accumulate(Column column);
+};
+
+#endif // ADDRESSDENSITYINDEX_H
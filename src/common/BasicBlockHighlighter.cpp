@@ -20,6 +20,7 @@ void BasicBlockHighlighter::highlight(RVA address, const QColor &color)
     block->address = address;
     block->color = color;
     bbMap[address] = block;
+    generation++;
 }
 
 /**
@@ -28,6 +29,7 @@ void BasicBlockHighlighter::highlight(RVA address, const QColor &color)
 void BasicBlockHighlighter::clear(RVA address)
 {
     bbMap.erase(address);
+    generation++;
 }
 
 /**
@@ -23,8 +23,14 @@ public:
     void clear(RVA address);
     BasicBlock *getBasicBlock(RVA address);
 
+    /**
+     * @return incremented by every highlight() and clear(), for caches of the highlighted blocks
+     */
+    quint64 getGeneration() const { return generation; }
+
 private:
     std::map<RVA, BasicBlock*> bbMap;
+    quint64 generation = 0;
 };
 
 #endif   // BASICBLOCKHIGHLIGHTER_H
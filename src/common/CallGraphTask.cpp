@@ -0,0 +1,50 @@
+#include "common/CallGraphTask.h"
+#include "widgets/GraphLayeredLayout.h"
+
+#include <algorithm>
+
+// Names longer than this are elided in the nodes
+static const int maxNameLength = 40;
+
+CallGraphTask::CallGraphTask(qreal charWidth, int charHeight, int padding)
+    : AsyncTask(),
+      charWidth(charWidth),
+      charHeight(charHeight),
+      padding(padding)
+{
+}
+
+void CallGraphTask::runTask()
+{
+    log(tr("Collecting functions and calls..."));
+    QList<CallGraphNodeDescription> nodes = Core()->getCallGraph();
+    if (isInterrupted()) {
+        return;
+    }
+
+    log(tr("Laying out %1 functions...").arg(nodes.size()));
+    CallGraphLayoutResult layoutResult;
+    layoutResult.blocks.reserve(nodes.size());
+    for (const CallGraphNodeDescription &node : nodes) {
+        GraphLayout::GraphBlock block;
+        block.entry = node.offset;
+        block.width = int(std::min(node.name.length(), maxNameLength) * charWidth) + 2 * padding;
+        block.height = charHeight + 2 * padding;
+        for (RVA callee : node.callees) {
+            GraphLayout::GraphEdge edge;
+            edge.target = callee;
+            block.edges.push_back(edge);
+        }
+        layoutResult.blocks[node.offset] = block;
+        layoutResult.nodes.insert(node.offset, node);
+    }
+
+    GraphLayeredLayout layout;
+    layout.CalculateLayout(layoutResult.blocks, 0, layoutResult.width, layoutResult.height);
+    if (isInterrupted()) {
+        return;
+    }
+
+    result = std::move(layoutResult);
+    emit layoutFinished();
+}
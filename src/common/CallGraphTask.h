@@ -0,0 +1,54 @@
+#ifndef CALLGRAPHTASK_H
+#define CALLGRAPHTASK_H
+
+#include "common/AsyncTask.h"
+#include "core/Cutter.h"
+#include "widgets/GraphLayout.h"
+
+#include <QHash>
+
+#include <unordered_map>
+
+/**
+ * @brief Result of a CallGraphTask, blocks are keyed by function address
+ * and already carry their final position.
+ */
+struct CallGraphLayoutResult {
+    std::unordered_map<ut64, GraphLayout::GraphBlock> blocks;
+    QHash<ut64, CallGraphNodeDescription> nodes;
+    int width = 0;
+    int height = 0;
+};
+
+/**
+ * @brief Fetches the call graph of all functions and lays it out outside of the GUI thread.
+ */
+class CallGraphTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    CallGraphTask(qreal charWidth, int charHeight, int padding);
+
+    QString getTitle() override                     { return tr("Building Call Graph"); }
+
+    /**
+     * @brief Move the result out of the task, only valid after layoutFinished has been emitted.
+     */
+    CallGraphLayoutResult takeResult()              { return std::move(result); }
+
+signals:
+    void layoutFinished();
+
+protected:
+    void runTask() override;
+
+private:
+    qreal charWidth;
+    int charHeight;
+    int padding;
+
+    CallGraphLayoutResult result;
+};
+
+#endif // CALLGRAPHTASK_H
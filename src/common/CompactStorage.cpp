@@ -0,0 +1,114 @@
+#include "common/CompactStorage.h"
+
+#include <algorithm>
+
+quint32 StringInterner::intern(const QString &string)
+{
+    auto it = ids.constFind(string);
+    if (it != ids.constEnd()) {
+        return it.value();
+    }
+    quint32 id = static_cast<quint32>(strings.count());
+    ids.insert(string, id);
+    strings.append(string);
+    return id;
+}
+
+void StringArena::reserve(size_t strings, size_t chars)
+{
+    offsets.reserve(strings + 1);
+    this->chars.reserve(chars);
+}
+
+void StringArena::squeeze()
+{
+    offsets.shrink_to_fit();
+    chars.shrink_to_fit();
+}
+
+void StringArena::append(const QString &string)
+{
+    chars.insert(chars.end(), string.constData(), string.constData() + string.size());
+    offsets.push_back(chars.size());
+}
+
+QString StringArena::at(size_t i) const
+{
+    return QString(chars.data() + offsets[i], length(i));
+}
+
+bool StringArena::less(size_t i, size_t j) const
+{
+    const QChar *data = chars.data();
+    return std::lexicographical_compare(data + offsets[i], data + offsets[i + 1],
+                                        data + offsets[j], data + offsets[j + 1]);
+}
+
+bool StringArena::less(size_t i, const StringArena &other, size_t j) const
+{
+    return std::lexicographical_compare(chars.data() + offsets[i], chars.data() + offsets[i + 1],
+                                        other.chars.data() + other.offsets[j],
+                                        other.chars.data() + other.offsets[j + 1]);
+}
+
+bool StringArena::contains(size_t i, const QRegExp &regExp) const
+{
+    return rawString(i).contains(regExp);
+}
+
+bool StringArena::contains(size_t i, QRegExp &regExp) const
+{
+    return rawString(i).contains(regExp);
+}
+
+size_t StringArena::memoryUsage() const
+{
+    return chars.capacity() * sizeof(QChar) + offsets.capacity() * sizeof(size_t);
+}
+
+QString StringArena::rawString(size_t i) const
+{
+    int size = length(i);
+    if (size == 0) {
+        return QString(QLatin1String(""));
+    }
+    return QString::fromRawData(chars.data() + offsets[i], size);
+}
+
+QByteArray DeltaCoding::encode(const std::vector<quint64> &values)
+{
+    QByteArray encoded;
+    encoded.reserve(static_cast<int>(values.size()) * 2);
+    quint64 previous = 0;
+    for (quint64 value : values) {
+        quint64 delta = value - previous;
+        previous = value;
+        while (delta >= 0x80) {
+            encoded += static_cast<char>((delta & 0x7f) | 0x80);
+            delta >>= 7;
+        }
+        encoded += static_cast<char>(delta);
+    }
+    encoded.squeeze();
+    return encoded;
+}
+
+void DeltaCoding::decode(const QByteArray &encoded, std::vector<quint64> &values)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(encoded.constData());
+    const uchar *end = p + encoded.size();
+    quint64 previous = 0;
+    while (p < end) {
+        quint64 delta = 0;
+        int shift = 0;
+        while (p < end && (*p & 0x80)) {
+            delta |= static_cast<quint64>(*p++ & 0x7f) << shift;
+            shift += 7;
+        }
+        if (p < end) {
+            delta |= static_cast<quint64>(*p++) << shift;
+        }
+        previous += delta;
+        values.push_back(previous);
+    }
+}
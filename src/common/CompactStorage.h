@@ -0,0 +1,102 @@
+#ifndef COMPACTSTORAGE_H
+#define COMPACTSTORAGE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include <QRegExp>
+
+#include <vector>
+
+/**
+ * @brief Maps repeated strings like types, sections or calling conventions to small ids.
+ *
+ * Every distinct string is stored once, tables keep the id instead of a QString per entry.
+ */
+class StringInterner
+{
+public:
+    quint32 intern(const QString &string);
+
+    const QString &at(quint32 id) const         { return strings.at(static_cast<int>(id)); }
+    int count() const                           { return strings.count(); }
+
+private:
+    QHash<QString, quint32> ids;
+    QVector<QString> strings;
+};
+
+/**
+ * @brief Append-only store for many strings in one contiguous buffer.
+ *
+ * An entry costs its characters plus one offset, instead of a separately allocated QString.
+ */
+class StringArena
+{
+public:
+    void reserve(size_t strings, size_t chars);
+    void squeeze();
+
+    void append(const QString &string);
+
+    size_t count() const                        { return offsets.size() - 1; }
+    int length(size_t i) const                  { return static_cast<int>(offsets[i + 1] - offsets[i]); }
+
+    /**
+     * @return a copy of string i
+     */
+    QString at(size_t i) const;
+
+    /**
+     * @brief Same as at(i) < at(j), without copying either string
+     */
+    bool less(size_t i, size_t j) const;
+    /**
+     * @brief Same as at(i) < other.at(j), without copying either string
+     */
+    bool less(size_t i, const StringArena &other, size_t j) const;
+
+    /**
+     * @brief Same as at(i).contains(regExp), without copying the string
+     */
+    bool contains(size_t i, const QRegExp &regExp) const;
+    /**
+     * @brief Same as above, matching with regExp itself instead of a copy
+     */
+    bool contains(size_t i, QRegExp &regExp) const;
+
+    /**
+     * @return approximate heap usage in bytes
+     */
+    size_t memoryUsage() const;
+
+private:
+    /**
+     * @return string i referencing the buffer, only valid until the next append()
+     */
+    QString rawString(size_t i) const;
+
+    std::vector<QChar> chars;
+    // offsets[i] is the start of string i, offsets[count()] the end of the last one
+    std::vector<size_t> offsets = { 0 };
+};
+
+/**
+ * @brief Sorted lists of 64 bit values, like addresses, stored as the deltas between them.
+ *
+ * Deltas take 7 bits per byte with the high bit set on all but the last byte, so values close
+ * to each other take one or two bytes.
+ */
+namespace DeltaCoding {
+
+QByteArray encode(const std::vector<quint64> &values);
+
+/**
+ * @brief Append the values of encoded to values
+ */
+void decode(const QByteArray &encoded, std::vector<quint64> &values);
+
+}
+
+#endif // COMPACTSTORAGE_H
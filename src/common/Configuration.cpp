@@ -130,6 +130,7 @@ void Configuration::resetAll()
     QFile settingsFile(s.fileName());
     settingsFile.remove();
     s.clear();
+    colorCache.clear();
 
     loadInitial();
     emit fontsUpdated();
@@ -368,6 +369,11 @@ QString Configuration::getLogoFile()
 void Configuration::setColor(const QString &name, const QColor &color)
 {
     s.setValue("colors." + name, color);
+    if (name == "other") {
+        // Also the color of all names that fell back to it
+        colorCache.clear();
+    }
+    colorCache.insert(name, color);
 }
 
 void Configuration::setLastThemeOf(const CutterQtTheme &currQtTheme, const QString &theme)
@@ -377,15 +383,25 @@ void Configuration::setLastThemeOf(const CutterQtTheme &currQtTheme, const QStri
 
 const QColor Configuration::getColor(const QString &name) const
 {
+    auto it = colorCache.constFind(name);
+    if (it != colorCache.constEnd()) {
+        return it.value();
+    }
+
+    QColor color;
     if (s.contains("colors." + name)) {
-        return s.value("colors." + name).value<QColor>();
+        color = s.value("colors." + name).value<QColor>();
     } else {
-        return s.value("colors.other").value<QColor>();
+        color = s.value("colors.other").value<QColor>();
     }
+    colorCache.insert(name, color);
+    return color;
 }
 
 void Configuration::setColorTheme(const QString &theme)
 {
+    // Colors that fell back to "other" have to be looked up again
+    colorCache.clear();
     if (theme == "default") {
         Core()->cmd("ecd");
         s.setValue("theme", "default");
@@ -403,7 +419,7 @@ void Configuration::setColorTheme(const QString &theme)
         if (rgb.size() != 3) {
             continue;
         }
-        s.setValue("colors." + it.key(), QColor(rgb[0].toInt(), rgb[1].toInt(), rgb[2].toInt()));
+        setColor(it.key(), QColor(rgb[0].toInt(), rgb[1].toInt(), rgb[2].toInt()));
     }
 
     QMap<QString, QColor> cutterSpecific = ColorSchemeFileWorker().getCutterSpecific();
@@ -3,6 +3,7 @@
 
 #include <QSettings>
 #include <QFont>
+#include <QHash>
 #include <core/Cutter.h>
 
 #define Config() (Configuration::instance())
@@ -27,6 +28,12 @@ private:
     QSettings s;
     static Configuration *mPtr;
 
+    /**
+     * @brief In-memory copy of the "colors." settings, so that getColor in paint paths
+     * doesn't have to go through QSettings. Filled by setColor and lazily by getColor.
+     */
+    mutable QHash<QString, QColor> colorCache;
+
     // Colors
     void loadBaseThemeNative();
     void loadBaseThemeDark();
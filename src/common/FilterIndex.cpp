@@ -0,0 +1,321 @@
+#include "common/FilterIndex.h"
+
+#include <cctype>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+/**
+ * @brief Collect the distinct case folded trigrams of text into trigrams, sorted.
+ */
+void collectTrigrams(const QString &text, std::vector<quint64> &trigrams)
+{
+    trigrams.clear();
+    if (text.size() < 3) {
+        return;
+    }
+    quint64 a = text.at(0).toCaseFolded().unicode();
+    quint64 b = text.at(1).toCaseFolded().unicode();
+    for (int i = 2; i < text.size(); i++) {
+        quint64 c = text.at(i).toCaseFolded().unicode();
+        trigrams.push_back((a << 32) | (b << 16) | c);
+        a = b;
+        b = c;
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+/**
+ * @brief Position after the character class starting at the '[' at start.
+ */
+int skipCharacterClass(const QString &pattern, int start, bool escapes)
+{
+    int i = start + 1;
+    if (i < pattern.size() && (pattern.at(i) == '^' || pattern.at(i) == '!')) {
+        i++;
+    }
+    // A ']' directly after the opening bracket is part of the class
+    if (i < pattern.size() && pattern.at(i) == ']') {
+        i++;
+    }
+    while (i < pattern.size() && pattern.at(i) != ']') {
+        if (escapes && pattern.at(i) == '\\') {
+            i++;
+        }
+        i++;
+    }
+    return i + 1;
+}
+
+QStringList wildcardLiterals(const QString &pattern, bool escapes)
+{
+    QStringList literals;
+    QString current;
+    for (int i = 0; i < pattern.size(); i++) {
+        QChar c = pattern.at(i);
+        if (escapes && c == '\\' && i + 1 < pattern.size()) {
+            current += pattern.at(++i);
+        } else if (c == '*' || c == '?' || c == '[') {
+            if (!current.isEmpty()) {
+                literals << current;
+                current.clear();
+            }
+            if (c == '[') {
+                i = skipCharacterClass(pattern, i, escapes) - 1;
+            }
+        } else {
+            current += c;
+        }
+    }
+    if (!current.isEmpty()) {
+        literals << current;
+    }
+    return literals;
+}
+
+QStringList regExpLiterals(const QString &pattern)
+{
+    // Anything below an alternation or a negative lookahead is not required
+    // and handling it exactly is not worth it for a quick filter.
+    if (pattern.contains(QLatin1String("(?!"))) {
+        return QStringList();
+    }
+
+    QStringList literals;
+    QString current;
+    // Size of literals when each open group started
+    QList<int> groupStarts;
+    // Size of literals when the group that was closed last started, -1 if the last atom was no group
+    int closedGroupStart = -1;
+    bool lastWasChar = false;
+
+    auto flush = [&]() {
+        if (!current.isEmpty()) {
+            literals << current;
+            current.clear();
+        }
+    };
+
+    for (int i = 0; i < pattern.size(); i++) {
+        QChar c = pattern.at(i);
+        int groupStart = closedGroupStart;
+        closedGroupStart = -1;
+
+        if (c == '*' || c == '?' || c == '{') {
+            // The previous atom may be missing from a match
+            if (lastWasChar) {
+                current.chop(1);
+            } else if (groupStart >= 0) {
+                while (literals.size() > groupStart) {
+                    literals.removeLast();
+                }
+            }
+            flush();
+            if (c == '{') {
+                while (i < pattern.size() && pattern.at(i) != '}') {
+                    i++;
+                }
+            }
+            lastWasChar = false;
+            continue;
+        }
+
+        lastWasChar = false;
+        if (c == '|') {
+            return QStringList();
+        } else if (c == '\\') {
+            if (i + 1 >= pattern.size()) {
+                break;
+            }
+            QChar next = pattern.at(++i);
+            if (next.isLetterOrNumber()) {
+                // Character class, assertion, back reference or character code. The arguments
+                // of codes like \x41, \0101 or \cA are skipped, they aren't literal text.
+                flush();
+                if (next == 'c') {
+                    i++;
+                } else if (next == 'x' && i + 1 < pattern.size() && pattern.at(i + 1) == '{') {
+                    int close = pattern.indexOf('}', i + 1);
+                    i = close < 0 ? pattern.size() - 1 : close;
+                } else if (next == 'x' || next == 'u' || next.isDigit()) {
+                    bool hex = next == 'x' || next == 'u';
+                    int digits = next == '0' ? 3 : 4;
+                    while (digits-- > 0 && i + 1 < pattern.size()
+                           && (hex ? isxdigit(pattern.at(i + 1).toLatin1()) : pattern.at(i + 1).isDigit())) {
+                        i++;
+                    }
+                }
+            } else {
+                current += next;
+                lastWasChar = true;
+            }
+        } else if (c == '[') {
+            flush();
+            i = skipCharacterClass(pattern, i, true) - 1;
+        } else if (c == '(') {
+            flush();
+            groupStarts.append(literals.size());
+            if (i + 1 < pattern.size() && pattern.at(i + 1) == '?') {
+                // (?: or (?=
+                i += 2;
+            }
+        } else if (c == ')') {
+            flush();
+            if (!groupStarts.isEmpty()) {
+                closedGroupStart = groupStarts.takeLast();
+            }
+        } else if (c == '.' || c == '^' || c == '$' || c == '+') {
+            // '+' keeps the previous atom, but it may repeat
+            flush();
+        } else {
+            current += c;
+            lastWasChar = true;
+        }
+    }
+    flush();
+    return literals;
+}
+
+}
+
+FilterIndex::FilterIndex(const QStringList &texts)
+    : rows(texts.size())
+{
+    // Count first so that all postings fit into one array without reallocation
+    std::vector<quint64> rowTrigrams;
+    for (const QString &text : texts) {
+        collectTrigrams(text, rowTrigrams);
+        for (quint64 trigram : rowTrigrams) {
+            trigrams[trigram].count++;
+        }
+    }
+
+    quint32 offset = 0;
+    for (auto it = trigrams.begin(); it != trigrams.end(); ++it) {
+        it->begin = offset;
+        offset += it->count;
+        it->count = 0;
+    }
+    postings.resize(offset);
+
+    for (int row = 0; row < texts.size(); row++) {
+        collectTrigrams(texts.at(row), rowTrigrams);
+        for (quint64 trigram : rowTrigrams) {
+            Range &range = trigrams[trigram];
+            postings[range.begin + range.count++] = static_cast<quint32>(row);
+        }
+    }
+}
+
+FilterIndex::FilterIndex(const FilterIndex &previous, const QStringList &appended)
+    : rows(previous.rows + appended.size())
+{
+    QHash<quint64, std::vector<quint32>> added;
+    std::vector<quint64> rowTrigrams;
+    for (int i = 0; i < appended.size(); i++) {
+        collectTrigrams(appended.at(i), rowTrigrams);
+        for (quint64 trigram : rowTrigrams) {
+            added[trigram].push_back(static_cast<quint32>(previous.rows + i));
+        }
+    }
+
+    trigrams = previous.trigrams;
+    for (auto it = added.constBegin(); it != added.constEnd(); ++it) {
+        trigrams[it.key()].count += static_cast<quint32>(it.value().size());
+    }
+    quint32 offset = 0;
+    for (auto it = trigrams.begin(); it != trigrams.end(); ++it) {
+        it->begin = offset;
+        offset += it->count;
+    }
+    postings.resize(offset);
+
+    // The appended rows come after all rows of previous, so the postings stay sorted
+    for (auto it = trigrams.constBegin(); it != trigrams.constEnd(); ++it) {
+        quint32 *out = postings.data() + it->begin;
+        auto old = previous.trigrams.constFind(it.key());
+        if (old != previous.trigrams.constEnd()) {
+            const quint32 *begin = previous.postings.data() + old->begin;
+            out = std::copy(begin, begin + old->count, out);
+        }
+        auto rowsAdded = added.constFind(it.key());
+        if (rowsAdded != added.constEnd()) {
+            std::copy(rowsAdded->begin(), rowsAdded->end(), out);
+        }
+    }
+}
+
+QStringList FilterIndex::requiredLiterals(const QRegExp &regExp)
+{
+    switch (regExp.patternSyntax()) {
+    case QRegExp::FixedString:
+        return QStringList(regExp.pattern());
+    case QRegExp::Wildcard:
+        return wildcardLiterals(regExp.pattern(), false);
+    case QRegExp::WildcardUnix:
+        return wildcardLiterals(regExp.pattern(), true);
+    case QRegExp::RegExp:
+    case QRegExp::RegExp2:
+        return regExpLiterals(regExp.pattern());
+    default:
+        return QStringList();
+    }
+}
+
+bool FilterIndex::candidateRows(const QRegExp &regExp, QBitArray &candidates) const
+{
+    std::vector<Range> ranges;
+    std::vector<quint64> literalTrigrams;
+    bool missing = false;
+    for (const QString &literal : requiredLiterals(regExp)) {
+        collectTrigrams(literal, literalTrigrams);
+        for (quint64 trigram : literalTrigrams) {
+            auto it = trigrams.constFind(trigram);
+            if (it == trigrams.constEnd()) {
+                missing = true;
+                break;
+            }
+            ranges.push_back(it.value());
+        }
+    }
+
+    if (!missing && ranges.empty()) {
+        return false;
+    }
+
+    candidates = QBitArray(rows);
+    if (missing) {
+        return true;
+    }
+
+    // Intersect the posting lists, smallest first so that the intermediate results stay small
+    std::sort(ranges.begin(), ranges.end(), [](const Range & a, const Range & b) {
+        return a.count < b.count;
+    });
+    const quint32 *first = postings.data() + ranges.front().begin;
+    std::vector<quint32> result(first, first + ranges.front().count);
+    std::vector<quint32> intersection;
+    for (size_t i = 1; i < ranges.size() && !result.empty(); i++) {
+        const quint32 *begin = postings.data() + ranges[i].begin;
+        intersection.clear();
+        std::set_intersection(result.begin(), result.end(), begin, begin + ranges[i].count,
+                              std::back_inserter(intersection));
+        result.swap(intersection);
+    }
+
+    for (quint32 row : result) {
+        candidates.setBit(static_cast<int>(row));
+    }
+    return true;
+}
+
+void FilterIndexTask::runTask()
+{
+    if (previous) {
+        index = QSharedPointer<const FilterIndex>(new FilterIndex(*previous, texts));
+    } else {
+        index = QSharedPointer<const FilterIndex>(new FilterIndex(texts));
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef FILTERINDEX_H
+#define FILTERINDEX_H
+
+#include <QStringList>
+#include <QBitArray>
+#include <QRegExp>
+#include <QHash>
+#include <QSharedPointer>
+
+#include <vector>
+
+#include "common/AsyncTask.h"
+
+/**
+ * @brief Trigram index over one text per row, used to find the rows that can contain
+ * a substring without looking at every row.
+ *
+ * The index is immutable once built. Texts are case folded, so the candidates it returns are a
+ * superset of the matches for both case sensitive and insensitive patterns and still have to be
+ * verified.
+ */
+class FilterIndex
+{
+public:
+    explicit FilterIndex(const QStringList &texts);
+    /**
+     * @brief Index of the rows of previous followed by appended, which are indexed on their own
+     * and merged into the postings of previous.
+     */
+    FilterIndex(const FilterIndex &previous, const QStringList &appended);
+
+    int rowCount() const                        { return rows; }
+
+    /**
+     * @brief Compute the rows that may contain a match of regExp.
+     * @return false if the pattern has no literal of at least three characters that every match
+     * must contain, the index can't narrow it down then and candidates is left untouched.
+     */
+    bool candidateRows(const QRegExp &regExp, QBitArray &candidates) const;
+
+    /**
+     * @brief Literal strings that every match of regExp must contain, empty if unknown.
+     */
+    static QStringList requiredLiterals(const QRegExp &regExp);
+
+private:
+    struct Range {
+        quint32 begin;
+        quint32 count;
+    };
+
+    int rows;
+    // Trigram -> range of the rows containing it in postings
+    QHash<quint64, Range> trigrams;
+    std::vector<quint32> postings;
+};
+
+class FilterIndexTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param previous if set, texts are the rows appended to it
+     */
+    explicit FilterIndexTask(const QStringList &texts,
+                             const QSharedPointer<const FilterIndex> &previous = QSharedPointer<const FilterIndex>())
+        : texts(texts), previous(previous) {}
+
+    QString getTitle() override                     { return tr("Indexing Filter"); }
+    QSharedPointer<const FilterIndex> getIndex()    { return index; }
+
+protected:
+    void runTask() override;
+
+private:
+    QStringList texts;
+    QSharedPointer<const FilterIndex> previous;
+    QSharedPointer<const FilterIndex> index;
+};
+
+#endif // FILTERINDEX_H
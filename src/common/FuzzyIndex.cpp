@@ -0,0 +1,340 @@
+#include "common/FuzzyIndex.h"
+#include "core/Cutter.h"
+
+#include <QSet>
+#include <QPair>
+#include <QThread>
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+namespace {
+
+// Below this many candidates a search isn't worth spreading over threads
+const size_t parallelThreshold = 1 << 17;
+
+const int noMatch = std::numeric_limits<int>::min();
+
+quint64 charMask(QChar c)
+{
+    ushort u = c.unicode();
+    int bit;
+    if (u >= 'a' && u <= 'z') {
+        bit = u - 'a';
+    } else if (u >= '0' && u <= '9') {
+        bit = 26 + (u - '0');
+    } else {
+        bit = 36 + u % 28;
+    }
+    return quint64(1) << bit;
+}
+
+/**
+ * @return whether a word starts at pos of name, e.g. the f in sym.imp.foo, foo_bar or FooBar
+ */
+bool isBoundary(const QString &name, int pos)
+{
+    if (pos == 0) {
+        return true;
+    }
+    QChar prev = name.at(pos - 1);
+    QChar cur = name.at(pos);
+    if (!prev.isLetterOrNumber()) {
+        return true;
+    }
+    return (prev.isLower() && cur.isUpper()) || (prev.isLetter() && cur.isDigit());
+}
+
+int kindBonus(FuzzyIndex::Kind kind)
+{
+    switch (kind) {
+    case FuzzyIndex::Kind::Function:
+        return 12;
+    case FuzzyIndex::Kind::Class:
+        return 10;
+    case FuzzyIndex::Kind::Symbol:
+        return 6;
+    case FuzzyIndex::Kind::Flag:
+        return 0;
+    case FuzzyIndex::Kind::String:
+        return -12;
+    }
+    return 0;
+}
+
+}
+
+FuzzyIndex::FuzzyIndex(const QVector<Entry> &entries)
+    : entries(entries)
+{
+    size_t chars = 0;
+    for (const Entry &entry : entries) {
+        chars += static_cast<size_t>(entry.name.size());
+    }
+    folded.reserve(chars);
+    offsets.reserve(static_cast<size_t>(entries.size()) + 1);
+    masks.reserve(static_cast<size_t>(entries.size()));
+
+    offsets.push_back(0);
+    for (const Entry &entry : entries) {
+        quint64 mask = 0;
+        // Folding per QChar keeps the positions in sync with the original name
+        for (QChar c : entry.name) {
+            QChar f = c.toCaseFolded();
+            folded.push_back(f);
+            mask |= charMask(f);
+        }
+        offsets.push_back(static_cast<quint32>(folded.size()));
+        masks.push_back(mask);
+    }
+}
+
+QString FuzzyIndex::kindName(Kind kind)
+{
+    switch (kind) {
+    case Kind::Function:
+        return QObject::tr("Function");
+    case Kind::Symbol:
+        return QObject::tr("Symbol");
+    case Kind::Class:
+        return QObject::tr("Class");
+    case Kind::Flag:
+        return QObject::tr("Flag");
+    case Kind::String:
+        return QObject::tr("String");
+    }
+    return QString();
+}
+
+QVector<FuzzyIndex::Match> FuzzyIndex::search(const QString &queryText, int limit,
+                                              const QHash<RVA, int> &recency,
+                                              const std::vector<quint32> *within,
+                                              std::vector<quint32> *matching) const
+{
+    if (matching) {
+        matching->clear();
+    }
+
+    Query query;
+    query.mask = 0;
+    for (QChar c : queryText) {
+        if (c.isSpace()) {
+            continue;
+        }
+        QChar f = c.toCaseFolded();
+        query.chars.push_back(f);
+        query.mask |= charMask(f);
+    }
+    if (query.chars.empty() || limit <= 0) {
+        return {};
+    }
+
+    auto better = [](const Match &a, const Match &b) {
+        return a.score != b.score ? a.score > b.score : a.entry < b.entry;
+    };
+
+    size_t candidates = within ? within->size() : masks.size();
+    auto searchRange = [&](size_t begin, size_t end, std::vector<Match> &top,
+                           std::vector<quint32> *rangeMatching) {
+        // top is a heap with the worst of the best limit matches in front
+        for (size_t c = begin; c < end; c++) {
+            quint32 i = within ? (*within)[c] : static_cast<quint32>(c);
+            if ((masks[i] & query.mask) != query.mask) {
+                continue;
+            }
+            int s = score(i, query, recency);
+            if (s == noMatch) {
+                continue;
+            }
+            if (rangeMatching) {
+                rangeMatching->push_back(i);
+            }
+            Match match = { i, s };
+            if (top.size() < static_cast<size_t>(limit)) {
+                top.push_back(match);
+                std::push_heap(top.begin(), top.end(), better);
+            } else if (better(match, top.front())) {
+                std::pop_heap(top.begin(), top.end(), better);
+                top.back() = match;
+                std::push_heap(top.begin(), top.end(), better);
+            }
+        }
+    };
+
+    std::vector<Match> top;
+    size_t threadCount = static_cast<size_t>(std::max(1, QThread::idealThreadCount()));
+    if (candidates < parallelThreshold || threadCount == 1) {
+        searchRange(0, candidates, top, matching);
+    } else {
+        std::vector<std::vector<Match>> tops(threadCount);
+        std::vector<std::vector<quint32>> matchings(matching ? threadCount : 0);
+        std::vector<std::thread> workers;
+        size_t step = (candidates + threadCount - 1) / threadCount;
+        for (size_t t = 0; t < threadCount; t++) {
+            size_t begin = std::min(t * step, candidates);
+            size_t end = std::min(begin + step, candidates);
+            std::vector<quint32> *rangeMatching = matching ? &matchings[t] : nullptr;
+            workers.emplace_back([&, t, begin, end, rangeMatching]() {
+                searchRange(begin, end, tops[t], rangeMatching);
+            });
+        }
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+        for (size_t t = 0; t < threadCount; t++) {
+            top.insert(top.end(), tops[t].begin(), tops[t].end());
+            if (matching) {
+                matching->insert(matching->end(), matchings[t].begin(), matchings[t].end());
+            }
+        }
+    }
+
+    std::sort(top.begin(), top.end(), better);
+    if (top.size() > static_cast<size_t>(limit)) {
+        top.resize(static_cast<size_t>(limit));
+    }
+    return QVector<Match>::fromStdVector(top);
+}
+
+int FuzzyIndex::score(quint32 i, const Query &query, const QHash<RVA, int> &recency) const
+{
+    const QChar *name = folded.data() + offsets[i];
+    int length = static_cast<int>(offsets[i + 1] - offsets[i]);
+    int queryLength = static_cast<int>(query.chars.size());
+    if (queryLength > length) {
+        return noMatch;
+    }
+
+    // Match from the back first: last[q] is the last position where query character q can be
+    // matched while leaving room for the rest of the query. If that fails, there is no match.
+    int lastOnStack[64];
+    std::vector<int> lastOnHeap;
+    int *last = lastOnStack;
+    if (queryLength > 64) {
+        lastOnHeap.resize(static_cast<size_t>(queryLength));
+        last = lastOnHeap.data();
+    }
+    int pos = length - 1;
+    for (int q = queryLength - 1; q >= 0; q--) {
+        while (pos >= 0 && name[pos] != query.chars[static_cast<size_t>(q)]) {
+            pos--;
+        }
+        if (pos < 0) {
+            return noMatch;
+        }
+        last[q] = pos--;
+    }
+
+    // Then pick positions from the front, preferring to continue the previous match, then the
+    // start of a word, then the first occurrence
+    const Entry &entry = entries.at(static_cast<int>(i));
+    int s = 0;
+    int prev = -1;
+    bool prefix = true;
+    for (int q = 0; q < queryLength; q++) {
+        QChar c = query.chars[static_cast<size_t>(q)];
+        int chosen = -1;
+        if (prev + 1 <= last[q] && name[prev + 1] == c) {
+            chosen = prev + 1;
+        } else {
+            int first = -1;
+            for (int p = prev + 1; p <= last[q]; p++) {
+                if (name[p] != c) {
+                    continue;
+                }
+                if (first < 0) {
+                    first = p;
+                }
+                if (isBoundary(entry.name, p)) {
+                    chosen = p;
+                    break;
+                }
+            }
+            if (chosen < 0) {
+                chosen = first;
+            }
+        }
+
+        s += 16;
+        if (chosen == 0) {
+            s += 24;
+        } else if (isBoundary(entry.name, chosen)) {
+            s += 18;
+        }
+        if (prev >= 0 && chosen == prev + 1) {
+            s += 12;
+        } else {
+            s -= std::min(chosen - prev - 1, 12);
+        }
+        if (chosen != q) {
+            prefix = false;
+        }
+        prev = chosen;
+    }
+
+    if (prefix) {
+        s += queryLength == length ? 100 : 40;
+    }
+    s -= std::min((length - queryLength) / 4, 20);
+    s += kindBonus(entry.kind);
+    auto it = recency.constFind(entry.address);
+    if (it != recency.constEnd()) {
+        s += std::max(0, 40 - 2 * it.value());
+    }
+    return s;
+}
+
+void FuzzyIndexTask::runTask()
+{
+    QList<BinClassDescription> classes = Core()->getAllClassesFromBin();
+    if (isInterrupted()) {
+        return;
+    }
+
+    QVector<FuzzyIndex::Entry> entries;
+    entries.reserve(functions.size() + classes.size() + symbols.size() + flags.size()
+                    + (strings ? strings->count() : 0));
+
+    // Functions and symbols usually have flags of the same name, the first kind added wins
+    QSet<QPair<RVA, QString>> seen;
+    auto add = [&](const QString &name, RVA address, FuzzyIndex::Kind kind) {
+        if (name.isEmpty() || address == RVA_INVALID) {
+            return;
+        }
+        QPair<RVA, QString> key(address, name);
+        if (seen.contains(key)) {
+            return;
+        }
+        seen.insert(key);
+        entries.append({ name, address, kind });
+    };
+    for (const FunctionDescription &function : functions) {
+        add(function.name, function.offset, FuzzyIndex::Kind::Function);
+    }
+    for (const BinClassDescription &cls : classes) {
+        add(cls.name, cls.addr, FuzzyIndex::Kind::Class);
+    }
+    for (const SymbolDescription &symbol : symbols) {
+        add(symbol.name, symbol.vaddr, FuzzyIndex::Kind::Symbol);
+    }
+    for (const FlagDescription &flag : flags) {
+        add(flag.name, flag.offset, FuzzyIndex::Kind::Flag);
+    }
+    seen.clear();
+    if (isInterrupted()) {
+        return;
+    }
+
+    // Strings are matched by their contents, which can't collide with the names above
+    if (strings) {
+        for (int i = 0; i < strings->count(); i++) {
+            entries.append({ strings->string(i), strings->vaddr(i), FuzzyIndex::Kind::String });
+        }
+    }
+    if (isInterrupted()) {
+        return;
+    }
+
+    index = QSharedPointer<const FuzzyIndex>(new FuzzyIndex(entries));
+}
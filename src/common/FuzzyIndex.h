@@ -0,0 +1,110 @@
+#ifndef FUZZYINDEX_H
+#define FUZZYINDEX_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QSharedPointer>
+
+#include <vector>
+
+#include "core/CutterCommon.h"
+#include "core/CutterDescriptions.h"
+#include "core/CompactStringList.h"
+#include "common/AsyncTask.h"
+
+/**
+ * @brief Fuzzy name index for quick navigation, e.g. from the Omnibar.
+ *
+ * A query matches every name that contains its characters in order, ignoring case. Matches are
+ * ranked by how well they fit: prefixes, characters at word boundaries (after '.', '_' or a case
+ * change) and consecutive characters score higher, long gaps and long names lower, and recently
+ * visited addresses get a bonus.
+ *
+ * The index is immutable once built. Every name has a mask of the characters it contains, so
+ * most names are rejected with a single comparison before looking at their characters.
+ */
+class FuzzyIndex
+{
+public:
+    enum class Kind : quint8 { Function, Symbol, Class, Flag, String };
+
+    struct Entry {
+        QString name;
+        RVA address;
+        Kind kind;
+    };
+
+    struct Match {
+        quint32 entry;
+        int score;
+    };
+
+    explicit FuzzyIndex(const QVector<Entry> &entries);
+
+    int count() const                           { return entries.size(); }
+    const Entry &entry(quint32 i) const         { return entries.at(static_cast<int>(i)); }
+
+    static QString kindName(Kind kind);
+
+    /**
+     * @brief Find the best matches of query.
+     * @param limit maximum number of matches returned
+     * @param recency rank of recently visited addresses, 0 for the most recent one
+     * @param within if not null, only these entries are considered. The matches of a query are
+     * always a subset of the matches of its prefixes, so they can be narrowed down while typing.
+     * @param matching if not null, receives all entries that match, in index order
+     * @return at most limit matches, best first
+     */
+    QVector<Match> search(const QString &query, int limit, const QHash<RVA, int> &recency,
+                          const std::vector<quint32> *within = nullptr,
+                          std::vector<quint32> *matching = nullptr) const;
+
+private:
+    struct Query {
+        std::vector<QChar> chars;
+        quint64 mask;
+    };
+
+    QVector<Entry> entries;
+    // Case folded names in one buffer, name i is chars[offsets[i]] to chars[offsets[i + 1]]
+    std::vector<QChar> folded;
+    std::vector<quint32> offsets;
+    std::vector<quint64> masks;
+
+    /**
+     * @return score of entry i, or a negative number if it doesn't match
+     */
+    int score(quint32 i, const Query &query, const QHash<RVA, int> &recency) const;
+};
+
+class FuzzyIndexTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Index the given snapshots, the classes are fetched by the task itself.
+     * strings may be null, it must not be appended to while the task runs.
+     */
+    FuzzyIndexTask(const QList<FunctionDescription> &functions,
+                   const QList<SymbolDescription> &symbols,
+                   const QList<FlagDescription> &flags,
+                   const QSharedPointer<const CompactStringList> &strings)
+        : functions(functions), symbols(symbols), flags(flags), strings(strings) {}
+
+    QString getTitle() override                     { return tr("Indexing Names"); }
+    QSharedPointer<const FuzzyIndex> getIndex()     { return index; }
+
+protected:
+    void runTask() override;
+
+private:
+    QList<FunctionDescription> functions;
+    QList<SymbolDescription> symbols;
+    QList<FlagDescription> flags;
+    QSharedPointer<const CompactStringList> strings;
+    QSharedPointer<const FuzzyIndex> index;
+};
+
+#endif // FUZZYINDEX_H
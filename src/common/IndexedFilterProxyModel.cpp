@@ -0,0 +1,215 @@
+#include "common/IndexedFilterProxyModel.h"
+#include "core/Cutter.h"
+
+#include <algorithm>
+
+// Changed rows are checked without the index, until there are more than this share of all rows
+static const int maxChangedRowsDivisor = 16;
+
+IndexedFilterProxyModel::IndexedFilterProxyModel(int indexColumn, int indexRole, QObject *parent)
+    : QSortFilterProxyModel(parent),
+      indexColumn(indexColumn),
+      indexRole(indexRole)
+{
+    // Coalesces the signals of one update of the source model, and the updates of a model that
+    // is filled in batches
+    rebuildTimer.setSingleShot(true);
+    rebuildTimer.setInterval(250);
+    connect(&rebuildTimer, &QTimer::timeout, this, &IndexedFilterProxyModel::rebuildIndex);
+}
+
+void IndexedFilterProxyModel::setSourceModel(QAbstractItemModel *newSourceModel)
+{
+    if (newSourceModel == sourceModel()) {
+        return;
+    }
+    if (sourceModel()) {
+        disconnect(sourceModel(), nullptr, this, nullptr);
+    }
+
+    // Connect before QSortFilterProxyModel does, so that the index is dropped
+    // before the proxy filters the changed rows.
+    if (newSourceModel) {
+        connect(newSourceModel, &QAbstractItemModel::modelAboutToBeReset,
+                this, &IndexedFilterProxyModel::invalidateIndex);
+        connect(newSourceModel, &QAbstractItemModel::rowsAboutToBeInserted,
+                this, &IndexedFilterProxyModel::sourceRowsAboutToBeInserted);
+        connect(newSourceModel, &QAbstractItemModel::rowsAboutToBeRemoved,
+                this, &IndexedFilterProxyModel::invalidateIndex);
+        connect(newSourceModel, &QAbstractItemModel::rowsAboutToBeMoved,
+                this, &IndexedFilterProxyModel::invalidateIndex);
+        connect(newSourceModel, &QAbstractItemModel::layoutAboutToBeChanged,
+                this, &IndexedFilterProxyModel::invalidateIndex);
+        connect(newSourceModel, &QAbstractItemModel::dataChanged,
+                this, &IndexedFilterProxyModel::sourceDataChanged);
+
+        connect(newSourceModel, &QAbstractItemModel::modelReset,
+                this, &IndexedFilterProxyModel::scheduleIndexRebuild);
+        connect(newSourceModel, &QAbstractItemModel::rowsInserted,
+                this, &IndexedFilterProxyModel::sourceRowsInserted);
+        connect(newSourceModel, &QAbstractItemModel::rowsRemoved,
+                this, &IndexedFilterProxyModel::scheduleIndexRebuild);
+        connect(newSourceModel, &QAbstractItemModel::rowsMoved,
+                this, &IndexedFilterProxyModel::scheduleIndexRebuild);
+        connect(newSourceModel, &QAbstractItemModel::layoutChanged,
+                this, &IndexedFilterProxyModel::scheduleIndexRebuild);
+    }
+
+    QSortFilterProxyModel::setSourceModel(newSourceModel);
+
+    invalidateIndex();
+    scheduleIndexRebuild();
+}
+
+void IndexedFilterProxyModel::setFilterRegExp(const QRegExp &regExp)
+{
+    filterPatternChanged();
+    QSortFilterProxyModel::setFilterRegExp(regExp);
+}
+
+void IndexedFilterProxyModel::setFilterCaseSensitivity(Qt::CaseSensitivity cs)
+{
+    filterPatternChanged();
+    QSortFilterProxyModel::setFilterCaseSensitivity(cs);
+}
+
+void IndexedFilterProxyModel::setFilterRegExp(const QString &pattern)
+{
+    filterPatternChanged();
+    QSortFilterProxyModel::setFilterRegExp(pattern);
+}
+
+void IndexedFilterProxyModel::setFilterWildcard(const QString &pattern)
+{
+    filterPatternChanged();
+    QSortFilterProxyModel::setFilterWildcard(pattern);
+}
+
+void IndexedFilterProxyModel::setFilterFixedString(const QString &pattern)
+{
+    filterPatternChanged();
+    QSortFilterProxyModel::setFilterFixedString(pattern);
+}
+
+void IndexedFilterProxyModel::filterPatternChanged()
+{
+    candidatesValid = false;
+}
+
+void IndexedFilterProxyModel::updateCandidates() const
+{
+    if (index && !candidatesValid) {
+        candidatesUseful = index->candidateRows(filterRegExp(), candidates);
+        candidatesValid = true;
+    }
+}
+
+bool IndexedFilterProxyModel::mayMatchFilter(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (!index || sourceParent.isValid() || changedRows.contains(sourceRow)) {
+        return true;
+    }
+
+    updateCandidates();
+    if (!candidatesUseful) {
+        return true;
+    }
+    return sourceRow >= candidates.size() || candidates.testBit(sourceRow);
+}
+
+void IndexedFilterProxyModel::invalidateIndex()
+{
+    index.clear();
+    changedRows.clear();
+    candidatesValid = false;
+    if (indexTask) {
+        disconnect(indexTask.data(), nullptr, this, nullptr);
+        indexTask->interrupt();
+        indexTask.clear();
+    }
+}
+
+void IndexedFilterProxyModel::scheduleIndexRebuild()
+{
+    invalidateIndex();
+    rebuildTimer.start();
+}
+
+void IndexedFilterProxyModel::rebuildIndex()
+{
+    QAbstractItemModel *model = sourceModel();
+    if (!model || indexTask) {
+        // A running build is followed by another one for the rows appended meanwhile
+        return;
+    }
+
+    // Reading the texts is cheap compared to indexing them, but must happen on this thread.
+    // Only the appended rows are read if there already is an index.
+    QSharedPointer<const FilterIndex> previous = index;
+    int rowCount = model->rowCount();
+    int first = previous ? previous->rowCount() : 0;
+    if (first >= rowCount) {
+        return;
+    }
+    QStringList texts;
+    texts.reserve(rowCount - first);
+    for (int row = first; row < rowCount; row++) {
+        texts.append(model->index(row, indexColumn).data(indexRole).toString());
+    }
+    if (!previous) {
+        changedRows.clear();
+    }
+
+    FilterIndexTask *task = new FilterIndexTask(texts, previous);
+    indexTask = AsyncTask::Ptr(task);
+    connect(task, &AsyncTask::finished, this, [this, task]() {
+        if (indexTask.data() != task) {
+            return;
+        }
+        indexTask.clear();
+        // Anything but appending rows dropped the task, so the rows it read are still the same
+        index = task->getIndex();
+        candidatesValid = false;
+        if (sourceModel() && sourceModel()->rowCount() > index->rowCount()) {
+            rebuildTimer.start();
+        }
+    });
+    Core()->getAsyncTaskManager()->start(indexTask);
+}
+
+void IndexedFilterProxyModel::sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int)
+{
+    if (!parent.isValid() && first == sourceModel()->rowCount()) {
+        // Appended rows are beyond the index and always checked as usual until it is extended
+        return;
+    }
+    invalidateIndex();
+}
+
+void IndexedFilterProxyModel::sourceRowsInserted(const QModelIndex &, int, int)
+{
+    // Either extends the index by the appended rows or builds it again
+    rebuildTimer.start();
+}
+
+void IndexedFilterProxyModel::sourceDataChanged(const QModelIndex &topLeft,
+                                                const QModelIndex &bottomRight,
+                                                const QVector<int> &roles)
+{
+    if (topLeft.parent().isValid()
+            || indexColumn < topLeft.column() || indexColumn > bottomRight.column()
+            || (!roles.isEmpty() && !roles.contains(indexRole))) {
+        return;
+    }
+    if (!index && !indexTask) {
+        // Nothing indexed, a rebuild is already scheduled
+        return;
+    }
+    for (int row = topLeft.row(); row <= bottomRight.row(); row++) {
+        changedRows.insert(row);
+    }
+    int rowCount = sourceModel()->rowCount();
+    if (changedRows.size() > std::max(1, rowCount / maxChangedRowsDivisor)) {
+        scheduleIndexRebuild();
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef INDEXEDFILTERPROXYMODEL_H
+#define INDEXEDFILTERPROXYMODEL_H
+
+#include <QSortFilterProxyModel>
+#include <QBitArray>
+#include <QSet>
+#include <QRegExp>
+#include <QTimer>
+
+#include "common/FilterIndex.h"
+
+/**
+ * @brief Sort filter proxy that keeps a FilterIndex of the text that its filter is applied to.
+ *
+ * Subclasses call mayMatchFilter() first in filterAcceptsRow() to reject most rows without
+ * looking at them. The index covers the top level rows of one column of the source model and is
+ * rebuilt in the background whenever rows are inserted, removed or moved. Rows appended at the
+ * end are indexed on their own and merged into the index, so models filled in batches only read
+ * the new rows. Until the index is ready, every row is checked by filterAcceptsRow() as usual.
+ * Rows whose text changed are checked as usual too, instead of rebuilding the index for every
+ * renamed row.
+ *
+ * The candidates of the index are computed once per pattern, so the filter must be changed
+ * through the setters of this class rather than those of QSortFilterProxyModel.
+ */
+class IndexedFilterProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    IndexedFilterProxyModel(int indexColumn, int indexRole, QObject *parent = nullptr);
+
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+    void setFilterRegExp(const QRegExp &regExp);
+    void setFilterCaseSensitivity(Qt::CaseSensitivity cs);
+
+public slots:
+    void setFilterRegExp(const QString &pattern);
+    void setFilterWildcard(const QString &pattern);
+    void setFilterFixedString(const QString &pattern);
+
+protected:
+    /**
+     * @return false if sourceRow can't contain a match of filterRegExp(). Can be called from
+     * several threads at once after updateCandidates().
+     */
+    bool mayMatchFilter(int sourceRow, const QModelIndex &sourceParent) const;
+    /**
+     * @brief Compute the candidates of the index for the current pattern, unless already done
+     */
+    void updateCandidates() const;
+
+    /**
+     * @brief Called by the filter setters before the proxy filters with the new pattern
+     */
+    virtual void filterPatternChanged();
+
+private slots:
+    void invalidateIndex();
+    void scheduleIndexRebuild();
+    void rebuildIndex();
+    void sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                           const QVector<int> &roles);
+
+private:
+    int indexColumn;
+    int indexRole;
+
+    QSharedPointer<const FilterIndex> index;
+    AsyncTask::Ptr indexTask;
+    QTimer rebuildTimer;
+    // Top level rows whose text changed since the texts of the index were read
+    QSet<int> changedRows;
+
+    // Candidates for the current pattern, computed by the first filterAcceptsRow() after it changed
+    mutable bool candidatesValid = false;
+    mutable bool candidatesUseful = false;
+    mutable QBitArray candidates;
+};
+
+#endif // INDEXEDFILTERPROXYMODEL_H
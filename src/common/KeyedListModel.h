@@ -0,0 +1,160 @@
+#ifndef KEYEDLISTMODEL_H
+#define KEYEDLISTMODEL_H
+
+#include <QAbstractItemModel>
+#include <QList>
+#include <QHash>
+
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Base for models that display a QList of descriptions which is regularly replaced by a
+ * new snapshot of the same entities.
+ *
+ * updateList() compares the rows of both lists by a key like the address or the name and only
+ * signals the rows that were removed, inserted or changed, so views and proxies keep their
+ * selection, scroll position and sorting.
+ */
+template<class Base>
+class KeyedListModel : public Base
+{
+public:
+    explicit KeyedListModel(QObject *parent = nullptr)
+        : Base(parent) {}
+
+protected:
+    /**
+     * @brief Replace list, which holds the rows below parent, by newList.
+     *
+     * key(const T &) must be unique within each list and T must be comparable with ==.
+     * If the keys are not unique or rows changed their order, the model is reset instead.
+     * Afterwards list shares the data of newList.
+     */
+    template<class T, class KeyFunction>
+    void updateList(QList<T> &list, const QList<T> &newList, KeyFunction key,
+                    const QModelIndex &parent = QModelIndex());
+
+private:
+    template<class T>
+    void resetList(QList<T> &list, const QList<T> &newList)
+    {
+        this->beginResetModel();
+        list = newList;
+        this->endResetModel();
+    }
+
+    void rowsChanged(int first, int last, const QModelIndex &parent)
+    {
+        emit this->dataChanged(this->index(first, 0, parent),
+                               this->index(last, this->columnCount(parent) - 1, parent));
+    }
+};
+
+template<class Base>
+template<class T, class KeyFunction>
+void KeyedListModel<Base>::updateList(QList<T> &list, const QList<T> &newList, KeyFunction key,
+                                      const QModelIndex &parent)
+{
+    using Key = typename std::decay<decltype(key(std::declval<const T &>()))>::type;
+
+    if (list.isSharedWith(newList)) {
+        return;
+    }
+    if (list.isEmpty() || newList.isEmpty()) {
+        resetList(list, newList);
+        return;
+    }
+
+    QHash<Key, int> newRows;
+    newRows.reserve(newList.size());
+    for (int i = 0; i < newList.size(); i++) {
+        Key k = key(newList.at(i));
+        if (newRows.contains(k)) {
+            resetList(list, newList);
+            return;
+        }
+        newRows.insert(k, i);
+    }
+
+    QHash<Key, int> oldRows;
+    oldRows.reserve(list.size());
+    int lastNewRow = -1;
+    for (int i = 0; i < list.size(); i++) {
+        Key k = key(list.at(i));
+        if (oldRows.contains(k)) {
+            resetList(list, newList);
+            return;
+        }
+        oldRows.insert(k, i);
+
+        // The rows that are kept must be in the same order in both lists
+        auto it = newRows.constFind(k);
+        if (it != newRows.constEnd()) {
+            if (it.value() < lastNewRow) {
+                resetList(list, newList);
+                return;
+            }
+            lastNewRow = it.value();
+        }
+    }
+
+    // Remove the rows that are gone, back to front so that the row numbers stay valid
+    for (int row = list.size() - 1; row >= 0; row--) {
+        if (newRows.contains(key(list.at(row)))) {
+            continue;
+        }
+        int last = row;
+        while (row > 0 && !newRows.contains(key(list.at(row - 1)))) {
+            row--;
+        }
+        this->beginRemoveRows(parent, row, last);
+        list.erase(list.begin() + row, list.begin() + last + 1);
+        this->endRemoveRows();
+    }
+
+    // The keys of list are now a subsequence of newList, so walking both front to back
+    // every mismatch is the start of a run of rows that have to be inserted.
+    int changedFirst = -1;
+    int row = 0;
+    while (row < newList.size()) {
+        const T &newItem = newList.at(row);
+        if (row < list.size() && key(list.at(row)) == key(newItem)) {
+            if (list.at(row) == newItem) {
+                if (changedFirst >= 0) {
+                    rowsChanged(changedFirst, row - 1, parent);
+                    changedFirst = -1;
+                }
+            } else {
+                list[row] = newItem;
+                if (changedFirst < 0) {
+                    changedFirst = row;
+                }
+            }
+            row++;
+            continue;
+        }
+        if (changedFirst >= 0) {
+            rowsChanged(changedFirst, row - 1, parent);
+            changedFirst = -1;
+        }
+        int last = row;
+        while (last + 1 < newList.size() && !oldRows.contains(key(newList.at(last + 1)))) {
+            last++;
+        }
+        this->beginInsertRows(parent, row, last);
+        for (int i = row; i <= last; i++) {
+            list.insert(i, newList.at(i));
+        }
+        this->endInsertRows();
+        row = last + 1;
+    }
+    if (changedFirst >= 0) {
+        rowsChanged(changedFirst, row - 1, parent);
+    }
+
+    // Same content now, share the data of the snapshot instead of keeping a copy
+    list = newList;
+}
+
+#endif // KEYEDLISTMODEL_H
@@ -0,0 +1,101 @@
+#ifndef PARALLELSORT_H
+#define PARALLELSORT_H
+
+#include <QThread>
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace qhelpers {
+
+/**
+ * @brief Stable sort of [first, last) that splits the range into one chunk per core,
+ * sorts the chunks concurrently and merges them pairwise, again concurrently.
+ *
+ * comp is called from several threads at once and must not modify shared state.
+ */
+template<class RandomIt, class Compare>
+void parallelStableSort(RandomIt first, RandomIt last, Compare comp)
+{
+    // Below this size per chunk, starting threads costs more than it saves
+    const ptrdiff_t minChunkSize = 8192;
+
+    ptrdiff_t size = last - first;
+    ptrdiff_t chunks = std::min<ptrdiff_t>(std::max(1, QThread::idealThreadCount()),
+                                           size / minChunkSize);
+    if (chunks < 2) {
+        std::stable_sort(first, last, comp);
+        return;
+    }
+
+    std::vector<RandomIt> bounds;
+    for (ptrdiff_t i = 0; i < chunks; i++) {
+        bounds.push_back(first + size * i / chunks);
+    }
+    bounds.push_back(last);
+
+    std::vector<std::thread> workers;
+    for (ptrdiff_t i = 0; i < chunks; i++) {
+        RandomIt begin = bounds[i];
+        RandomIt end = bounds[i + 1];
+        workers.emplace_back([begin, end, comp]() {
+            std::stable_sort(begin, end, comp);
+        });
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    for (ptrdiff_t width = 1; width < chunks; width *= 2) {
+        workers.clear();
+        for (ptrdiff_t i = 0; i + width < chunks; i += 2 * width) {
+            RandomIt begin = bounds[i];
+            RandomIt middle = bounds[i + width];
+            RandomIt end = bounds[std::min(i + 2 * width, chunks)];
+            workers.emplace_back([begin, middle, end, comp]() {
+                std::inplace_merge(begin, middle, end, comp);
+            });
+        }
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    }
+}
+
+/**
+ * @brief Call function(begin, end) for consecutive chunks of [0, count), one chunk per core,
+ * concurrently.
+ *
+ * function is called from several threads at once and may only write to its own chunk.
+ */
+template<class Function>
+void parallelForChunks(size_t count, Function function)
+{
+    // Below this size per chunk, starting threads costs more than it saves
+    const size_t minChunkSize = 8192;
+
+    size_t chunks = std::min(static_cast<size_t>(std::max(1, QThread::idealThreadCount())),
+                             count / minChunkSize);
+    if (chunks < 2) {
+        function(static_cast<size_t>(0), count);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < chunks; i++) {
+        size_t begin = count * i / chunks;
+        size_t end = count * (i + 1) / chunks;
+        workers.emplace_back([begin, end, function]() {
+            function(begin, end);
+        });
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+} // namespace qhelpers
+
+#endif // PARALLELSORT_H
@@ -0,0 +1,221 @@
+#include "common/ParallelSortFilterProxyModel.h"
+#include "common/ParallelSort.h"
+
+#include <algorithm>
+#include <numeric>
+
+// Above this share of changed rows, sorting everything again is cheaper than moving each row
+static const int maxRerankedRowsDivisor = 16;
+
+ParallelSortFilterProxyModel::ParallelSortFilterProxyModel(int indexColumn, int indexRole,
+                                                           QObject *parent)
+    : IndexedFilterProxyModel(indexColumn, indexRole, parent)
+{
+}
+
+void ParallelSortFilterProxyModel::setSourceModel(QAbstractItemModel *newSourceModel)
+{
+    if (newSourceModel == sourceModel()) {
+        return;
+    }
+
+    // Like the filter index, the ranks must be dropped before the proxy sorts the changed rows
+    if (newSourceModel) {
+        connect(newSourceModel, &QAbstractItemModel::modelAboutToBeReset,
+                this, &ParallelSortFilterProxyModel::invalidateSortRanks);
+        connect(newSourceModel, &QAbstractItemModel::rowsAboutToBeInserted,
+                this, &ParallelSortFilterProxyModel::sourceRowsAboutToBeInserted);
+        connect(newSourceModel, &QAbstractItemModel::rowsAboutToBeRemoved,
+                this, &ParallelSortFilterProxyModel::invalidateSortRanks);
+        connect(newSourceModel, &QAbstractItemModel::rowsAboutToBeMoved,
+                this, &ParallelSortFilterProxyModel::invalidateSortRanks);
+        connect(newSourceModel, &QAbstractItemModel::layoutAboutToBeChanged,
+                this, &ParallelSortFilterProxyModel::invalidateSortRanks);
+        connect(newSourceModel, &QAbstractItemModel::dataChanged,
+                this, &ParallelSortFilterProxyModel::sourceDataChanged);
+    }
+
+    IndexedFilterProxyModel::setSourceModel(newSourceModel);
+    invalidateSortRanks();
+}
+
+bool ParallelSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+    if (left.parent().isValid() || right.parent().isValid()) {
+        return false;
+    }
+
+    if (rankedColumn != left.column()) {
+        // Computed on first use, the proxy calls lessThan() from sort() and its change handlers
+        const_cast<ParallelSortFilterProxyModel *>(this)->computeSortRanks(left.column());
+    }
+
+    size_t leftRow = static_cast<size_t>(left.row());
+    size_t rightRow = static_cast<size_t>(right.row());
+    if (leftRow >= ranks.size() || rightRow >= ranks.size()) {
+        // Appended after the ranks were computed, the ranks agree with the keys
+        if (!sortKeysCached) {
+            auto self = const_cast<ParallelSortFilterProxyModel *>(this);
+            self->cacheSortKeys();
+            self->sortKeysCached = true;
+        }
+        return sourceRowLessThan(left.row(), right.row(), left.column());
+    }
+    return ranks[leftRow] < ranks[rightRow];
+}
+
+bool ParallelSortFilterProxyModel::filterMatches(int sourceRow) const
+{
+    auto self = const_cast<ParallelSortFilterProxyModel *>(this);
+    if (!matchesValid) {
+        self->matches.clear();
+        self->matchesValid = true;
+    }
+    if (static_cast<size_t>(sourceRow) >= matches.size()) {
+        // First lookup after the pattern changed or rows were appended, match all new rows at once
+        self->computeMatches(static_cast<int>(matches.size()), sourceModel()->rowCount() - 1);
+    }
+    return matches[static_cast<size_t>(sourceRow)] != 0;
+}
+
+void ParallelSortFilterProxyModel::filterPatternChanged()
+{
+    IndexedFilterProxyModel::filterPatternChanged();
+    matchesValid = false;
+}
+
+void ParallelSortFilterProxyModel::computeMatches(int first, int last)
+{
+    if (!sortKeysCached) {
+        cacheSortKeys();
+        sortKeysCached = true;
+    }
+    if (matches.size() <= static_cast<size_t>(last)) {
+        matches.resize(static_cast<size_t>(last) + 1);
+    }
+    // Computed here, the threads below only read the candidates
+    updateCandidates();
+
+    QRegExp regExp = filterRegExp();
+    QModelIndex root;
+    qhelpers::parallelForChunks(static_cast<size_t>(last - first + 1),
+                                [this, first, regExp, root](size_t begin, size_t end) {
+        QRegExp threadRegExp = regExp;
+        for (size_t i = begin; i < end; i++) {
+            int row = first + static_cast<int>(i);
+            matches[static_cast<size_t>(row)] = mayMatchFilter(row, root)
+                                                && sourceRowMatches(row, threadRegExp);
+        }
+    });
+}
+
+void ParallelSortFilterProxyModel::invalidateSortRanks()
+{
+    sortKeysCached = false;
+    rankedColumn = -1;
+    ranks.clear();
+    matchesValid = false;
+}
+
+void ParallelSortFilterProxyModel::sourceRowsAboutToBeInserted(const QModelIndex &parent,
+                                                               int first, int)
+{
+    if (parent.isValid() || first != sourceModel()->rowCount()) {
+        invalidateSortRanks();
+        return;
+    }
+    // The ranks of the existing rows stay valid, only the keys must include the new rows
+    sortKeysCached = false;
+}
+
+void ParallelSortFilterProxyModel::sourceDataChanged(const QModelIndex &topLeft,
+                                                     const QModelIndex &bottomRight,
+                                                     const QVector<int> &roles)
+{
+    // Nested rows keep the order of the source model, e.g. highlighting the current row only
+    // changes its font
+    if (topLeft.parent().isValid() || (!roles.isEmpty() && !roles.contains(sortRole()))) {
+        return;
+    }
+    if (!sortKeysCached) {
+        // Copied again when needed, ranks and matches computed meanwhile still are up to date
+        if (rankedColumn < 0 && !matchesValid) {
+            return;
+        }
+        cacheSortKeys();
+        sortKeysCached = true;
+    } else {
+        updateSortKeys(topLeft.row(), bottomRight.row());
+    }
+    if (matchesValid) {
+        int last = std::min(bottomRight.row(), static_cast<int>(matches.size()) - 1);
+        if (topLeft.row() <= last) {
+            computeMatches(topLeft.row(), last);
+        }
+    }
+    if (rankedColumn >= topLeft.column() && rankedColumn <= bottomRight.column()) {
+        updateSortRanks(topLeft.row(), bottomRight.row());
+    }
+}
+
+void ParallelSortFilterProxyModel::updateSortKeys(int, int)
+{
+    cacheSortKeys();
+}
+
+void ParallelSortFilterProxyModel::updateSortRanks(int first, int last)
+{
+    last = std::min(last, static_cast<int>(ranks.size()) - 1);
+    if (first > last) {
+        // Only appended rows, they are compared by their keys
+        return;
+    }
+    if (last - first + 1 > static_cast<int>(ranks.size()) / maxRerankedRowsDivisor) {
+        rankedColumn = -1;
+        ranks.clear();
+        return;
+    }
+
+    int column = rankedColumn;
+    std::vector<int> order(ranks.size());
+    for (size_t row = 0; row < ranks.size(); row++) {
+        order[static_cast<size_t>(ranks[row])] = static_cast<int>(row);
+    }
+    order.erase(std::remove_if(order.begin(), order.end(), [first, last](int row) {
+        return row >= first && row <= last;
+    }), order.end());
+    // Same order as the stable sort of computeSortRanks(), equal keys by source row
+    auto before = [this, column](int a, int b) {
+        if (sourceRowLessThan(a, b, column)) {
+            return true;
+        }
+        return !sourceRowLessThan(b, a, column) && a < b;
+    };
+    for (int row = first; row <= last; row++) {
+        order.insert(std::lower_bound(order.begin(), order.end(), row, before), row);
+    }
+    for (size_t i = 0; i < order.size(); i++) {
+        ranks[static_cast<size_t>(order[i])] = static_cast<int>(i);
+    }
+}
+
+void ParallelSortFilterProxyModel::computeSortRanks(int column)
+{
+    if (!sortKeysCached) {
+        cacheSortKeys();
+        sortKeysCached = true;
+    }
+
+    int rowCount = sourceModel() ? sourceModel()->rowCount() : 0;
+    std::vector<int> order(static_cast<size_t>(rowCount));
+    std::iota(order.begin(), order.end(), 0);
+    qhelpers::parallelStableSort(order.begin(), order.end(), [this, column](int a, int b) {
+        return sourceRowLessThan(a, b, column);
+    });
+
+    ranks.assign(order.size(), 0);
+    for (size_t i = 0; i < order.size(); i++) {
+        ranks[static_cast<size_t>(order[i])] = static_cast<int>(i);
+    }
+    rankedColumn = column;
+}
@@ -0,0 +1,91 @@
+#ifndef PARALLELSORTFILTERPROXYMODEL_H
+#define PARALLELSORTFILTERPROXYMODEL_H
+
+#include "common/IndexedFilterProxyModel.h"
+
+#include <vector>
+
+/**
+ * @brief Indexed filter proxy that sorts and filters on typed keys instead of calling data() per
+ * row.
+ *
+ * Subclasses copy the keys out of the source model once in cacheSortKeys() and compare them in
+ * sourceRowLessThan(). When a column is sorted, all top level rows are ordered by these keys
+ * with a parallel sort and lessThan() only compares the resulting ranks. Keys and ranks are
+ * dropped whenever the source model changes, except for rows appended at the end: these are
+ * compared by their keys, so models filled in batches aren't sorted again for every batch.
+ * Rows whose data changed get new keys from updateSortKeys() and are moved to their new rank,
+ * changes of roles other than sortRole() are ignored.
+ *
+ * The filter is evaluated the same way: filterMatches() matches all top level rows against
+ * their keys with sourceRowMatches() in parallel once per pattern, later calls only read the
+ * result. Appended rows are matched on their first lookup, rows whose data changed again.
+ */
+class ParallelSortFilterProxyModel : public IndexedFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    ParallelSortFilterProxyModel(int indexColumn, int indexRole, QObject *parent = nullptr);
+
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+protected:
+    /**
+     * @brief Copy the sort keys of all top level rows of the source model, replacing the
+     * previous ones.
+     */
+    virtual void cacheSortKeys() = 0;
+
+    /**
+     * @brief Copy the sort keys of the top level rows first to last again, after their data
+     * changed. Copies all keys unless overridden.
+     */
+    virtual void updateSortKeys(int first, int last);
+
+    /**
+     * @brief Compare two top level source rows by column using the cached keys.
+     * Called from several threads at once.
+     */
+    virtual bool sourceRowLessThan(int leftRow, int rightRow, int column) const = 0;
+
+    /**
+     * @brief Whether the cached keys of a top level source row contain a match of regExp.
+     * Called from several threads at once, each with its own copy of filterRegExp().
+     */
+    virtual bool sourceRowMatches(int row, QRegExp &regExp) const = 0;
+
+    /**
+     * @brief Result of mayMatchFilter() and sourceRowMatches() for a top level source row,
+     * for use in filterAcceptsRow().
+     */
+    bool filterMatches(int sourceRow) const;
+
+    void filterPatternChanged() override;
+
+    /**
+     * @brief Rows below other rows keep the order of the source model.
+     */
+    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+
+private slots:
+    void invalidateSortRanks();
+    void sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last);
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                           const QVector<int> &roles);
+
+private:
+    void computeSortRanks(int column);
+    void updateSortRanks(int first, int last);
+    void computeMatches(int first, int last);
+
+    bool sortKeysCached = false;
+    int rankedColumn = -1;
+    // Source row -> position when sorted by rankedColumn
+    std::vector<int> ranks;
+    bool matchesValid = false;
+    // Source row -> whether it passes the filter, for the rows that existed when last matched
+    std::vector<char> matches;
+};
+
+#endif // PARALLELSORTFILTERPROXYMODEL_H
@@ -3,10 +3,15 @@
 
 #include "PythonAPI.h"
 #include "core/Cutter.h"
+#include "core/StringScanner.h"
+#include "core/ImmediateIndex.h"
+#include "core/XrefGraph.h"
+#include "core/AnalysisDataStore.h"
 
 #include "CutterConfig.h"
 
 #include <QFile>
+#include <QElapsedTimer>
 
 PyObject *api_version(PyObject *self, PyObject *null)
 {
@@ -54,6 +59,104 @@ PyObject *api_message(PyObject *self, PyObject *args, PyObject *kwargs)
     return Py_None;
 }
 
+PyObject *api_benchmark_strings(PyObject *self, PyObject *null)
+{
+    Q_UNUSED(self)
+    Q_UNUSED(null)
+    QElapsedTimer timer;
+
+    timer.start();
+    int izzjStrings = Core()->getAllStrings().count();
+    qint64 izzjTime = timer.elapsed();
+
+    timer.restart();
+    QSharedPointer<StringScanner> scanner = StringScanner::forOpenFile();
+    if (!scanner->open()) {
+        PyErr_SetString(PyExc_RuntimeError, "The opened file can't be read directly");
+        return NULL;
+    }
+    int nativeStrings = 0;
+    scanner->scan(10000, [&nativeStrings](CompactStringList &batch) {
+        nativeStrings += batch.count();
+        return true;
+    });
+    qint64 nativeTime = timer.elapsed();
+
+    return Py_BuildValue("{s:i,s:L,s:i,s:L}",
+                         "izzj_strings", izzjStrings, "izzj_ms", static_cast<long long>(izzjTime),
+                         "native_strings", nativeStrings, "native_ms", static_cast<long long>(nativeTime));
+}
+
+PyObject *api_immediate_refs(PyObject *self, PyObject *args)
+{
+    Q_UNUSED(self)
+    unsigned long long value;
+    if (!PyArg_ParseTuple(args, "K:value", &value)) {
+        return NULL;
+    }
+
+    // Built only once and then kept by the store, which updates it for the next calls
+    QSharedPointer<const ImmediateIndex> index = Core()->getDataStore()->updateImmediateIndex();
+
+    QVector<RVA> addresses = index->find(value);
+    PyObject *list = PyList_New(addresses.size());
+    for (int i = 0; i < addresses.size(); i++) {
+        PyList_SET_ITEM(list, i, PyLong_FromUnsignedLongLong(addresses.at(i)));
+    }
+    return list;
+}
+
+/**
+ * @return the graph of the store if it is current, otherwise a new one, without waiting for the store
+ */
+static QSharedPointer<const XrefGraph> currentXrefGraph()
+{
+    AnalysisDataStore *store = Core()->getDataStore();
+    QSharedPointer<const XrefGraph> graph = store->getXrefGraph();
+    if (!graph || !store->isCurrent(AnalysisDataStore::Kind::Xrefs)) {
+        graph = XrefGraph::build();
+    }
+    return graph;
+}
+
+PyObject *api_transitive_callers(PyObject *self, PyObject *args)
+{
+    Q_UNUSED(self)
+    unsigned long long addr;
+    int maxDepth = 0;
+    if (!PyArg_ParseTuple(args, "K|i:addr", &addr, &maxDepth)) {
+        return NULL;
+    }
+
+    QSharedPointer<const XrefGraph> graph = currentXrefGraph();
+    QVector<XrefGraph::Reached> callers = graph->transitiveCallers(graph->nodeAt(addr), maxDepth);
+    PyObject *list = PyList_New(callers.size());
+    for (int i = 0; i < callers.size(); i++) {
+        PyList_SET_ITEM(list, i, Py_BuildValue("(Ki)",
+                                               static_cast<unsigned long long>(graph->nodeOffset(callers.at(i).node)),
+                                               callers.at(i).distance));
+    }
+    return list;
+}
+
+PyObject *api_xref_path(PyObject *self, PyObject *args)
+{
+    Q_UNUSED(self)
+    unsigned long long from;
+    unsigned long long to;
+    if (!PyArg_ParseTuple(args, "KK:from,to", &from, &to)) {
+        return NULL;
+    }
+
+    QSharedPointer<const XrefGraph> graph = currentXrefGraph();
+    QVector<int> path = graph->path(graph->nodeAt(from), graph->nodeAt(to));
+    PyObject *list = PyList_New(path.size());
+    for (int i = 0; i < path.size(); i++) {
+        PyList_SET_ITEM(list, i, PyLong_FromUnsignedLongLong(graph->nodeOffset(path.at(i))));
+    }
+    return list;
+}
+
 PyMethodDef CutterMethods[] = {
     {
         "version", api_version, METH_NOARGS,
@@ -67,6 +170,22 @@ PyMethodDef CutterMethods[] = {
         "refresh", api_refresh, METH_NOARGS,
         "Refresh Cutter widgets"
     },
+    {
+        "benchmark_strings", api_benchmark_strings, METH_NOARGS,
+        "Time izzj against the native string scanner on the opened file"
+    },
+    {
+        "immediate_refs", api_immediate_refs, METH_VARARGS,
+        "Returns the addresses of the instructions in functions that use the immediate or displacement value"
+    },
+    {
+        "transitive_callers", api_transitive_callers, METH_VARARGS,
+        "Returns (function, depth) for all functions that can reach the address through calls, up to an optional max depth"
+    },
+    {
+        "xref_path", api_xref_path, METH_VARARGS,
+        "Returns the functions of a shortest chain of calls and jumps between two addresses, empty if there is none"
+    },
     {
         "message", (PyCFunction)(void *)/* don't remove this double cast! */api_message, METH_VARARGS | METH_KEYWORDS,
         "Print message"
@@ -0,0 +1,232 @@
+#include "common/SearchTask.h"
+#include "common/R2Task.h"
+#include "core/PatternScanner.h"
+#include "core/GadgetFinder.h"
+
+const char *const SearchTask::patternSetSpace = "patterns";
+
+SearchTask::SearchTask(const QString &searchFor, const QString &space, const QList<Range> &ranges,
+                       int maxHits)
+    : AsyncTask(),
+      searchFor(searchFor),
+      space(space),
+      ranges(ranges),
+      maxHits(maxHits),
+      total(ranges.isEmpty() ? 1 : ranges.size())
+{
+}
+
+void SearchTask::interrupt()
+{
+    AsyncTask::interrupt();
+    QMutexLocker locker(&mutex);
+    if (r2Task) {
+        r2Task->breakTask();
+    }
+}
+
+QList<SearchDescription> SearchTask::takeHits()
+{
+    QMutexLocker locker(&mutex);
+    QList<SearchDescription> taken;
+    taken.swap(hits);
+    return taken;
+}
+
+void SearchTask::runTask()
+{
+    if (space == patternSetSpace) {
+        searchPatterns();
+        return;
+    }
+    if (space == "/Rj" && searchGadgets()) {
+        return;
+    }
+
+    QString command = space + " " + searchFor;
+    if (ranges.isEmpty()) {
+        log(tr("Searching..."));
+        if (maxHits > 0) {
+            command += QString(" @e:search.maxhits=%1").arg(maxHits);
+        }
+        search(command, maxHits);
+        return;
+    }
+
+    for (const Range &range : ranges) {
+        int limit = 0;
+        {
+            QMutexLocker locker(&mutex);
+            currentRange = range.name;
+            if (maxHits > 0) {
+                limit = maxHits - hitCount;
+            }
+        }
+        emit hitsAvailable();
+        log(tr("Searching %1...").arg(range.name));
+
+        // Every range is searched on its own, so its hits can be shown before the next one starts
+        QString rangeCommand = command
+                               + QString(" @e:search.in=range,search.from=%1,search.to=%2")
+                               .arg(RAddressString(range.from), RAddressString(range.to));
+        if (limit > 0) {
+            rangeCommand += QString(",search.maxhits=%1").arg(limit);
+        }
+        if (!search(rangeCommand, limit)) {
+            return;
+        }
+    }
+}
+
+bool SearchTask::search(const QString &command, int limit)
+{
+    R2Task task(command);
+    {
+        QMutexLocker locker(&mutex);
+        if (isInterrupted()) {
+            return false;
+        }
+        // Started under the lock, so that interrupt() either prevents or breaks it
+        r2Task = &task;
+        task.startTask();
+    }
+    task.joinTask();
+    {
+        QMutexLocker locker(&mutex);
+        r2Task = nullptr;
+    }
+    if (isInterrupted()) {
+        return false;
+    }
+
+    QJsonDocument doc = Core()->parseJson(task.getResultRaw(), command);
+    QList<SearchDescription> found = Core()->parseSearchJson(doc, space);
+    if (limit > 0 && found.size() > limit) {
+        found.erase(found.begin() + limit, found.end());
+    }
+
+    bool limitReached;
+    {
+        QMutexLocker locker(&mutex);
+        hits.append(found);
+        hitCount += found.size();
+        done++;
+        limitReached = maxHits > 0 && hitCount >= maxHits;
+    }
+    emit hitsAvailable();
+    return !limitReached;
+}
+
+void SearchTask::searchPatterns()
+{
+    log(tr("Loading patterns from %1...").arg(searchFor));
+    QSharedPointer<PatternSet> patterns(new PatternSet());
+    QString loadError;
+    if (!patterns->load(searchFor, &loadError)) {
+        setError(loadError);
+        return;
+    }
+    patterns->compile();
+
+    QSharedPointer<PatternScanner> scanner = PatternScanner::forOpenFile(patterns);
+    if (!scanner->open()) {
+        setError(tr("The opened file can't be read directly"));
+        return;
+    }
+    {
+        QMutexLocker locker(&mutex);
+        total = scanner->chunkCount();
+        for (int i = 0; i < patterns->count(); i++) {
+            patternHits.append(qMakePair(patterns->pattern(i).name, 0));
+        }
+    }
+    log(tr("Searching for %n pattern(s)...", nullptr, patterns->count()));
+
+    auto handleHits = [this, &patterns, &scanner](std::vector<PatternScanner::Hit> &found) {
+        if (isInterrupted()) {
+            return false;
+        }
+        bool limitReached = false;
+        {
+            QMutexLocker locker(&mutex);
+            for (const PatternScanner::Hit &hit : found) {
+                if (maxHits > 0 && hitCount >= maxHits) {
+                    limitReached = true;
+                    break;
+                }
+                const PatternSet::Pattern &pattern = patterns->pattern(hit.pattern);
+                SearchDescription description;
+                description.offset = hit.vaddr;
+                description.size = static_cast<RVA>(pattern.bytes.size());
+                description.code = pattern.name;
+                description.data = QString::fromLatin1(
+                                       scanner->bytesAt(hit.offset, static_cast<size_t>(pattern.bytes.size())).toHex());
+                hits.append(description);
+                hitCount++;
+                patternHits[hit.pattern].second++;
+            }
+            limitReached = limitReached || (maxHits > 0 && hitCount >= maxHits);
+        }
+        emit hitsAvailable();
+        return !limitReached;
+    };
+    auto chunkDone = [this](int chunks) {
+        {
+            QMutexLocker locker(&mutex);
+            done = chunks;
+        }
+        emit hitsAvailable();
+        return !isInterrupted();
+    };
+    scanner->scan(handleHits, chunkDone);
+}
+
+bool SearchTask::searchGadgets()
+{
+    QSharedPointer<GadgetFinder> finder = GadgetFinder::forOpenFile();
+    finder->setFilter(searchFor);
+    if (!finder->open()) {
+        return false;
+    }
+    {
+        QMutexLocker locker(&mutex);
+        total = finder->chunkCount();
+        currentRange.clear();
+    }
+    log(tr("Searching for gadgets in the executable sections..."));
+
+    auto handleGadgets = [this](QList<SearchDescription> &found) {
+        if (isInterrupted()) {
+            return false;
+        }
+        bool limitReached;
+        {
+            QMutexLocker locker(&mutex);
+            if (maxHits > 0 && found.size() > maxHits - hitCount) {
+                found.erase(found.begin() + (maxHits - hitCount), found.end());
+            }
+            hits.append(found);
+            hitCount += found.size();
+            limitReached = maxHits > 0 && hitCount >= maxHits;
+        }
+        emit hitsAvailable();
+        return !limitReached;
+    };
+    auto chunkDone = [this](int chunks) {
+        {
+            QMutexLocker locker(&mutex);
+            done = chunks;
+        }
+        emit hitsAvailable();
+        return !isInterrupted();
+    };
+    finder->scan(handleGadgets, chunkDone);
+    return true;
+}
+
+void SearchTask::setError(const QString &message)
+{
+    log(message);
+    QMutexLocker locker(&mutex);
+    error = message;
+}
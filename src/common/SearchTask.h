@@ -0,0 +1,97 @@
+#ifndef SEARCHTASK_H
+#define SEARCHTASK_H
+
+#include "common/AsyncTask.h"
+#include "core/Cutter.h"
+
+#include <QMutex>
+#include <QPair>
+
+class R2Task;
+
+/**
+ * @brief Runs a search like "/xj" range by range and hands over the hits of each range as soon
+ * as it is done.
+ *
+ * Without ranges the search runs once within the configured search.in. The search stops after
+ * maxHits hits, if maxHits is greater than 0.
+ *
+ * ROP gadgets are searched natively in the executable sections if GadgetFinder supports the
+ * architecture.
+ *
+ * With patternSetSpace, searchFor is the path of a pattern set file and all of its patterns are
+ * searched natively in one pass over the mapped sections, see PatternScanner.
+ */
+class SearchTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    struct Range {
+        RVA from;
+        RVA to;
+        QString name;
+    };
+
+    static const char *const patternSetSpace;
+
+    SearchTask(const QString &searchFor, const QString &space, const QList<Range> &ranges,
+               int maxHits);
+
+    QString getTitle() override                     { return tr("Searching"); }
+
+    void interrupt() override;
+
+    /**
+     * @brief Take the hits found since the last call
+     */
+    QList<SearchDescription> takeHits();
+    int getDone()                                   { QMutexLocker locker(&mutex); return done; }
+    int getTotal()                                  { QMutexLocker locker(&mutex); return total; }
+    QString getCurrentRange()                       { QMutexLocker locker(&mutex); return currentRange; }
+    int getHitCount()                               { QMutexLocker locker(&mutex); return hitCount; }
+    bool isLimitReached()                           { QMutexLocker locker(&mutex); return maxHits > 0 && hitCount >= maxHits; }
+    QString getError()                              { QMutexLocker locker(&mutex); return error; }
+    /**
+     * @return name and number of hits of every pattern of a pattern set search
+     */
+    QList<QPair<QString, int>> getPatternHits()     { QMutexLocker locker(&mutex); return patternHits; }
+
+signals:
+    /**
+     * @brief New hits or progress are available
+     */
+    void hitsAvailable();
+
+protected:
+    void runTask() override;
+
+private:
+    QString searchFor;
+    QString space;
+    QList<Range> ranges;
+    int maxHits;
+
+    QMutex mutex;
+    R2Task *r2Task = nullptr;
+    QList<SearchDescription> hits;
+    int hitCount = 0;
+    int done = 0;
+    int total;
+    QString currentRange;
+    QString error;
+    QList<QPair<QString, int>> patternHits;
+
+    /**
+     * @return false if the search must stop
+     */
+    bool search(const QString &command, int limit);
+    void searchPatterns();
+    /**
+     * @return false if the gadgets can't be searched natively
+     */
+    bool searchGadgets();
+    void setError(const QString &message);
+};
+
+#endif // SEARCHTASK_H
@@ -0,0 +1,421 @@
+#include "core/AnalysisDataStore.h"
+#include "core/Cutter.h"
+#include "core/StringScanner.h"
+#include "core/EntropyMap.h"
+#include "core/ImmediateIndex.h"
+#include "core/TextIndex.h"
+#include "core/XrefGraph.h"
+#include "common/R2Task.h"
+
+#include <QTimer>
+#include <QJsonObject>
+
+AnalysisDataStore::AnalysisDataStore(CutterCore *core) :
+    QObject(core)
+{
+    // The store is created before any widget, so these run before the widgets' own
+    // slots for the same signals and requests made from there see the new generation.
+    connect(core, &CutterCore::refreshAll, this, &AnalysisDataStore::invalidateAll);
+    connect(core, &CutterCore::functionsChanged, this, [this]() {
+        invalidate(Kind::Functions);
+        invalidate(Kind::Flags);
+        invalidate(Kind::Immediates);
+        invalidate(Kind::Text);
+        invalidate(Kind::Xrefs);
+    });
+    connect(core, &CutterCore::functionRenamed, this, [this]() {
+        invalidate(Kind::Functions);
+        invalidate(Kind::Flags);
+        invalidate(Kind::Text);
+    });
+    connect(core, &CutterCore::flagsChanged, this, [this]() {
+        invalidate(Kind::Flags);
+        invalidate(Kind::Text);
+    });
+    connect(core, &CutterCore::commentsChanged, this, [this]() {
+        invalidate(Kind::Text);
+    });
+    connect(core, &CutterCore::asmOptionsChanged, this, [this]() {
+        invalidate(Kind::Text);
+    });
+    connect(core, &CutterCore::instructionChanged, this, [this](RVA offset) {
+        changedImmediateInstructions.insert(offset);
+        changedTextInstructions.insert(offset);
+        invalidate(Kind::Immediates);
+        invalidate(Kind::Text);
+        invalidate(Kind::Xrefs);
+    });
+}
+
+void AnalysisDataStore::invalidate(Kind kind)
+{
+    Entry &e = entry(kind);
+    e.generation++;
+    // Only the kinds that were requested before, no work is spent on data nobody looked at
+    bool keepCurrent = (kind == Kind::Immediates || kind == Kind::Text || kind == Kind::Xrefs)
+                       && e.dataGeneration != 0;
+    if (keepCurrent) {
+        // From the event loop, so that several changes in a row are indexed together
+        QTimer::singleShot(0, this, [this, kind]() {
+            request(kind);
+        });
+    }
+}
+
+void AnalysisDataStore::invalidateAll()
+{
+    for (int i = 0; i < static_cast<int>(Kind::Count); i++) {
+        invalidate(static_cast<Kind>(i));
+    }
+}
+
+void AnalysisDataStore::cancel(Kind kind)
+{
+    Entry &e = entry(kind);
+    if (!e.task) {
+        return;
+    }
+    disconnect(e.task.data(), nullptr, this, nullptr);
+    e.task->interrupt();
+    e.task.clear();
+    emit fetchingChanged(kind, false);
+}
+
+bool AnalysisDataStore::isCurrent(Kind kind) const
+{
+    const Entry &e = entry(kind);
+    return e.dataGeneration == e.generation;
+}
+
+QSharedPointer<const ImmediateIndex> AnalysisDataStore::updateImmediateIndex()
+{
+    if (isCurrent(Kind::Immediates)) {
+        return immediateIndex;
+    }
+    cancel(Kind::Immediates);
+    Entry &e = entry(Kind::Immediates);
+    QSet<RVA> changed = changedImmediateInstructions;
+    immediateIndex = ImmediateIndex::build(immediateIndex, changed);
+    changedImmediateInstructions.subtract(changed);
+    e.dataGeneration = e.generation;
+    emit dataReady(Kind::Immediates);
+    return immediateIndex;
+}
+
+void AnalysisDataStore::request(Kind kind)
+{
+    if (isCurrent(kind)) {
+        QTimer::singleShot(0, this, [this, kind]() {
+            emit dataReady(kind);
+        });
+        return;
+    }
+    Entry &e = entry(kind);
+    if (e.task && e.taskGeneration == e.generation) {
+        // Already being fetched, dataReady will follow
+        return;
+    }
+    startFetch(kind);
+}
+
+void AnalysisDataStore::startFetch(Kind kind)
+{
+    switch (kind) {
+    case Kind::Functions:
+        startFetch<FunctionsData>(kind, [](const InterruptedFunction &) {
+            FunctionsData data;
+            data.functions = Core()->getAllFunctions();
+            data.mainAddress = Core()->cmdj("iMj").object()["vaddr"].toVariant().toULongLong();
+            return data;
+        }, [this](const FunctionsData &data) {
+            functions = data.functions;
+            mainAddress = data.mainAddress;
+        }, tr("Fetching Functions"));
+        break;
+    case Kind::Imports:
+        startFetch<ImportsData>(kind, [](const InterruptedFunction &) {
+            ImportsData data;
+            data.imports = Core()->getAllImports();
+            for (const ImportDescription &import : data.imports) {
+                data.importAddresses.insert(import.plt);
+            }
+            return data;
+        }, [this](const ImportsData &data) {
+            imports = data.imports;
+            importAddresses = data.importAddresses;
+        }, tr("Fetching Imports"));
+        break;
+    case Kind::Symbols:
+        startFetch<QList<SymbolDescription>>(kind, [](const InterruptedFunction &) {
+            return Core()->getAllSymbols();
+        }, [this](const QList<SymbolDescription> &data) {
+            symbols = data;
+        }, tr("Fetching Symbols"));
+        break;
+    case Kind::Strings:
+        startStringsFetch();
+        break;
+    case Kind::Flags:
+        startFetch<QList<FlagDescription>>(kind, [](const InterruptedFunction &) {
+            return Core()->getAllFlags();
+        }, [this](const QList<FlagDescription> &data) {
+            flags = data;
+        }, tr("Fetching Flags"));
+        break;
+    case Kind::Sections:
+        startFetch<QList<SectionDescription>>(kind, [](const InterruptedFunction &) {
+            return Core()->getAllSections();
+        }, [this](const QList<SectionDescription> &data) {
+            sections = data;
+        }, tr("Fetching Sections"));
+        break;
+    case Kind::Entropy:
+        // Only depends on the file, so it is only computed again on refreshAll
+        startFetch<QSharedPointer<const EntropyMap>>(kind,
+                [](const InterruptedFunction &interrupted) {
+            return EntropyMap::build(Core()->getConfig("file.path"), Core()->getAllSections(),
+                                     interrupted);
+        }, [this](const QSharedPointer<const EntropyMap> &data) {
+            entropyMap = data;
+        }, tr("Computing Entropy"));
+        break;
+    case Kind::Immediates: {
+        QSharedPointer<const ImmediateIndex> previous = immediateIndex;
+        QSet<RVA> changed = changedImmediateInstructions;
+        startFetch<QSharedPointer<const ImmediateIndex>>(kind,
+                [previous, changed](const InterruptedFunction &interrupted) {
+            return ImmediateIndex::build(previous, changed, interrupted);
+        }, [this, changed](const QSharedPointer<const ImmediateIndex> &data) {
+            immediateIndex = data;
+            changedImmediateInstructions.subtract(changed);
+        }, tr("Indexing Immediates"));
+        break;
+    }
+    case Kind::Text: {
+        QSharedPointer<const TextIndex> previous = textIndex;
+        QSet<RVA> changed = changedTextInstructions;
+        startFetch<QSharedPointer<const TextIndex>>(kind,
+                [previous, changed](const InterruptedFunction &interrupted) {
+            return TextIndex::build(previous, changed, interrupted);
+        }, [this, changed](const QSharedPointer<const TextIndex> &data) {
+            textIndex = data;
+            changedTextInstructions.subtract(changed);
+        }, tr("Indexing Disassembly"));
+        break;
+    }
+    case Kind::Xrefs:
+        startFetch<QSharedPointer<const XrefGraph>>(kind,
+                [](const InterruptedFunction &interrupted) {
+            return XrefGraph::build(interrupted);
+        }, [this](const QSharedPointer<const XrefGraph> &data) {
+            xrefGraph = data;
+        }, tr("Building Cross-Reference Graph"));
+        break;
+    case Kind::Count:
+        break;
+    }
+}
+
+template<class Result>
+void AnalysisDataStore::startFetch(Kind kind,
+                                   std::function<Result(const InterruptedFunction &)> fetch,
+                                   std::function<void(const Result &)> apply, const QString &title)
+{
+    Entry &e = entry(kind);
+    if (e.task) {
+        // A fetch for an older generation is still running, its result will be dropped
+        disconnect(e.task.data(), nullptr, this, nullptr);
+        e.task->interrupt();
+    }
+
+    // Written by the worker thread, read here only after the task finished
+    QSharedPointer<Result> result(new Result());
+    auto fetchInto = [result, fetch](const InterruptedFunction &interrupted) {
+        *result = fetch(interrupted);
+    };
+    AsyncTask::Ptr task(new AnalysisDataFetchTask(title, fetchInto));
+    quint64 generation = e.generation;
+    e.task = task;
+    e.taskGeneration = generation;
+
+    AsyncTask *taskPtr = task.data();
+    connect(taskPtr, &AsyncTask::finished, this, [this, kind, apply, result, generation, taskPtr]() {
+        Entry &e = entry(kind);
+        if (e.task.data() != taskPtr) {
+            return;
+        }
+        e.task.clear();
+        if (taskPtr->isInterrupted()) {
+            // Stopped from outside the store, e.g. from the tasks dialog, the result is partial
+            emit fetchingChanged(kind, false);
+            return;
+        }
+        if (generation != e.generation) {
+            // Outdated while fetching, someone is still waiting for current data
+            startFetch(kind);
+            return;
+        }
+        apply(*result);
+        e.dataGeneration = generation;
+        emit fetchingChanged(kind, false);
+        emit dataReady(kind);
+    });
+    Core()->getAsyncTaskManager()->start(task);
+    emit fetchingChanged(kind, true);
+}
+
+void AnalysisDataStore::startStringsFetch()
+{
+    // Small enough for the first rows to show up quickly, large enough to keep the number of
+    // model updates low
+    const int batchSize = 10000;
+
+    Entry &e = entry(Kind::Strings);
+    if (e.task) {
+        disconnect(e.task.data(), nullptr, this, nullptr);
+        e.task->interrupt();
+    }
+
+    StringsFetchTask *task = new StringsFetchTask(batchSize);
+    quint64 generation = e.generation;
+    e.task = AsyncTask::Ptr(task);
+    e.taskGeneration = generation;
+
+    // Replaces strings with the first batch, so the previous list stays visible until then
+    fetchedStrings = QSharedPointer<const CompactStringList>(new CompactStringList());
+    connect(task, &StringsFetchTask::batchesAvailable, this, [this, task]() {
+        appendStringsBatches(task);
+    });
+    connect(task, &AsyncTask::finished, this, [this, task, generation]() {
+        Entry &e = entry(Kind::Strings);
+        if (e.task.data() != task) {
+            return;
+        }
+        appendStringsBatches(task);
+        e.task.clear();
+        if (generation != e.generation) {
+            startStringsFetch();
+            return;
+        }
+        strings = fetchedStrings;
+        e.dataGeneration = generation;
+        emit fetchingChanged(Kind::Strings, false);
+        emit dataReady(Kind::Strings);
+    });
+    Core()->getAsyncTaskManager()->start(e.task);
+    emit fetchingChanged(Kind::Strings, true);
+    emit stringsProgress(0, 0);
+}
+
+void AnalysisDataStore::appendStringsBatches(StringsFetchTask *task)
+{
+    // Every batch makes a new snapshot sharing the rows of the previous one, which may still be
+    // read by a sort or filter running in another thread
+    int first = fetchedStrings->count();
+    QSharedPointer<CompactStringList> list(new CompactStringList());
+    list->appendShared(fetchedStrings);
+    for (const QSharedPointer<CompactStringList> &batch : task->takeBatches()) {
+        list->appendShared(batch);
+    }
+    if (list->count() > first) {
+        fetchedStrings = list;
+        strings = list;
+        emit stringsAppended(first, list->count() - 1);
+    }
+    emit stringsProgress(task->getDone(), task->getTotal());
+}
+
+void StringsFetchTask::interrupt()
+{
+    AsyncTask::interrupt();
+    QMutexLocker locker(&mutex);
+    if (r2Task) {
+        r2Task->breakTask();
+    }
+}
+
+QList<QSharedPointer<CompactStringList>> StringsFetchTask::takeBatches()
+{
+    QMutexLocker locker(&mutex);
+    QList<QSharedPointer<CompactStringList>> taken;
+    taken.swap(batches);
+    return taken;
+}
+
+void StringsFetchTask::runTask()
+{
+    if (!scanFile()) {
+        runIzzj();
+    }
+}
+
+bool StringsFetchTask::scanFile()
+{
+    QSharedPointer<StringScanner> scanner = StringScanner::forOpenFile();
+    if (!scanner->open()) {
+        return false;
+    }
+    int chunks = scanner->chunkCount();
+    scanner->scan(batchSize, [this](CompactStringList &batch) {
+        return addBatch(batch);
+    }, [this, chunks](int done) {
+        setProgress(done, chunks);
+        return !isInterrupted();
+    });
+    return true;
+}
+
+void StringsFetchTask::runIzzj()
+{
+    R2Task command("izzj");
+    {
+        QMutexLocker locker(&mutex);
+        if (isInterrupted()) {
+            return;
+        }
+        // Started under the lock, so that interrupt() either prevents or breaks it
+        r2Task = &command;
+        command.startTask();
+    }
+    command.joinTask();
+    {
+        QMutexLocker locker(&mutex);
+        r2Task = nullptr;
+    }
+    if (isInterrupted()) {
+        return;
+    }
+
+    auto handleBatch = [this](CompactStringList &batch, int parsed, int total) {
+        if (!addBatch(batch)) {
+            return false;
+        }
+        setProgress(parsed, total);
+        return true;
+    };
+    QJsonDocument doc = Core()->parseJson(command.getResultRaw(), "izzj");
+    Core()->parseStringsJson(doc, batchSize, handleBatch);
+}
+
+bool StringsFetchTask::addBatch(CompactStringList &batch)
+{
+    if (isInterrupted()) {
+        return false;
+    }
+    {
+        QMutexLocker locker(&mutex);
+        batches.append(QSharedPointer<CompactStringList>(new CompactStringList(std::move(batch))));
+    }
+    emit batchesAvailable();
+    return true;
+}
+
+void StringsFetchTask::setProgress(int done, int total)
+{
+    {
+        QMutexLocker locker(&mutex);
+        this->done = done;
+        this->total = total;
+    }
+    emit batchesAvailable();
+}
@@ -0,0 +1,271 @@
+#ifndef ANALYSISDATASTORE_H
+#define ANALYSISDATASTORE_H
+
+#include <QObject>
+#include <QList>
+#include <QSharedPointer>
+#include <QSet>
+#include <QMutex>
+
+#include <functional>
+
+#include "core/CutterDescriptions.h"
+#include "core/CompactStringList.h"
+#include "common/AsyncTask.h"
+
+class CutterCore;
+class R2Task;
+class StringsFetchTask;
+class EntropyMap;
+class ImmediateIndex;
+class TextIndex;
+class XrefGraph;
+
+/**
+ * @brief Shared cache of the lists of analysis entities that several widgets display.
+ *
+ * Each kind of data is fetched at most once per generation on a worker thread, no matter how
+ * many widgets ask for it. The lists are handed out as implicitly shared QLists, or shared
+ * pointers for the strings, so every consumer references the same data until it is replaced by
+ * the next generation.
+ *
+ * Widgets call request() for the kinds they need whenever they want to refresh and reload from
+ * the getters when dataReady is emitted for one of these kinds. Generations are advanced by the
+ * CutterCore change signals, e.g. refreshAll invalidates everything and functionsChanged only
+ * the functions.
+ *
+ * The strings can take minutes on large binaries and are streamed instead: getStrings() switches
+ * to the new list with its first batch and stringsAppended is emitted for every batch after that.
+ * Each batch publishes a new snapshot that shares the rows of the one before, see
+ * CompactStringList::startsWith().
+ *
+ * The immediate and text indexes and the cross-reference graph are only built once requested,
+ * but then kept current whenever the functions or written instructions change. The indexes reuse
+ * the previous index for the functions that didn't, the text index also follows the comments and
+ * flags.
+ */
+class AnalysisDataStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Kind { Functions, Imports, Symbols, Strings, Flags, Sections, Entropy, Immediates, Text, Xrefs, Count };
+
+    explicit AnalysisDataStore(CutterCore *core);
+
+    /**
+     * @brief Make sure the data of kind is up to date. dataReady is always emitted afterwards,
+     * from the event loop if the data already is current.
+     */
+    void request(Kind kind);
+
+    /**
+     * @brief Bring the immediate index up to date on the calling thread, for callers that can't
+     * wait for dataReady. Reuses the index of the store and keeps the result in it.
+     */
+    QSharedPointer<const ImmediateIndex> updateImmediateIndex();
+
+    /**
+     * @brief Mark the data of kind as outdated, it will be fetched again on the next request.
+     */
+    void invalidate(Kind kind);
+    void invalidateAll();
+
+    /**
+     * @brief Stop fetching kind. What was fetched so far stays available, but isn't current.
+     */
+    void cancel(Kind kind);
+
+    bool isFetching(Kind kind) const            { return !entry(kind).task.isNull(); }
+
+    /**
+     * @return whether the snapshot of kind belongs to the current generation
+     */
+    bool isCurrent(Kind kind) const;
+
+    /**
+     * @return current generation of kind, for caches derived from the same data
+     */
+    quint64 getGeneration(Kind kind) const      { return entry(kind).generation; }
+
+    QList<FunctionDescription> getFunctions() const     { return functions; }
+    /**
+     * @return address of main, fetched together with the functions
+     */
+    RVA getMainAddress() const                          { return mainAddress; }
+    QList<ImportDescription> getImports() const         { return imports; }
+    /**
+     * @return PLT addresses of the imports, computed together with the imports
+     */
+    QSet<RVA> getImportAddresses() const                { return importAddresses; }
+    QList<SymbolDescription> getSymbols() const         { return symbols; }
+    /**
+     * @return the strings in columnar form, there can be millions of them
+     */
+    QSharedPointer<const CompactStringList> getStrings() const { return strings; }
+    QList<FlagDescription> getFlags() const             { return flags; }
+    QList<SectionDescription> getSections() const       { return sections; }
+    /**
+     * @return entropy map of the opened file, null if it can't be read directly
+     */
+    QSharedPointer<const EntropyMap> getEntropyMap() const { return entropyMap; }
+    /**
+     * @return index of the immediates in the analysed functions, null until requested
+     */
+    QSharedPointer<const ImmediateIndex> getImmediateIndex() const { return immediateIndex; }
+    /**
+     * @return full-text index of the disassembly, comments and flags, null until requested
+     */
+    QSharedPointer<const TextIndex> getTextIndex() const { return textIndex; }
+    /**
+     * @return graph of the references between the functions, null until first built
+     */
+    QSharedPointer<const XrefGraph> getXrefGraph() const { return xrefGraph; }
+
+signals:
+    void dataReady(AnalysisDataStore::Kind kind);
+    void fetchingChanged(AnalysisDataStore::Kind kind, bool fetching);
+
+    /**
+     * @brief Rows first to last of getStrings() were added by the running fetch.
+     */
+    void stringsAppended(int first, int last);
+    /**
+     * @brief The running strings fetch did done out of total steps, total is 0 while unknown.
+     */
+    void stringsProgress(int done, int total);
+
+private:
+    struct Entry {
+        // Incremented each time the data becomes outdated
+        quint64 generation = 1;
+        // Generation of the data currently held, 0 if never fetched
+        quint64 dataGeneration = 0;
+        // Set while a fetch is running, its result is dropped if generation changed meanwhile
+        AsyncTask::Ptr task;
+        quint64 taskGeneration = 0;
+    };
+
+    Entry entries[static_cast<int>(Kind::Count)];
+
+    struct FunctionsData {
+        QList<FunctionDescription> functions;
+        RVA mainAddress = RVA_INVALID;
+    };
+
+    struct ImportsData {
+        QList<ImportDescription> imports;
+        QSet<RVA> importAddresses;
+    };
+
+    QList<FunctionDescription> functions;
+    RVA mainAddress = RVA_INVALID;
+    QList<ImportDescription> imports;
+    QSet<RVA> importAddresses;
+    QList<SymbolDescription> symbols;
+    QSharedPointer<const CompactStringList> strings;
+    // Snapshot with all batches of the running strings fetch
+    QSharedPointer<const CompactStringList> fetchedStrings;
+    QList<FlagDescription> flags;
+    QList<SectionDescription> sections;
+    QSharedPointer<const EntropyMap> entropyMap;
+    QSharedPointer<const ImmediateIndex> immediateIndex;
+    QSharedPointer<const TextIndex> textIndex;
+    QSharedPointer<const XrefGraph> xrefGraph;
+    // Written since the immediate and text indexes were last built, their functions are
+    // decoded again
+    QSet<RVA> changedImmediateInstructions;
+    QSet<RVA> changedTextInstructions;
+
+    // Returns true once the running fetch should stop
+    typedef std::function<bool()> InterruptedFunction;
+
+    Entry &entry(Kind kind)                     { return entries[static_cast<int>(kind)]; }
+    const Entry &entry(Kind kind) const         { return entries[static_cast<int>(kind)]; }
+
+    void startFetch(Kind kind);
+    void startStringsFetch();
+    void appendStringsBatches(StringsFetchTask *task);
+    /**
+     * @brief Run fetch on a worker thread and hand its result to apply on the main thread,
+     * unless the kind became outdated meanwhile. fetch is passed a function to poll for stopping
+     * early, its result is dropped then.
+     */
+    template<class Result> void startFetch(Kind kind,
+                                           std::function<Result(const InterruptedFunction &)> fetch,
+                                           std::function<void(const Result &)> apply,
+                                           const QString &title);
+};
+
+/**
+ * @brief Runs a single fetch function of AnalysisDataStore in the thread pool.
+ */
+class AnalysisDataFetchTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    AnalysisDataFetchTask(const QString &title,
+                          std::function<void(const std::function<bool()> &interrupted)> fetch)
+        : title(title), fetch(fetch) {}
+
+    QString getTitle() override                     { return title; }
+
+protected:
+    void runTask() override                         { fetch([this]() { return isInterrupted(); }); }
+
+private:
+    QString title;
+    std::function<void(const std::function<bool()> &interrupted)> fetch;
+};
+
+/**
+ * @brief Searches for the strings and hands them over in batches as they are found.
+ *
+ * The file is scanned natively with StringScanner, izzj is only used when the file can't be read
+ * directly, e.g. while debugging.
+ */
+class StringsFetchTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    explicit StringsFetchTask(int batchSize)
+        : batchSize(batchSize) {}
+
+    QString getTitle() override                     { return tr("Searching for Strings"); }
+
+    void interrupt() override;
+
+    /**
+     * @brief Take the batches parsed since the last call
+     */
+    QList<QSharedPointer<CompactStringList>> takeBatches();
+    int getDone()                                   { QMutexLocker locker(&mutex); return done; }
+    int getTotal()                                  { QMutexLocker locker(&mutex); return total; }
+
+signals:
+    /**
+     * @brief New batches or progress are available
+     */
+    void batchesAvailable();
+
+protected:
+    void runTask() override;
+
+private:
+    int batchSize;
+
+    QMutex mutex;
+    R2Task *r2Task = nullptr;
+    QList<QSharedPointer<CompactStringList>> batches;
+    int done = 0;
+    int total = 0;
+
+    bool scanFile();
+    void runIzzj();
+    bool addBatch(CompactStringList &batch);
+    void setProgress(int done, int total);
+};
+
+#endif // ANALYSISDATASTORE_H
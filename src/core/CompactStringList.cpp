@@ -0,0 +1,112 @@
+#include "core/CompactStringList.h"
+
+void CompactStringList::reserve(int count)
+{
+    size_t n = static_cast<size_t>(count);
+    vaddrs.reserve(n);
+    lengths.reserve(n);
+    sizes.reserve(n);
+    typeIds.reserve(n);
+    sectionIds.reserve(n);
+    strings.reserve(n, 0);
+}
+
+void CompactStringList::squeeze()
+{
+    vaddrs.shrink_to_fit();
+    lengths.shrink_to_fit();
+    sizes.shrink_to_fit();
+    typeIds.shrink_to_fit();
+    sectionIds.shrink_to_fit();
+    strings.squeeze();
+    sharedLists.shrink_to_fit();
+    sharedEnds.shrink_to_fit();
+}
+
+void CompactStringList::append(const StringDescription &string)
+{
+    vaddrs.push_back(string.vaddr);
+    lengths.push_back(string.length);
+    sizes.push_back(string.size);
+    typeIds.push_back(categories.intern(string.type));
+    sectionIds.push_back(categories.intern(string.section));
+    strings.append(string.string);
+}
+
+void CompactStringList::append(const CompactStringList &other)
+{
+    for (int i = 0; i < other.count(); i++) {
+        vaddrs.push_back(other.vaddr(i));
+        lengths.push_back(other.length(i));
+        sizes.push_back(other.size(i));
+        typeIds.push_back(categories.intern(other.type(i)));
+        sectionIds.push_back(categories.intern(other.section(i)));
+        strings.append(other.string(i));
+    }
+}
+
+void CompactStringList::appendShared(const QSharedPointer<const CompactStringList> &other)
+{
+    Q_ASSERT(ownCount() == 0);
+    // Flattened, so that every row is found with one search
+    for (size_t i = 0; i < other->sharedLists.size(); i++) {
+        sharedLists.push_back(other->sharedLists[i]);
+        sharedCount += other->sharedLists[i]->ownCount();
+        sharedEnds.push_back(sharedCount);
+    }
+    if (other->ownCount() > 0) {
+        sharedLists.push_back(other);
+        sharedCount += other->ownCount();
+        sharedEnds.push_back(sharedCount);
+    }
+}
+
+bool CompactStringList::startsWith(const CompactStringList &other) const
+{
+    if (other.ownCount() > 0) {
+        // Only the own rows of a list that was shared entirely are shared
+        return other.sharedLists.empty()
+               && !sharedLists.empty() && sharedLists.front().data() == &other;
+    }
+    return other.sharedLists.size() <= sharedLists.size()
+           && std::equal(other.sharedLists.begin(), other.sharedLists.end(), sharedLists.begin());
+}
+
+StringDescription CompactStringList::at(int i) const
+{
+    StringDescription string;
+    string.vaddr = vaddr(i);
+    string.string = this->string(i);
+    string.type = type(i);
+    string.section = section(i);
+    string.length = length(i);
+    string.size = size(i);
+    return string;
+}
+
+bool CompactStringList::stringLess(int i, int j) const
+{
+    const CompactStringList &left = locate(i);
+    const CompactStringList &right = locate(j);
+    if (&left == &right) {
+        return left.strings.less(static_cast<size_t>(i), static_cast<size_t>(j));
+    }
+    return left.strings.less(static_cast<size_t>(i), right.strings, static_cast<size_t>(j));
+}
+
+size_t CompactStringList::memoryUsage() const
+{
+    size_t usage = ownMemoryUsage();
+    for (const QSharedPointer<const CompactStringList> &list : sharedLists) {
+        usage += list->ownMemoryUsage();
+    }
+    return usage;
+}
+
+size_t CompactStringList::ownMemoryUsage() const
+{
+    return vaddrs.capacity() * sizeof(RVA)
+           + (lengths.capacity() + sizes.capacity()) * sizeof(ut32)
+           + (typeIds.capacity() + sectionIds.capacity()) * sizeof(quint32)
+           + strings.memoryUsage();
+}
@@ -0,0 +1,154 @@
+#ifndef COMPACTSTRINGLIST_H
+#define COMPACTSTRINGLIST_H
+
+#include <QRegExp>
+#include <QSharedPointer>
+
+#include <algorithm>
+#include <vector>
+
+#include "core/CutterCommon.h"
+#include "core/CutterDescriptions.h"
+#include "common/CompactStorage.h"
+
+/**
+ * @brief Column-wise storage of StringDescriptions for binaries with millions of strings.
+ *
+ * Numeric fields are kept in contiguous arrays, the types and sections are interned and the
+ * strings themselves share a single StringArena. at() assembles a StringDescription for code
+ * that works on the structs, models and proxies read the columns directly.
+ *
+ * A list can also start with the rows of other lists that don't change anymore, which are
+ * shared instead of copied. Growing lists are published that way, every snapshot shares the
+ * batches of the one before and stays immutable while the next one is made.
+ */
+class CompactStringList
+{
+public:
+    void reserve(int count);
+    void squeeze();
+
+    void append(const StringDescription &string);
+    void append(const CompactStringList &other);
+    /**
+     * @brief Append the rows of other without copying them. other must not change anymore and
+     * this list must not have rows of its own yet.
+     */
+    void appendShared(const QSharedPointer<const CompactStringList> &other);
+
+    /**
+     * @return whether the rows of other are the first rows of this list, shared by appendShared()
+     */
+    bool startsWith(const CompactStringList &other) const;
+
+    int count() const                           { return sharedCount + ownCount(); }
+    bool isEmpty() const                        { return count() == 0; }
+
+    StringDescription at(int i) const;
+
+    RVA vaddr(int i) const;
+    QString string(int i) const;
+    const QString &type(int i) const;
+    const QString &section(int i) const;
+    ut32 length(int i) const;
+    ut32 size(int i) const;
+
+    bool stringLess(int i, int j) const;
+    bool stringContains(int i, const QRegExp &regExp) const;
+    bool stringContains(int i, QRegExp &regExp) const;
+
+    /**
+     * @return approximate heap usage in bytes, including the shared rows
+     */
+    size_t memoryUsage() const;
+
+private:
+    std::vector<RVA> vaddrs;
+    std::vector<ut32> lengths;
+    std::vector<ut32> sizes;
+    // Types and sections share one interner, both are short lists of names
+    std::vector<quint32> typeIds;
+    std::vector<quint32> sectionIds;
+    StringInterner categories;
+    StringArena strings;
+
+    // Lists whose own rows come before the rows above, and the row after each of them
+    std::vector<QSharedPointer<const CompactStringList>> sharedLists;
+    std::vector<int> sharedEnds;
+    int sharedCount = 0;
+
+    int ownCount() const                        { return static_cast<int>(vaddrs.size()); }
+    size_t ownMemoryUsage() const;
+
+    /**
+     * @return the list holding row i among its own rows, i is changed to the row there
+     */
+    const CompactStringList &locate(int &i) const;
+};
+
+inline const CompactStringList &CompactStringList::locate(int &i) const
+{
+    if (i >= sharedCount) {
+        i -= sharedCount;
+        return *this;
+    }
+    // Read for every row the views show, the common case of a single list skips the search
+    size_t list = sharedEnds.size() == 1
+                  ? 0
+                  : static_cast<size_t>(std::upper_bound(sharedEnds.begin(), sharedEnds.end(), i)
+                                        - sharedEnds.begin());
+    if (list > 0) {
+        i -= sharedEnds[list - 1];
+    }
+    return *sharedLists[list];
+}
+
+inline RVA CompactStringList::vaddr(int i) const
+{
+    const CompactStringList &list = locate(i);
+    return list.vaddrs[static_cast<size_t>(i)];
+}
+
+inline QString CompactStringList::string(int i) const
+{
+    const CompactStringList &list = locate(i);
+    return list.strings.at(static_cast<size_t>(i));
+}
+
+inline const QString &CompactStringList::type(int i) const
+{
+    const CompactStringList &list = locate(i);
+    return list.categories.at(list.typeIds[static_cast<size_t>(i)]);
+}
+
+inline const QString &CompactStringList::section(int i) const
+{
+    const CompactStringList &list = locate(i);
+    return list.categories.at(list.sectionIds[static_cast<size_t>(i)]);
+}
+
+inline ut32 CompactStringList::length(int i) const
+{
+    const CompactStringList &list = locate(i);
+    return list.lengths[static_cast<size_t>(i)];
+}
+
+inline ut32 CompactStringList::size(int i) const
+{
+    const CompactStringList &list = locate(i);
+    return list.sizes[static_cast<size_t>(i)];
+}
+
+inline bool CompactStringList::stringContains(int i, const QRegExp &regExp) const
+{
+    const CompactStringList &list = locate(i);
+    return list.strings.contains(static_cast<size_t>(i), regExp);
+}
+
+inline bool CompactStringList::stringContains(int i, QRegExp &regExp) const
+{
+    const CompactStringList &list = locate(i);
+    return list.strings.contains(static_cast<size_t>(i), regExp);
+}
+
+#endif // COMPACTSTRINGLIST_H
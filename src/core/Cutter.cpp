@@ -3,10 +3,15 @@
 #include <QRegularExpression>
 #include <QDir>
 #include <QCoreApplication>
+#include <QSet>
+
+#include <algorithm>
+#include <limits>
 
 #include "common/TempConfig.h"
 #include "common/Configuration.h"
 #include "common/AsyncTask.h"
+#include "core/AnalysisDataStore.h"
 #include "common/R2Task.h"
 #include "common/Json.h"
 #include "core/Cutter.h"
@@ -37,7 +42,6 @@ namespace RJsonKey {
     R_JSON_KEY(ebbs);
     R_JSON_KEY(edges);
     R_JSON_KEY(enabled);
-    R_JSON_KEY(entropy);
     R_JSON_KEY(fcn_addr);
     R_JSON_KEY(fcn_name);
     R_JSON_KEY(fields);
@@ -183,6 +187,9 @@ void CutterCore::initialize()
 
     // Initialize Async tasks manager
     asyncTaskManager = new AsyncTaskManager(this);
+
+    // Initialize the shared analysis data, must be before any widget connects to our signals
+    dataStore = new AnalysisDataStore(this);
 }
 
 QList<QString> CutterCore::sdbList(QString path)
@@ -537,13 +544,13 @@ int CutterCore::sizeofDataMeta(RVA addr)
 void CutterCore::setComment(RVA addr, const QString &cmt)
 {
     cmd("CCu base64:" + cmt.toLocal8Bit().toBase64() + " @ " + QString::number(addr));
-    emit commentsChanged();
+    emit commentsChanged(addr);
 }
 
 void CutterCore::delComment(RVA addr)
 {
     cmd("CC- @ " + QString::number(addr));
-    emit commentsChanged();
+    emit commentsChanged(addr);
 }
 
 void CutterCore::setImmediateBase(const QString &r2BaseName, RVA offset)
@@ -802,6 +809,28 @@ QString CutterCore::disassembleSingleInstruction(RVA addr)
     return cmd("pi 1@" + QString::number(addr)).simplified();
 }
 
+QList<QPair<int, QString>> CutterCore::disassembleInstructions(const QVector<RVA> &addresses)
+{
+    CORE_LOCK();
+    QList<QPair<int, QString>> ret;
+    ut8 buffer[32];
+    for (RVA addr : addresses) {
+        int size = 0;
+        QString text;
+        if (r_io_read_at(core_->io, addr, buffer, sizeof(buffer))) {
+            RAsmOp op = {};
+            r_asm_set_pc(core_->assembler, addr);
+            size = r_asm_disassemble(core_->assembler, &op, buffer, sizeof(buffer));
+            if (size > 0) {
+                text = QString::fromUtf8(r_asm_op_get_asm(&op));
+            }
+            r_asm_op_fini(&op);
+        }
+        ret << qMakePair(std::max(size, 0), text);
+    }
+    return ret;
+}
+
 RAnalFunction *CutterCore::functionAt(ut64 addr)
 {
     CORE_LOCK();
@@ -1306,24 +1335,41 @@ QList<MemoryMapDescription> CutterCore::getMemoryMap()
 
 QStringList CutterCore::getStats()
 {
-    QStringList stats;
-    cmd("fs functions");
-    stats << cmd("f~?").trimmed();
-
-    QString imps = cmd("ii~?").trimmed();
-    stats << imps;
+    // Functions change the flags as well, so the flags' generation covers everything counted
+    quint64 generation = dataStore->getGeneration(AnalysisDataStore::Kind::Flags);
+    if (generation == statsGeneration) {
+        return stats;
+    }
 
-    cmd("fs symbols");
-    stats << cmd("f~?").trimmed();
-    cmd("fs strings");
-    stats << cmd("f~?").trimmed();
-    cmd("fs relocs");
-    stats << cmd("f~?").trimmed();
-    cmd("fs sections");
-    stats << cmd("f~?").trimmed();
-    cmd("fs *");
-    stats << cmd("f~?").trimmed();
+    CORE_LOCK();
+    // One pass over all flags, counted by flagspace instead of selecting each one with "fs"
+    struct Counts {
+        QHash<const RSpace *, int> perSpace;
+        int total = 0;
+    } counts;
+    r_flag_foreach(core_->flags, [](RFlagItem *item, void *user) -> bool {
+        Counts *counts = static_cast<Counts *>(user);
+        counts->perSpace[item->space]++;
+        counts->total++;
+        return true;
+    }, &counts);
+    auto spaceCount = [this, &counts](const char *name) {
+        const RSpace *space = r_flag_space_get(core_->flags, name);
+        return space ? counts.perSpace.value(space) : 0;
+    };
 
+    RList *imports = r_bin_get_imports(core_->bin);
+    int importCount = imports ? r_list_length(imports) : 0;
+
+    stats.clear();
+    stats << QString::number(spaceCount("functions"));
+    stats << QString::number(importCount);
+    stats << QString::number(spaceCount("symbols"));
+    stats << QString::number(spaceCount("strings"));
+    stats << QString::number(spaceCount("relocs"));
+    stats << QString::number(spaceCount("sections"));
+    stats << QString::number(counts.total);
+    statsGeneration = generation;
     return stats;
 }
 
@@ -1514,6 +1560,47 @@ QList<FunctionDescription> CutterCore::getAllFunctions()
     return parseFunctionsJson(cmdjTask("aflj"));
 }
 
+/**
+ * @brief Build the call graph of all analyzed functions directly from the analysis
+ * without going through the JSON output of agCj.
+ * @return one node per function with the deduplicated entry points of the functions it calls
+ */
+QList<CallGraphNodeDescription> CutterCore::getCallGraph()
+{
+    CORE_LOCK();
+    QList<CallGraphNodeDescription> ret;
+    RListIter *it;
+    RListIter *refIt;
+    RAnalFunction *fcn;
+    RAnalRef *ref;
+
+    CutterRListForeach(core_->anal->fcns, it, RAnalFunction, fcn) {
+        CallGraphNodeDescription node;
+        node.offset = fcn->addr;
+        node.size = r_anal_fcn_size(fcn);
+        node.name = QString::fromUtf8(fcn->name);
+
+        RList *refs = r_anal_fcn_get_refs(core_->anal, fcn);
+        QSet<RVA> seen;
+        CutterRListForeach(refs, refIt, RAnalRef, ref) {
+            if (ref->type != R_ANAL_REF_TYPE_CALL || seen.contains(ref->addr)) {
+                continue;
+            }
+            RAnalFunction *callee = r_anal_get_fcn_in(core_->anal, ref->addr, 0);
+            if (!callee || callee->addr != ref->addr) {
+                continue;
+            }
+            seen.insert(ref->addr);
+            node.callees << ref->addr;
+        }
+        r_list_free(refs);
+
+        ret << node;
+    }
+
+    return ret;
+}
+
 QList<ImportDescription> CutterCore::getAllImports()
 {
     CORE_LOCK();
@@ -1674,6 +1761,18 @@ QList<CommentDescription> CutterCore::getAllComments(const QString &filterType)
     return ret;
 }
 
+QList<RVA> CutterCore::getCommentOffsets()
+{
+    CORE_LOCK();
+    QList<RVA> ret;
+
+    QJsonArray commentsArray = cmdj("CCj").array();
+    for (const QJsonValue &value : commentsArray) {
+        ret << value.toObject()[RJsonKey::offset].toVariant().toULongLong();
+    }
+    return ret;
+}
+
 QList<RelocDescription> CutterCore::getAllRelocs()
 {
     CORE_LOCK();
@@ -1702,16 +1801,31 @@ QList<RelocDescription> CutterCore::getAllRelocs()
     return ret;
 }
 
-QList<StringDescription> CutterCore::getAllStrings()
+CompactStringList CutterCore::getAllStrings()
 {
     return parseStringsJson(cmdjTask("izzj"));
 }
 
-QList<StringDescription> CutterCore::parseStringsJson(const QJsonDocument &doc)
+CompactStringList CutterCore::parseStringsJson(const QJsonDocument &doc)
 {
-    QList<StringDescription> ret;
+    CompactStringList ret;
+    auto takeAll = [&ret](CompactStringList &batch, int, int) {
+        ret = std::move(batch);
+        return true;
+    };
+    parseStringsJson(doc, std::numeric_limits<int>::max(), takeAll);
+    return ret;
+}
 
+void CutterCore::parseStringsJson(const QJsonDocument &doc, int batchSize,
+                                  const std::function<bool(CompactStringList &, int, int)> &handleBatch)
+{
     QJsonArray stringsArray = doc.array();
+    int total = stringsArray.size();
+    int parsed = 0;
+
+    CompactStringList batch;
+    batch.reserve(std::min(batchSize, total));
     for (const QJsonValue &value : stringsArray) {
         QJsonObject stringObject = value.toObject();
 
@@ -1724,10 +1838,21 @@ QList<StringDescription> CutterCore::parseStringsJson(const QJsonDocument &doc)
         string.length = stringObject[RJsonKey::length].toVariant().toUInt();
         string.section = stringObject[RJsonKey::section].toString();
 
-        ret << string;
+        batch.append(string);
+        parsed++;
+
+        if (batch.count() == batchSize) {
+            if (!handleBatch(batch, parsed, total)) {
+                return;
+            }
+            batch = CompactStringList();
+            batch.reserve(std::min(batchSize, total - parsed));
+        }
     }
 
-    return ret;
+    if (!batch.isEmpty() || total == 0) {
+        handleBatch(batch, parsed, total);
+    }
 }
 
 QList<FunctionDescription> CutterCore::parseFunctionsJson(const QJsonDocument &doc)
@@ -1778,26 +1903,55 @@ QList<FlagspaceDescription> CutterCore::getAllFlagspaces()
 }
 
 QList<FlagDescription> CutterCore::getAllFlags(QString flagspace)
+{
+    return getFlags(flagspace);
+}
+
+QList<FlagDescription> CutterCore::getFlags(const QString &flagspace, RVA from, RVA to, int limit)
 {
     CORE_LOCK();
     QList<FlagDescription> ret;
 
-    if (!flagspace.isEmpty())
-        cmd("fs " + flagspace);
-    else
-        cmd("fs *");
+    // Filtering here instead of selecting the flagspace with "fs" leaves the state of the core
+    // untouched, so this can run in a task while the user works with other flagspaces.
+    const RSpace *space = nullptr;
+    if (!flagspace.isEmpty()) {
+        space = r_flag_space_get(core_->flags, flagspace.toUtf8().constData());
+        if (!space) {
+            return ret;
+        }
+    }
 
-    QJsonArray flagsArray = cmdj("fj").array();
-    for (const QJsonValue &value : flagsArray) {
-        QJsonObject flagObject = value.toObject();
+    struct Context {
+        const RSpace *space;
+        int limit;
+        QList<FlagDescription> *flags;
+    } context = { space, limit, &ret };
 
-        FlagDescription flag;
+    auto collect = [](RFlagItem *item, void *user) -> bool {
+        Context *context = static_cast<Context *>(user);
+        if (context->space && item->space != context->space) {
+            return true;
+        }
+        // Pages end between two addresses, so that the next one can start at the following address
+        QList<FlagDescription> &flags = *context->flags;
+        if (context->limit > 0 && flags.size() >= context->limit
+                && flags.last().offset != item->offset) {
+            return false;
+        }
 
-        flag.offset = flagObject[RJsonKey::offset].toVariant().toULongLong();
-        flag.size = flagObject[RJsonKey::size].toVariant().toULongLong();
-        flag.name = flagObject[RJsonKey::name].toString();
+        FlagDescription flag;
+        flag.offset = item->offset;
+        flag.size = item->size;
+        flag.name = QString::fromUtf8(item->name);
+        flags << flag;
+        return true;
+    };
 
-        ret << flag;
+    if (from == 0 && to == RVA_MAX) {
+        r_flag_foreach(core_->flags, collect, &context);
+    } else {
+        r_flag_foreach_range(core_->flags, from, to, collect, &context);
     }
     return ret;
 }
@@ -1807,7 +1961,8 @@ QList<SectionDescription> CutterCore::getAllSections()
     CORE_LOCK();
     QList<SectionDescription> ret;
 
-    QJsonDocument sectionsDoc = cmdj("iSj entropy");
+    // The entropy comes from the EntropyMap, which computes it for all sections in one pass
+    QJsonDocument sectionsDoc = cmdj("iSj");
     QJsonObject sectionsObj = sectionsDoc.object();
     QJsonArray sectionsArray = sectionsObj[RJsonKey::sections].toArray();
 
@@ -1825,7 +1980,6 @@ QList<SectionDescription> CutterCore::getAllSections()
         section.paddr = sectionObject[RJsonKey::paddr].toVariant().toULongLong();
         section.size = sectionObject[RJsonKey::size].toVariant().toULongLong();
         section.flags = sectionObject[RJsonKey::flags].toString();
-        section.entropy =  sectionObject[RJsonKey::entropy].toString();
 
         ret << section;
     }
@@ -2325,9 +2479,14 @@ bool CutterCore::isAddressMapped(RVA addr)
 QList<SearchDescription> CutterCore::getAllSearch(QString search_for, QString space)
 {
     CORE_LOCK();
+    return parseSearchJson(cmdj(space + QString(" ") + search_for), space);
+}
+
+QList<SearchDescription> CutterCore::parseSearchJson(const QJsonDocument &doc, const QString &space)
+{
     QList<SearchDescription> ret;
 
-    QJsonArray searchArray = cmdj(space + QString(" ") + search_for).array();
+    QJsonArray searchArray = doc.array();
 
     if (space == "/Rj") {
         for (const QJsonValue &value : searchArray) {
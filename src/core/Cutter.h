@@ -3,8 +3,10 @@
 
 #include "core/CutterCommon.h"
 #include "core/CutterDescriptions.h"
+#include "core/CompactStringList.h"
 
 #include <QMap>
+#include <QVector>
 #include <QDebug>
 #include <QObject>
 #include <QStringList>
@@ -12,7 +14,10 @@
 #include <QJsonDocument>
 #include <QErrorMessage>
 
+#include <functional>
+
 class AsyncTaskManager;
+class AnalysisDataStore;
 class CutterCore;
 #include "plugins/CutterPlugin.h"
 #include "common/BasicBlockHighlighter.h"
@@ -46,6 +51,7 @@ public:
     void initialize();
 
     AsyncTaskManager *getAsyncTaskManager() { return asyncTaskManager; }
+    AnalysisDataStore *getDataStore()       { return dataStore; }
 
     RVA getOffset() const                   { return core_->offset; }
 
@@ -188,6 +194,11 @@ public:
     QByteArray assemble(const QString &code);
     QString disassemble(const QByteArray &data);
     QString disassembleSingleInstruction(RVA addr);
+    /**
+     * @brief Disassemble the instruction at each of addresses natively, for many of them at once
+     * @return size and text of each instruction, 0 and an empty text if it can't be decoded
+     */
+    QList<QPair<int, QString>> disassembleInstructions(const QVector<RVA> &addresses);
     QList<DisassemblyLine> disassembleLines(RVA offset, int lines);
 
     static QByteArray hexStringToBytes(const QString &hex);
@@ -247,6 +258,10 @@ public:
     QJsonDocument getFileInfo();
     QJsonDocument getSignatureInfo();
     QJsonDocument getFileVersionInfo();
+    /**
+     * @brief Numbers of function, import, symbol, string, reloc and section flags and of all
+     * flags, in this order. Computed once per generation of the flags.
+     */
     QStringList getStats();
     void setGraphEmpty(bool empty);
     bool isGraphEmpty();
@@ -277,16 +292,30 @@ public:
     QList<RCorePluginDescription> getRCorePluginDescriptions();
     QList<RAsmPluginDescription> getRAsmPluginDescriptions();
     QList<FunctionDescription> getAllFunctions();
+    QList<CallGraphNodeDescription> getCallGraph();
     QList<ImportDescription> getAllImports();
     QList<ExportDescription> getAllExports();
     QList<SymbolDescription> getAllSymbols();
     QList<HeaderDescription> getAllHeaders();
     QList<ZignatureDescription> getAllZignatures();
     QList<CommentDescription> getAllComments(const QString &filterType);
+    /**
+     * @return addresses of all comments, of any type
+     */
+    QList<RVA> getCommentOffsets();
     QList<RelocDescription> getAllRelocs();
-    QList<StringDescription> getAllStrings();
+    CompactStringList getAllStrings();
     QList<FlagspaceDescription> getAllFlagspaces();
     QList<FlagDescription> getAllFlags(QString flagspace = QString());
+    /**
+     * @brief Flags in address order, without selecting the flagspace in the core.
+     * @param flagspace only the flags of this flagspace, all if empty
+     * @param from, to only the flags with from <= offset < to
+     * @param limit if > 0, stop after this many flags at the end of an address. The next page
+     * starts at the address after the offset of the last flag returned.
+     */
+    QList<FlagDescription> getFlags(const QString &flagspace = QString(), RVA from = 0,
+                                    RVA to = RVA_MAX, int limit = 0);
     QList<SectionDescription> getAllSections();
     QList<SegmentDescription> getAllSegments();
     QList<EntrypointDescription> getAllEntrypoint();
@@ -356,8 +385,19 @@ public:
     QList<XrefDescription> getXRefs(RVA addr, bool to, bool whole_function,
                                     const QString &filterType = QString::null);
 
-    QList<StringDescription> parseStringsJson(const QJsonDocument &doc);
+    CompactStringList parseStringsJson(const QJsonDocument &doc);
+    /**
+     * @brief Parse the output of izzj in batches of batchSize strings.
+     * @param handleBatch called with each batch and the number of strings parsed so far out of
+     * the total, parsing stops if it returns false
+     */
+    void parseStringsJson(const QJsonDocument &doc, int batchSize,
+                          const std::function<bool(CompactStringList &batch, int parsed, int total)> &handleBatch);
     QList<FunctionDescription> parseFunctionsJson(const QJsonDocument &doc);
+    /**
+     * @brief Parse the output of the search command space, e.g. "/xj" or "/Rj"
+     */
+    QList<SearchDescription> parseSearchJson(const QJsonDocument &doc, const QString &space);
 
     void handleREvent(int type, void *data);
 
@@ -384,7 +424,7 @@ signals:
     void varsChanged();
     void functionsChanged();
     void flagsChanged();
-    void commentsChanged();
+    void commentsChanged(RVA addr);
     void registersChanged();
     void instructionChanged(RVA offset);
     void breakpointsChanged();
@@ -427,6 +467,9 @@ private:
     QString notes;
     RCore *core_ = nullptr;
     AsyncTaskManager *asyncTaskManager;
+    AnalysisDataStore *dataStore;
+    QStringList stats;
+    quint64 statsGeneration = 0;
     RVA offsetPriorDebugging = RVA_INVALID;
     QErrorMessage msgBox;
 
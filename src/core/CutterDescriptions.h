@@ -28,6 +28,14 @@ struct FunctionDescription {
     {
         return addr >= offset && addr < offset + size;
     }
+
+    bool operator==(const FunctionDescription &other) const
+    {
+        return offset == other.offset && size == other.size && nargs == other.nargs
+               && nbbs == other.nbbs && nlocals == other.nlocals && cc == other.cc
+               && calltype == other.calltype && name == other.name && edges == other.edges
+               && cost == other.cost && calls == other.calls && stackframe == other.stackframe;
+    }
 };
 
 struct ImportDescription {
@@ -79,6 +87,12 @@ struct SearchDescription {
     int size;
     QString code;
     QString data;
+
+    bool operator==(const SearchDescription &other) const
+    {
+        return offset == other.offset && size == other.size && code == other.code
+               && data == other.data;
+    }
 };
 
 struct SymbolDescription {
@@ -91,6 +105,11 @@ struct SymbolDescription {
 struct CommentDescription {
     RVA offset;
     QString name;
+
+    bool operator==(const CommentDescription &other) const
+    {
+        return offset == other.offset && name == other.name;
+    }
 };
 
 struct RelocDescription {
@@ -117,6 +136,11 @@ struct FlagDescription {
     RVA offset;
     RVA size;
     QString name;
+
+    bool operator==(const FlagDescription &other) const
+    {
+        return offset == other.offset && size == other.size && name == other.name;
+    }
 };
 
 struct SectionDescription {
@@ -155,6 +179,13 @@ struct XrefDescription {
     QString type;
 };
 
+struct CallGraphNodeDescription {
+    RVA offset;
+    RVA size;
+    QString name;
+    QList<RVA> callees;
+};
+
 struct RBinPluginDescription {
     QString name;
     QString description;
@@ -314,6 +345,7 @@ Q_DECLARE_METATYPE(StringDescription)
 Q_DECLARE_METATYPE(FlagspaceDescription)
 Q_DECLARE_METATYPE(FlagDescription)
 Q_DECLARE_METATYPE(XrefDescription)
+Q_DECLARE_METATYPE(CallGraphNodeDescription)
 Q_DECLARE_METATYPE(EntrypointDescription)
 Q_DECLARE_METATYPE(RBinPluginDescription)
 Q_DECLARE_METATYPE(RIOPluginDescription)
@@ -0,0 +1,288 @@
+#include "core/EntropyMap.h"
+
+#include <QFile>
+#include <QThread>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+typedef std::array<quint64, 256> Histogram;
+
+const size_t baseBlockSize = size_t(1) << EntropyMap::baseBlockShift;
+// Levels computed within a chunk, a chunk is one block of the level above
+const int chunkLevels = 8;
+const size_t blocksPerChunk = size_t(1) << chunkLevels;
+const size_t chunkSize = baseBlockSize << chunkLevels;
+
+/**
+ * @brief Add the histogram of n bytes at p to histogram.
+ *
+ * Counting every byte into the same table makes each increment wait for the previous one when
+ * neighbouring bytes are equal, which is common in exactly the low entropy data of interest.
+ * Four tables let the increments of eight bytes loaded at once proceed independently.
+ */
+void addHistogram(const uchar *p, size_t n, Histogram &histogram)
+{
+    quint32 counts[4][256];
+    memset(counts, 0, sizeof(counts));
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        quint64 x;
+        memcpy(&x, p + i, sizeof(x));
+        counts[0][x & 0xff]++;
+        counts[1][(x >> 8) & 0xff]++;
+        counts[2][(x >> 16) & 0xff]++;
+        counts[3][(x >> 24) & 0xff]++;
+        counts[0][(x >> 32) & 0xff]++;
+        counts[1][(x >> 40) & 0xff]++;
+        counts[2][(x >> 48) & 0xff]++;
+        counts[3][x >> 56]++;
+    }
+    for (; i < n; i++) {
+        counts[0][p[i]]++;
+    }
+
+    for (int b = 0; b < 256; b++) {
+        histogram[static_cast<size_t>(b)] += counts[0][b] + counts[1][b] + counts[2][b] + counts[3][b];
+    }
+}
+
+void addHistogram(const Histogram &other, Histogram &histogram)
+{
+    for (size_t b = 0; b < 256; b++) {
+        histogram[b] += other[b];
+    }
+}
+
+double entropy(const Histogram &histogram)
+{
+    quint64 total = 0;
+    for (quint64 count : histogram) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+    // -sum(p * log2(p)) with p = count / total
+    double sum = 0.0;
+    for (quint64 count : histogram) {
+        if (count) {
+            sum += count * std::log2(static_cast<double>(count));
+        }
+    }
+    return std::max(0.0, std::log2(static_cast<double>(total)) - sum / total);
+}
+
+quint8 share(quint64 count, quint64 total)
+{
+    return static_cast<quint8>(total ? (count * 255 + total / 2) / total : 0);
+}
+
+EntropyMap::Sample makeSample(const Histogram &histogram)
+{
+    quint64 total = 0;
+    quint64 printable = 0;
+    quint64 highBit = 0;
+    for (size_t b = 0; b < 256; b++) {
+        total += histogram[b];
+        if ((b >= 0x20 && b < 0x7f) || b == '\t' || b == '\n' || b == '\r') {
+            printable += histogram[b];
+        } else if (b >= 0x80) {
+            highBit += histogram[b];
+        }
+    }
+
+    EntropyMap::Sample sample;
+    sample.entropy = static_cast<quint8>(std::lround(entropy(histogram) * 255.0 / 8.0));
+    sample.zero = share(histogram[0], total);
+    sample.printable = share(printable, total);
+    sample.highBit = share(highBit, total);
+    return sample;
+}
+
+size_t blockCount(quint64 size, int level)
+{
+    quint64 block = EntropyMap::blockSize(level);
+    return static_cast<size_t>(size / block + (size % block ? 1 : 0));
+}
+
+struct SectionRange {
+    quint64 begin;
+    quint64 end;
+};
+
+}
+
+QSharedPointer<const EntropyMap> EntropyMap::build(const QString &path,
+                                                   const QList<SectionDescription> &sections,
+                                                   const std::function<bool()> &interrupted)
+{
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return QSharedPointer<const EntropyMap>();
+    }
+    QSharedPointer<EntropyMap> map(new EntropyMap());
+    map->fileSize = static_cast<quint64>(file.size());
+    if (map->fileSize == 0) {
+        return map;
+    }
+    const uchar *data = file.map(0, file.size());
+    if (!data) {
+        return QSharedPointer<const EntropyMap>();
+    }
+    quint64 size = map->fileSize;
+
+    int levelCount = 1;
+    while (blockCount(size, levelCount - 1) > 1) {
+        levelCount++;
+    }
+    map->levels.resize(static_cast<size_t>(levelCount));
+    for (int level = 0; level < levelCount; level++) {
+        map->levels[static_cast<size_t>(level)].resize(blockCount(size, level));
+    }
+
+    std::vector<SectionRange> sectionRanges;
+    for (const SectionDescription &section : sections) {
+        quint64 begin = std::min<quint64>(section.paddr, size);
+        quint64 end = std::min<quint64>(section.paddr + section.size, size);
+        sectionRanges.push_back({ begin, std::max(begin, end) });
+    }
+    std::vector<Histogram> sectionHistograms(sectionRanges.size(), Histogram());
+
+    size_t chunks = static_cast<size_t>((size + chunkSize - 1) / chunkSize);
+    std::vector<Histogram> chunkHistograms(chunks, Histogram());
+    std::atomic<size_t> nextChunk(0);
+    std::atomic<bool> stop(false);
+    std::mutex sectionsMutex;
+
+    // Chunks write to disjoint parts of the levels, only the sections are shared between them
+    auto work = [&]() {
+        std::vector<Histogram> histograms(blocksPerChunk);
+        for (;;) {
+            size_t c = nextChunk++;
+            if (c >= chunks || stop) {
+                return;
+            }
+            if (interrupted && interrupted()) {
+                stop = true;
+                return;
+            }
+
+            quint64 chunkBegin = c * chunkSize;
+            quint64 chunkEnd = std::min<quint64>(chunkBegin + chunkSize, size);
+            size_t blocks = static_cast<size_t>((chunkEnd - chunkBegin + baseBlockSize - 1) / baseBlockSize);
+            for (size_t b = 0; b < blocks; b++) {
+                quint64 blockBegin = chunkBegin + b * baseBlockSize;
+                size_t length = static_cast<size_t>(std::min<quint64>(baseBlockSize, size - blockBegin));
+                histograms[b].fill(0);
+                addHistogram(data + blockBegin, length, histograms[b]);
+                map->levels[0][c * blocksPerChunk + b] = makeSample(histograms[b]);
+                addHistogram(histograms[b], chunkHistograms[c]);
+            }
+
+            // Sections are made of the histograms of the blocks they cover and of the bytes
+            // of the blocks they partially cover
+            for (size_t s = 0; s < sectionRanges.size(); s++) {
+                const SectionRange &range = sectionRanges[s];
+                quint64 begin = std::max(range.begin, chunkBegin);
+                quint64 end = std::min(range.end, chunkEnd);
+                if (begin >= end) {
+                    continue;
+                }
+                Histogram histogram = Histogram();
+                while (begin < end) {
+                    size_t b = static_cast<size_t>((begin - chunkBegin) / baseBlockSize);
+                    quint64 blockBegin = chunkBegin + b * baseBlockSize;
+                    quint64 blockEnd = std::min<quint64>(blockBegin + baseBlockSize, chunkEnd);
+                    quint64 partEnd = std::min(blockEnd, end);
+                    if (begin == blockBegin && partEnd == blockEnd) {
+                        addHistogram(histograms[b], histogram);
+                    } else {
+                        addHistogram(data + begin, static_cast<size_t>(partEnd - begin), histogram);
+                    }
+                    begin = partEnd;
+                }
+                std::lock_guard<std::mutex> lock(sectionsMutex);
+                addHistogram(histogram, sectionHistograms[s]);
+            }
+
+            // The levels up to the chunk size, merging pairs of blocks in place
+            for (int level = 1; level <= chunkLevels && level < levelCount; level++) {
+                size_t previous = blocks;
+                blocks = (blocks + 1) / 2;
+                for (size_t b = 0; b < blocks; b++) {
+                    if (2 * b + 1 < previous) {
+                        addHistogram(histograms[2 * b + 1], histograms[2 * b]);
+                    }
+                    histograms[b] = histograms[2 * b];
+                    map->levels[static_cast<size_t>(level)][(c * blocksPerChunk >> level) + b]
+                        = makeSample(histograms[b]);
+                }
+            }
+        }
+    };
+
+    size_t threadCount = std::min(static_cast<size_t>(std::max(1, QThread::idealThreadCount())),
+                                  chunks);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(work);
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    if (stop) {
+        return QSharedPointer<const EntropyMap>();
+    }
+
+    // The levels above the chunk size, from the histograms of the chunks
+    std::vector<Histogram> histograms = chunkHistograms;
+    for (int level = chunkLevels + 1; level < levelCount; level++) {
+        size_t blocks = (histograms.size() + 1) / 2;
+        for (size_t b = 0; b < blocks; b++) {
+            if (2 * b + 1 < histograms.size()) {
+                addHistogram(histograms[2 * b + 1], histograms[2 * b]);
+            }
+            histograms[b] = histograms[2 * b];
+            map->levels[static_cast<size_t>(level)][b] = makeSample(histograms[b]);
+        }
+        histograms.resize(blocks);
+    }
+
+    Histogram fileHistogram = Histogram();
+    for (const Histogram &histogram : chunkHistograms) {
+        addHistogram(histogram, fileHistogram);
+    }
+    map->fileEntropy = entropy(fileHistogram);
+    for (int s = 0; s < sections.size(); s++) {
+        const SectionDescription &section = sections.at(s);
+        map->sectionEntropies.insert(qMakePair(section.paddr, section.size),
+                                     entropy(sectionHistograms[static_cast<size_t>(s)]));
+    }
+    return map;
+}
+
+const EntropyMap::Sample *EntropyMap::sampleAt(quint64 offset, quint64 maxBlockSize) const
+{
+    if (offset >= fileSize || levels.empty()) {
+        return nullptr;
+    }
+    int level = 0;
+    while (level + 1 < levelCount() && blockSize(level + 1) <= maxBlockSize) {
+        level++;
+    }
+    return &levels[static_cast<size_t>(level)][static_cast<size_t>(offset >> (baseBlockShift + level))];
+}
+
+double EntropyMap::getSectionEntropy(RVA paddr, RVA size) const
+{
+    return sectionEntropies.value(qMakePair(paddr, size), -1.0);
+}
@@ -0,0 +1,79 @@
+#ifndef ENTROPYMAP_H
+#define ENTROPYMAP_H
+
+#include <QHash>
+#include <QPair>
+#include <QSharedPointer>
+
+#include <functional>
+#include <vector>
+
+#include "core/CutterCommon.h"
+#include "core/CutterDescriptions.h"
+
+/**
+ * @brief Entropy and byte classes of the whole file at several resolutions.
+ *
+ * Level 0 describes every 4 KiB block of the file, each following level blocks twice as large,
+ * up to a single block for the whole file. Every sample is computed from the exact byte
+ * histogram of its block, so e.g. compressed or encrypted regions can be located from an
+ * overview first and then at 4 KiB resolution. The exact entropy of the whole file and of each
+ * section is computed in the same pass.
+ *
+ * The map is immutable once built and can be shared between threads.
+ */
+class EntropyMap
+{
+public:
+    struct Sample {
+        // 0 to 255 for 0 to 8 bits per byte
+        quint8 entropy;
+        // Shares of the bytes, 0 to 255 for none to all of them
+        quint8 zero;
+        quint8 printable;
+        quint8 highBit;
+
+        double entropyBits() const              { return entropy * 8.0 / 255.0; }
+    };
+
+    static const int baseBlockShift = 12;
+
+    /**
+     * @brief Read the file at path and compute the map on all cores.
+     * @param interrupted polled from the worker threads, stops building if it returns true
+     * @return null if the file can't be read or building was interrupted
+     */
+    static QSharedPointer<const EntropyMap> build(const QString &path,
+                                                  const QList<SectionDescription> &sections,
+                                                  const std::function<bool()> &interrupted = nullptr);
+
+    quint64 getFileSize() const                 { return fileSize; }
+    int levelCount() const                      { return static_cast<int>(levels.size()); }
+    static quint64 blockSize(int level)         { return quint64(1) << (baseBlockShift + level); }
+    const std::vector<Sample> &level(int level) const { return levels[static_cast<size_t>(level)]; }
+
+    /**
+     * @return sample of the largest blocks not larger than maxBlockSize, at least those of
+     * level 0, that contains offset, or null if offset is outside of the file
+     */
+    const Sample *sampleAt(quint64 offset, quint64 maxBlockSize) const;
+
+    /**
+     * @return entropy of the whole file in bits per byte
+     */
+    double getFileEntropy() const               { return fileEntropy; }
+
+    /**
+     * @return entropy in bits per byte of the section at paddr with size, or a negative number
+     * if the map was built without it
+     */
+    double getSectionEntropy(RVA paddr, RVA size) const;
+
+private:
+    quint64 fileSize = 0;
+    std::vector<std::vector<Sample>> levels;
+    double fileEntropy = 0.0;
+    QHash<QPair<RVA, RVA>, double> sectionEntropies;
+};
+
+#endif // ENTROPYMAP_H
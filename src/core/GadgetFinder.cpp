@@ -0,0 +1,399 @@
+#include "core/GadgetFinder.h"
+#include "core/Cutter.h"
+
+#include <QRegExp>
+#include <QThread>
+#include <QtEndian>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// A chunk is searched for terminators, the gadgets before them may start in the chunk before
+const size_t chunkSize = 1 << 18;
+
+// The cache is cleared when it grows beyond this many chains, the repeated sequences are found
+// again quickly
+const int maxCachedChains = 1 << 17;
+
+/**
+ * @return whether an instruction of type can't be part of a gadget, only end it
+ */
+bool breaksGadget(ut64 type)
+{
+    switch (type & R_ANAL_OP_TYPE_MASK) {
+    case R_ANAL_OP_TYPE_JMP:
+    case R_ANAL_OP_TYPE_UJMP:
+    case R_ANAL_OP_TYPE_IJMP:
+    case R_ANAL_OP_TYPE_RJMP:
+    case R_ANAL_OP_TYPE_IRJMP:
+    case R_ANAL_OP_TYPE_MJMP:
+    case R_ANAL_OP_TYPE_CJMP:
+    case R_ANAL_OP_TYPE_UCJMP:
+    case R_ANAL_OP_TYPE_SWITCH:
+    case R_ANAL_OP_TYPE_UCALL:
+    case R_ANAL_OP_TYPE_ICALL:
+    case R_ANAL_OP_TYPE_RCALL:
+    case R_ANAL_OP_TYPE_IRCALL:
+    case R_ANAL_OP_TYPE_UCCALL:
+    case R_ANAL_OP_TYPE_CALL:
+    case R_ANAL_OP_TYPE_CCALL:
+    case R_ANAL_OP_TYPE_CRET:
+    case R_ANAL_OP_TYPE_RET:
+    case R_ANAL_OP_TYPE_ILL:
+    case R_ANAL_OP_TYPE_TRAP:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Decode the instruction at the start of bytes with the disassembler of the core
+ * @param pcRelative set if the instruction refers to an address, which may be relative to vaddr
+ * @return length of the instruction, 0 if it is invalid or, unless terminator, breaks gadgets
+ */
+int decodeInstruction(RVA vaddr, const uchar *bytes, size_t available, bool terminator,
+                      QString &text, bool &pcRelative)
+{
+    int length = static_cast<int>(std::min<size_t>(available, 32));
+    // The disassemblers keep global state, so instructions are decoded one at a time
+    RCoreLocked core = Core()->core();
+
+    RAnalOp op = {};
+    int opLength = r_anal_op(core->anal, &op, vaddr, bytes, length, R_ANAL_OP_MASK_BASIC);
+    ut64 type = op.type;
+    pcRelative = op.ptr != UT64_MAX && op.ptr != 0;
+    r_anal_op_fini(&op);
+    if (opLength <= 0 || (!terminator && breaksGadget(type))) {
+        return 0;
+    }
+
+    RAsmOp asmOp = {};
+    r_asm_set_pc(core->assembler, vaddr);
+    int asmLength = r_asm_disassemble(core->assembler, &asmOp, bytes, length);
+    text = QString::fromUtf8(r_asm_op_get_asm(&asmOp));
+    r_asm_op_fini(&asmOp);
+    if (asmLength != opLength || text.isEmpty() || text == "invalid") {
+        return 0;
+    }
+    return opLength;
+}
+
+}
+
+GadgetFinder::GadgetFinder(const QString &filePath, const QList<SectionDescription> &sections,
+                           const QString &archName, int bits, bool bigEndian, int maxInstructions)
+    : file(filePath),
+      sections(sections),
+      bigEndian(bigEndian),
+      maxInstructions(std::max(1, maxInstructions))
+{
+    if (archName == "x86") {
+        arch = Arch::X86;
+    } else if (archName == "arm" && bits == 64) {
+        arch = Arch::Arm64;
+    } else if (archName == "arm" && bits == 32) {
+        arch = Arch::Arm;
+    }
+}
+
+QSharedPointer<GadgetFinder> GadgetFinder::forOpenFile()
+{
+    return QSharedPointer<GadgetFinder>(new GadgetFinder(Core()->getConfig("file.path"),
+                                                         Core()->getAllSections(),
+                                                         Core()->getConfig("asm.arch"),
+                                                         Core()->getConfigi("asm.bits"),
+                                                         Core()->getConfigb("cfg.bigendian"),
+                                                         Core()->getConfigi("rop.len")));
+}
+
+void GadgetFinder::setFilter(const QString &text)
+{
+    filter.clear();
+    if (text.trimmed().isEmpty()) {
+        return;
+    }
+    for (const QString &term : text.split(QRegExp("[;,]"))) {
+        filter << term.trimmed();
+    }
+}
+
+bool GadgetFinder::open()
+{
+    if (arch == Arch::Unsupported || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    size = static_cast<size_t>(file.size());
+    if (size > 0) {
+        data = file.map(0, file.size());
+        if (!data) {
+            return false;
+        }
+    }
+    buildChunks();
+    return true;
+}
+
+void GadgetFinder::buildChunks()
+{
+    auto vaddrLess = [](const SectionDescription &a, const SectionDescription &b) {
+        return a.vaddr < b.vaddr;
+    };
+    QList<SectionDescription> sorted = sections;
+    std::sort(sorted.begin(), sorted.end(), vaddrLess);
+
+    RVA covered = 0;
+    for (const SectionDescription &section : sorted) {
+        RVA length = std::min(section.size, section.vsize);
+        if (!section.flags.contains('x') || length == 0 || section.paddr >= size) {
+            continue;
+        }
+        RVA skip = covered > section.vaddr ? covered - section.vaddr : 0;
+        size_t begin = static_cast<size_t>(section.paddr + skip);
+        size_t end = static_cast<size_t>(std::min<RVA>(section.paddr + length, size));
+        if (skip >= length || begin >= end) {
+            continue;
+        }
+        covered = section.vaddr + length;
+
+        int index = static_cast<int>(regions.size());
+        regions.push_back({ begin, end, section.vaddr + skip });
+        for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += chunkSize) {
+            chunks.push_back({ index, chunkBegin, std::min(chunkBegin + chunkSize, end) });
+        }
+    }
+}
+
+size_t GadgetFinder::alignment() const
+{
+    return arch == Arch::X86 ? 1 : 4;
+}
+
+size_t GadgetFinder::maxGadgetBytes() const
+{
+    // x86 instructions in gadgets are rarely longer than 8 bytes, looking further back only
+    // finds gadgets that need a longer instruction to get there
+    return static_cast<size_t>(maxInstructions) * (arch == Arch::X86 ? 8 : 4);
+}
+
+int GadgetFinder::terminatorAt(const Region &region, size_t offset) const
+{
+    const uchar *p = data + offset;
+    size_t available = region.end - offset;
+    switch (arch) {
+    case Arch::X86:
+        // ret, retf
+        if (p[0] == 0xc3 || p[0] == 0xcb) {
+            return 1;
+        }
+        // ret imm16, retf imm16
+        if ((p[0] == 0xc2 || p[0] == 0xca) && available >= 3) {
+            return 3;
+        }
+        // call reg, jmp reg, also with a REX.B prefix for r8 to r15
+        if (p[0] == 0x41 && available >= 3 && p[1] == 0xff
+                && ((p[2] >= 0xd0 && p[2] <= 0xd7) || (p[2] >= 0xe0 && p[2] <= 0xe7))) {
+            return 3;
+        }
+        if (p[0] == 0xff && available >= 2
+                && ((p[1] >= 0xd0 && p[1] <= 0xd7) || (p[1] >= 0xe0 && p[1] <= 0xe7))) {
+            return 2;
+        }
+        return 0;
+    case Arch::Arm:
+    case Arch::Arm64: {
+        if (available < 4 || (region.vaddr + (offset - region.begin)) % 4) {
+            return 0;
+        }
+        quint32 word = bigEndian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p);
+        if (arch == Arch::Arm64) {
+            // ret, br and blr with any register
+            quint32 opcode = word & 0xfffffc1f;
+            return opcode == 0xd65f0000 || opcode == 0xd61f0000 || opcode == 0xd63f0000 ? 4 : 0;
+        }
+        // bx and blx with any register, ldm sp! including pc, all with any condition
+        quint32 opcode = word & 0x0ffffff0;
+        if (opcode == 0x012fff10 || opcode == 0x012fff30) {
+            return 4;
+        }
+        return (word & 0x0fff8000) == 0x08bd8000 ? 4 : 0;
+    }
+    case Arch::Unsupported:
+        break;
+    }
+    return 0;
+}
+
+bool GadgetFinder::scan(const std::function<bool(QList<SearchDescription> &)> &handleGadgets,
+                        const std::function<bool(int)> &chunkDone)
+{
+    std::vector<QList<SearchDescription>> results(chunks.size());
+    std::vector<char> finished(chunks.size(), false);
+    std::mutex mutex;
+    std::condition_variable chunkFinished;
+    std::atomic<size_t> nextChunk(0);
+    stop = false;
+
+    auto work = [&]() {
+        for (;;) {
+            size_t i = nextChunk++;
+            if (i >= chunks.size() || stop) {
+                return;
+            }
+            QList<SearchDescription> gadgets = scanChunk(chunks[i]);
+            std::lock_guard<std::mutex> lock(mutex);
+            results[i] = std::move(gadgets);
+            finished[i] = true;
+            chunkFinished.notify_all();
+        }
+    };
+    size_t threadCount = std::min(static_cast<size_t>(std::max(1, QThread::idealThreadCount())),
+                                  chunks.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(work);
+    }
+
+    // The chunks are handed over in order, while the workers continue with the next ones
+    bool completed = true;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        QList<SearchDescription> gadgets;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            chunkFinished.wait(lock, [&]() {
+                return finished[i] != 0;
+            });
+            gadgets.swap(results[i]);
+        }
+        if (!gadgets.isEmpty() && !handleGadgets(gadgets)) {
+            completed = false;
+            break;
+        }
+        if (chunkDone && !chunkDone(static_cast<int>(i + 1))) {
+            completed = false;
+            break;
+        }
+    }
+
+    stop = true;
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    return completed;
+}
+
+QList<SearchDescription> GadgetFinder::scanChunk(const Chunk &chunk)
+{
+    const Region &region = regions[static_cast<size_t>(chunk.region)];
+    size_t step = alignment();
+    size_t maxBytes = maxGadgetBytes();
+
+    QList<SearchDescription> gadgets;
+    // Chains by their distance to the terminator, the terminator alone at 0
+    std::vector<Chain> following;
+    for (size_t t = chunk.begin; t < chunk.end; t++) {
+        if (stop) {
+            break;
+        }
+        int terminatorLength = terminatorAt(region, t);
+        if (!terminatorLength) {
+            continue;
+        }
+        size_t end = t + static_cast<size_t>(terminatorLength);
+        size_t first = t - std::min(maxBytes, t - region.begin);
+
+        following.clear();
+        following.push_back(decode(region.vaddr + (t - region.begin), t, end, t, following));
+        if (!following.front().valid) {
+            continue;
+        }
+        for (size_t distance = step; t - first >= distance; distance += step) {
+            size_t offset = t - distance;
+            following.resize(distance + 1, Chain { false, 0, QStringList(), false });
+            RVA vaddr = region.vaddr + (offset - region.begin);
+            following[distance] = decode(vaddr, offset, end, t, following);
+
+            const Chain &chain = following[distance];
+            if (chain.valid && matchesFilter(chain.code)) {
+                SearchDescription gadget;
+                gadget.offset = vaddr;
+                gadget.size = static_cast<RVA>(end - offset);
+                gadget.code = chain.code.join(";  ") + ";  ";
+                gadgets << gadget;
+            }
+        }
+    }
+
+    std::stable_sort(gadgets.begin(), gadgets.end(), [](const SearchDescription &a,
+                                                        const SearchDescription &b) {
+        return a.offset < b.offset;
+    });
+    return gadgets;
+}
+
+GadgetFinder::Chain GadgetFinder::decode(RVA vaddr, size_t offset, size_t end, size_t terminator,
+                                         const std::vector<Chain> &following)
+{
+    // The same bytes decode to the same chain wherever they are, unless it refers to the pc.
+    // The length of the terminator is part of the key, since e.g. 41 ff e0 is a terminator on
+    // its own as well as the terminator ff e0 after 41.
+    QByteArray key(reinterpret_cast<const char *>(data + offset), static_cast<int>(end - offset));
+    key += static_cast<char>(end - terminator);
+    {
+        QMutexLocker locker(&chainsMutex);
+        auto it = chains.constFind(key);
+        if (it != chains.constEnd()) {
+            return it.value();
+        }
+    }
+
+    Chain chain = { false, 0, QStringList(), false };
+    QString text;
+    bool pcRelative = false;
+    size_t length = static_cast<size_t>(decodeInstruction(vaddr, data + offset, end - offset,
+                                                          offset == terminator, text, pcRelative));
+    if (length == 0) {
+        // Not a chain
+    } else if (offset == terminator) {
+        if (offset + length == end) {
+            chain = { true, 1, QStringList(text), pcRelative };
+        }
+    } else if (offset + length <= terminator) {
+        const Chain &rest = following[terminator - (offset + length)];
+        if (rest.valid && rest.instructions < maxInstructions) {
+            chain = { true, rest.instructions + 1, QStringList(text) + rest.code,
+                      pcRelative || rest.pcRelative };
+        }
+    }
+    if (chain.pcRelative) {
+        return chain;
+    }
+
+    QMutexLocker locker(&chainsMutex);
+    if (chains.size() >= maxCachedChains) {
+        chains.clear();
+    }
+    chains.insert(key, chain);
+    return chain;
+}
+
+bool GadgetFinder::matchesFilter(const QStringList &code) const
+{
+    if (filter.isEmpty()) {
+        return true;
+    }
+    if (code.size() < filter.size()) {
+        return false;
+    }
+    for (int i = 0; i < filter.size(); i++) {
+        if (!filter.at(i).isEmpty() && !code.at(i).contains(filter.at(i), Qt::CaseInsensitive)) {
+            return false;
+        }
+    }
+    return true;
+}
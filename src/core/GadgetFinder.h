@@ -0,0 +1,121 @@
+#ifndef GADGETFINDER_H
+#define GADGETFINDER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QStringList>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "core/CutterCommon.h"
+#include "core/CutterDescriptions.h"
+
+/**
+ * @brief Native replacement for "/Rj", finds the ROP gadgets in the executable sections of the
+ * opened file.
+ *
+ * The executable sections are split into chunks that are searched by one thread per core for
+ * the instructions that end gadgets, like ret or jmp to a register, by their encodings. From
+ * each of them the bytes before are decoded backwards into chains of at most rop.len
+ * instructions. Decoding goes through the disassembler of the core, which can only decode one
+ * instruction at a time, so every decoded byte sequence is cached and the many identical
+ * sequences, e.g. of function epilogues, are decoded only once. Sequences with operands
+ * relative to the pc, like adr or ldr from a literal pool, read differently at every address
+ * and aren't cached.
+ *
+ * Only x86, ARM and ARM64 are supported, open() fails for other architectures.
+ */
+class GadgetFinder
+{
+public:
+    GadgetFinder(const QString &filePath, const QList<SectionDescription> &sections,
+                 const QString &arch, int bits, bool bigEndian, int maxInstructions);
+
+    /**
+     * @brief Finder for the file opened in the core with its architecture and rop.len
+     */
+    static QSharedPointer<GadgetFinder> forOpenFile();
+
+    /**
+     * @brief Only report gadgets whose instructions contain the terms of filter, which are
+     * separated by ; or , and matched against the instructions in order. Empty terms match any
+     * instruction.
+     */
+    void setFilter(const QString &filter);
+
+    /**
+     * @brief Map the file, scan() can't be used if this fails
+     */
+    bool open();
+
+    int chunkCount() const                      { return static_cast<int>(chunks.size()); }
+
+    /**
+     * @brief Search the gadgets.
+     * @param handleGadgets receives the gadgets of every chunk in address order, returns false
+     * to stop searching
+     * @param chunkDone called after each chunk with the number of chunks done so far, returns
+     * false to stop searching
+     * @return false if stopped
+     */
+    bool scan(const std::function<bool(QList<SearchDescription> &gadgets)> &handleGadgets,
+              const std::function<bool(int done)> &chunkDone = nullptr);
+
+private:
+    enum class Arch { Unsupported, X86, Arm, Arm64 };
+
+    struct Region {
+        size_t begin;
+        size_t end;
+        RVA vaddr;
+    };
+
+    struct Chunk {
+        int region;
+        size_t begin;
+        size_t end;
+    };
+
+    struct Chain {
+        bool valid;
+        int instructions;
+        QStringList code;
+        // Whether the code depends on the address of the chain
+        bool pcRelative;
+    };
+
+    QFile file;
+    QList<SectionDescription> sections;
+    Arch arch = Arch::Unsupported;
+    bool bigEndian;
+    int maxInstructions;
+    QStringList filter;
+
+    const uchar *data = nullptr;
+    size_t size = 0;
+    std::vector<Region> regions;
+    std::vector<Chunk> chunks;
+    // Set when scan() stops before all chunks are done, for the chunks being searched
+    std::atomic<bool> stop { false };
+
+    // Chains by the bytes they are made of, shared by all threads
+    QMutex chainsMutex;
+    QHash<QByteArray, Chain> chains;
+
+    void buildChunks();
+    int terminatorAt(const Region &region, size_t offset) const;
+    size_t alignment() const;
+    size_t maxGadgetBytes() const;
+    QList<SearchDescription> scanChunk(const Chunk &chunk);
+    Chain decode(RVA vaddr, size_t offset, size_t end, size_t terminator,
+                 const std::vector<Chain> &following);
+    bool matchesFilter(const QStringList &code) const;
+};
+
+#endif // GADGETFINDER_H
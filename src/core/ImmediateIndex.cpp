@@ -0,0 +1,228 @@
+#include "core/ImmediateIndex.h"
+#include "core/Cutter.h"
+#include "common/CompactStorage.h"
+
+#include <QSet>
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+// Basic blocks larger than this are only indexed up to it
+const RVA maxBlockSize = 1 << 16;
+
+struct FunctionBlocks {
+    RVA offset;
+    quint64 fingerprint;
+    std::vector<std::pair<RVA, RVA>> blocks;
+};
+
+quint64 fingerprintOf(const std::vector<std::pair<RVA, RVA>> &blocks)
+{
+    // FNV-1a over the addresses and sizes
+    quint64 hash = 0xcbf29ce484222325ULL;
+    for (const std::pair<RVA, RVA> &block : blocks) {
+        for (RVA value : { block.first, block.second }) {
+            for (int i = 0; i < 8; i++) {
+                hash ^= (value >> (8 * i)) & 0xff;
+                hash *= 0x100000001b3ULL;
+            }
+        }
+    }
+    return hash;
+}
+
+std::vector<FunctionBlocks> functionBlocks()
+{
+    std::vector<FunctionBlocks> result;
+    RCoreLocked core = Core()->core();
+    RListIter *it;
+    RListIter *bbIt;
+    RAnalFunction *fcn;
+    RAnalBlock *bb;
+    CutterRListForeach(core->anal->fcns, it, RAnalFunction, fcn) {
+        FunctionBlocks function;
+        function.offset = fcn->addr;
+        CutterRListForeach(fcn->bbs, bbIt, RAnalBlock, bb) {
+            function.blocks.push_back({ bb->addr, static_cast<RVA>(bb->size) });
+        }
+        std::sort(function.blocks.begin(), function.blocks.end());
+        function.fingerprint = fingerprintOf(function.blocks);
+        result.push_back(std::move(function));
+    }
+    return result;
+}
+
+/**
+ * @return whether one of the offsets lies in one of the blocks
+ */
+bool containsAny(const std::vector<std::pair<RVA, RVA>> &blocks, const std::vector<RVA> &sortedOffsets)
+{
+    for (const std::pair<RVA, RVA> &block : blocks) {
+        auto it = std::lower_bound(sortedOffsets.begin(), sortedOffsets.end(), block.first);
+        if (it != sortedOffsets.end() && *it < block.first + block.second) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void addValue(const RAnalValue *value, RVA address, std::vector<std::pair<ut64, RVA>> &immediates)
+{
+    if (!value) {
+        return;
+    }
+    if (value->memref && value->delta) {
+        immediates.push_back({ static_cast<ut64>(value->delta), address });
+    } else if (!value->reg && !value->memref && value->imm) {
+        immediates.push_back({ static_cast<ut64>(value->imm), address });
+    }
+}
+
+/**
+ * @brief Decode the basic blocks and collect the immediates and displacements of their
+ * instructions
+ */
+std::vector<std::pair<ut64, RVA>> decodeImmediates(const std::vector<std::pair<RVA, RVA>> &blocks)
+{
+    std::vector<std::pair<ut64, RVA>> immediates;
+    std::vector<ut8> buffer;
+    // One function at a time, so other users of the core don't wait for the whole index
+    RCoreLocked core = Core()->core();
+    for (const std::pair<RVA, RVA> &block : blocks) {
+        RVA size = std::min(block.second, maxBlockSize);
+        buffer.resize(static_cast<size_t>(size));
+        if (size == 0 || !r_io_read_at(core->io, block.first, buffer.data(), static_cast<int>(size))) {
+            continue;
+        }
+        RVA offset = 0;
+        while (offset < size) {
+            RVA address = block.first + offset;
+            RAnalOp op = {};
+            int length = r_anal_op(core->anal, &op, address, buffer.data() + offset,
+                                   static_cast<int>(size - offset), R_ANAL_OP_MASK_VAL);
+            if (length > 0) {
+                if (op.val != UT64_MAX && op.val) {
+                    immediates.push_back({ op.val, address });
+                }
+                for (const RAnalValue *value : op.src) {
+                    addValue(value, address, immediates);
+                }
+                addValue(op.dst, address, immediates);
+            }
+            r_anal_op_fini(&op);
+            offset += static_cast<RVA>(std::max(length, 1));
+        }
+    }
+
+    // The same value is usually found both as the value of the op and of its operand
+    std::sort(immediates.begin(), immediates.end());
+    immediates.erase(std::unique(immediates.begin(), immediates.end()), immediates.end());
+    return immediates;
+}
+
+}
+
+QSharedPointer<const ImmediateIndex> ImmediateIndex::build(const QSharedPointer<const ImmediateIndex> &previous,
+                                                           const QSet<RVA> &changed,
+                                                           const std::function<bool()> &interrupted)
+{
+    QSharedPointer<ImmediateIndex> index(new ImmediateIndex());
+    if (previous) {
+        index->functions = previous->functions;
+        index->postings = previous->postings;
+    }
+
+    // What changes in the postings of each value, collected over all functions first so that
+    // every postings list is decoded and encoded only once
+    QHash<ut64, std::vector<RVA>> removed;
+    QHash<ut64, std::vector<RVA>> added;
+
+    std::vector<RVA> changedOffsets(changed.begin(), changed.end());
+    std::sort(changedOffsets.begin(), changedOffsets.end());
+
+    std::vector<FunctionBlocks> current = functionBlocks();
+    QSet<RVA> present;
+    for (const FunctionBlocks &function : current) {
+        present.insert(function.offset);
+    }
+    for (auto it = index->functions.begin(); it != index->functions.end();) {
+        if (present.contains(it.key())) {
+            ++it;
+            continue;
+        }
+        for (const std::pair<ut64, RVA> &immediate : it.value().immediates) {
+            removed[immediate.first].push_back(immediate.second);
+        }
+        it = index->functions.erase(it);
+    }
+
+    for (const FunctionBlocks &function : current) {
+        auto it = index->functions.find(function.offset);
+        if (it != index->functions.end() && it.value().fingerprint == function.fingerprint
+                && !containsAny(function.blocks, changedOffsets)) {
+            continue;
+        }
+        if (interrupted && interrupted()) {
+            return QSharedPointer<const ImmediateIndex>();
+        }
+        if (it != index->functions.end()) {
+            for (const std::pair<ut64, RVA> &immediate : it.value().immediates) {
+                removed[immediate.first].push_back(immediate.second);
+            }
+        }
+        Function &entry = index->functions[function.offset];
+        entry.fingerprint = function.fingerprint;
+        entry.immediates = decodeImmediates(function.blocks);
+        for (const std::pair<ut64, RVA> &immediate : entry.immediates) {
+            added[immediate.first].push_back(immediate.second);
+        }
+        index->decodedFunctions++;
+    }
+
+    QSet<ut64> values;
+    for (auto it = removed.constBegin(); it != removed.constEnd(); ++it) {
+        values.insert(it.key());
+    }
+    for (auto it = added.constBegin(); it != added.constEnd(); ++it) {
+        values.insert(it.key());
+    }
+
+    // Functions may share blocks, so an address is in a postings list once per function that
+    // has it and only one of them is removed at a time
+    std::vector<RVA> addresses;
+    for (ut64 value : values) {
+        addresses.clear();
+        DeltaCoding::decode(index->postings.value(value), addresses);
+        auto removedIt = removed.find(value);
+        if (removedIt != removed.end()) {
+            std::vector<RVA> &toRemove = removedIt.value();
+            std::sort(toRemove.begin(), toRemove.end());
+            std::vector<RVA> kept;
+            kept.reserve(addresses.size());
+            std::set_difference(addresses.begin(), addresses.end(), toRemove.begin(), toRemove.end(),
+                                std::back_inserter(kept));
+            addresses.swap(kept);
+        }
+        auto addedIt = added.constFind(value);
+        if (addedIt != added.constEnd()) {
+            addresses.insert(addresses.end(), addedIt.value().begin(), addedIt.value().end());
+            std::sort(addresses.begin(), addresses.end());
+        }
+        if (addresses.empty()) {
+            index->postings.remove(value);
+        } else {
+            index->postings.insert(value, DeltaCoding::encode(addresses));
+        }
+    }
+    return index;
+}
+
+QVector<RVA> ImmediateIndex::find(ut64 value) const
+{
+    std::vector<RVA> addresses;
+    DeltaCoding::decode(postings.value(value), addresses);
+    addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+    return QVector<RVA>::fromStdVector(addresses);
+}
@@ -0,0 +1,70 @@
+#ifndef IMMEDIATEINDEX_H
+#define IMMEDIATEINDEX_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "core/CutterCommon.h"
+
+/**
+ * @brief Inverted index from the immediates and displacements of the instructions in the
+ * analysed functions to the addresses of these instructions.
+ *
+ * Every value has a postings list of its instruction addresses, stored sorted with DeltaCoding,
+ * so most of them take one or two bytes. Negative displacements are
+ * stored as their 64 bit two's complement, like r2 shows them as unsigned numbers.
+ *
+ * The index is immutable once built and can be shared between threads. Building it again from
+ * the previous one only decodes the functions that were added, whose basic blocks changed or
+ * that contain one of the changed addresses passed to build(), and only touches the postings of
+ * their values.
+ */
+class ImmediateIndex
+{
+public:
+    /**
+     * @brief Index the functions of the core, reusing previous for the unchanged ones.
+     * @param changed addresses whose bytes changed, e.g. by writing to them, their functions are
+     * decoded again
+     * @param interrupted polled between functions, stops building if it returns true
+     * @return null if interrupted
+     */
+    static QSharedPointer<const ImmediateIndex> build(const QSharedPointer<const ImmediateIndex> &previous,
+                                                      const QSet<RVA> &changed = QSet<RVA>(),
+                                                      const std::function<bool()> &interrupted = nullptr);
+
+    /**
+     * @return sorted addresses of the instructions that use value
+     */
+    QVector<RVA> find(ut64 value) const;
+
+    int functionCount() const                   { return functions.size(); }
+    int valueCount() const                      { return postings.size(); }
+    /**
+     * @return number of functions decoded by the build that made this index
+     */
+    int decodedFunctionCount() const            { return decodedFunctions; }
+
+private:
+    typedef std::vector<std::pair<ut64, RVA>> Immediates;
+
+    struct Function {
+        // Changes with the basic blocks of the function
+        quint64 fingerprint;
+        // Sorted by value, then address
+        Immediates immediates;
+    };
+
+    QHash<RVA, Function> functions;
+    QHash<ut64, QByteArray> postings;
+    int decodedFunctions = 0;
+};
+
+#endif // IMMEDIATEINDEX_H
@@ -29,6 +29,7 @@
 #include "widgets/DisassemblerGraphView.h"
 #include "widgets/GraphView.h"
 #include "widgets/GraphWidget.h"
+#include "widgets/CallGraphWidget.h"
 #include "widgets/OverviewWidget.h"
 #include "widgets/OverviewView.h"
 #include "widgets/FunctionsWidget.h"
@@ -228,7 +229,7 @@ void MainWindow::initToolBar()
     addToolBarBreak(Qt::TopToolBarArea);
     addToolBar(visualNavbar);
     QObject::connect(configuration, &Configuration::colorsUpdated, [this]() {
-        this->visualNavbar->updateGraphicsScene();
+        this->visualNavbar->updateImage();
     });
 }
 
@@ -251,6 +252,7 @@ void MainWindow::initDocks()
             }
         }
     });
+    callGraphDock = new CallGraphWidget(this, ui->actionCallGraph);
     sectionsDock = new SectionsWidget(this, ui->actionSections);
     segmentsDock = new SegmentsWidget(this, ui->actionSegments);
     entrypointDock = new EntrypointWidget(this, ui->actionEntrypoints);
@@ -310,7 +312,6 @@ void MainWindow::toggleOverview(bool visibility, GraphWidget *targetGraph)
         overviewDock->hide();
     });
     connect(overviewDock->getGraphView(), SIGNAL(mouseMoved()), this, SLOT(adjustGraph()));
-    connect(overviewDock->getGraphView(), SIGNAL(refreshBlock()), this, SLOT(updateOverviewAddr()));
     connect(overviewDock, &QDockWidget::dockLocationChanged, this, &MainWindow::forceUpdateOverview);
     connect(overviewDock, &OverviewWidget::graphClose, [this]() {
         ui->actionOverview->setChecked(false);
@@ -330,7 +331,6 @@ void MainWindow::disconnectOverview()
     }
     if (overviewDock) {
         disconnect(overviewDock->getGraphView(), SIGNAL(mouseMoved()), this, SLOT(adjustGraph()));
-        disconnect(overviewDock->getGraphView(), SIGNAL(refreshBlock()), this, SLOT(updateOverviewAddr()));
         disconnect(overviewDock, &QDockWidget::dockLocationChanged, this, &MainWindow::forceUpdateOverview);
         disconnect(overviewDock, SIGNAL(resized()), this, SLOT(forceUpdateOverview()));
     }
@@ -338,9 +338,7 @@ void MainWindow::disconnectOverview()
 
 void MainWindow::setOverviewData()
 {
-    auto &mainGraphView = *targetGraphDock->getGraphView();
-    overviewDock->getGraphView()->setData(mainGraphView.getWidth(), mainGraphView.getHeight(),
-                                          mainGraphView.getBlocks(), mainGraphView.getEdgeConfigurations());
+    overviewDock->getGraphView()->setData(targetGraphDock->getGraphView()->getSnapshot());
 }
 
 bool MainWindow::isOverviewActive()
@@ -356,33 +354,19 @@ bool MainWindow::isOverviewActive()
     return true;
 }
 
-void MainWindow::updateOverviewAddr()
-{
-    overviewDock->getGraphView()->currentFcnAddr = targetGraphDock->getGraphView()->currentFcnAddr;
-}
-
 void MainWindow::forceUpdateOverview()
 {
     if (!isOverviewActive()) {
         return;
     }
-    overviewDock->getGraphView()->useCache = false;
     setOverviewData();
     drawOverview();
 }
 
 void MainWindow::updateOverview()
 {
-    if (!isOverviewActive()) {
-        return;
-    }
-    if (overviewDock->getGraphView()->currentFcnAddr != targetGraphDock->getGraphView()->currentFcnAddr) {
-        overviewDock->getGraphView()->useCache = false;
-        setOverviewData();
-    } else {
-        overviewDock->getGraphView()->useCache = true;
-    }
-    drawOverview();
+    // Cheap if the graph didn't change, the overview keeps its snapshot and cached image
+    forceUpdateOverview();
 }
 
 void MainWindow::drawOverview()
@@ -610,11 +594,6 @@ bool MainWindow::saveProjectAs(bool quit)
     return SaveProjectDialog::Rejected != dialog.exec();
 }
 
-void MainWindow::refreshOmniBar(const QStringList &flags)
-{
-    omnibar->refresh(flags);
-}
-
 void MainWindow::setFilename(const QString &fn)
 {
     // Add file name to window title
@@ -800,6 +779,7 @@ void MainWindow::restoreDocks()
     tabifyDockWidget(segmentsDock, commentsDock);
     tabifyDockWidget(dashboardDock, disassemblyDock);
     tabifyDockWidget(dashboardDock, graphDock);
+    tabifyDockWidget(dashboardDock, callGraphDock);
     tabifyDockWidget(dashboardDock, hexdumpDock);
     tabifyDockWidget(dashboardDock, pseudocodeDock);
     tabifyDockWidget(dashboardDock, entrypointDock);
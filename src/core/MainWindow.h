@@ -46,6 +46,7 @@ class SearchWidget;
 class QDockWidget;
 class DisassemblyWidget;
 class GraphWidget;
+class CallGraphWidget;
 class HexdumpWidget;
 class PseudocodeWidget;
 class OverviewWidget;
@@ -92,7 +93,6 @@ public:
     void readDebugSettings();
     void saveDebugSettings();
     void setFilename(const QString &fn);
-    void refreshOmniBar(const QStringList &flags);
 
     void addToDockWidgetList(QDockWidget *dockWidget);
     void addDockWidgetAction(QDockWidget *dockWidget, QAction *action);
@@ -189,7 +189,6 @@ private slots:
     void disconnectOverview();
     void updateOverview();
     void forceUpdateOverview();
-    void updateOverviewAddr();
     void drawOverview();
     void adjustGraph();
 
@@ -218,6 +217,7 @@ private:
     GraphWidget        *graphDock = nullptr;
     GraphWidget        *targetGraphDock = nullptr;
     OverviewWidget     *overviewDock = nullptr;
+    CallGraphWidget    *callGraphDock = nullptr;
     EntrypointWidget   *entrypointDock = nullptr;
     FunctionsWidget    *functionsDock = nullptr;
     ImportsWidget      *importsDock = nullptr;
@@ -0,0 +1,481 @@
+#include "core/PatternScanner.h"
+#include "core/Cutter.h"
+
+#include <QRegularExpression>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+const size_t chunkSize = 1 << 20;
+
+int hexValue(QChar c)
+{
+    ushort u = c.unicode();
+    if (u >= '0' && u <= '9') {
+        return u - '0';
+    }
+    if (u >= 'a' && u <= 'f') {
+        return u - 'a' + 10;
+    }
+    if (u >= 'A' && u <= 'F') {
+        return u - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ * @brief Turn text into UTF-8, except for the escapes \n, \r, \t, \0, \\ and \xff
+ */
+bool unescape(const QString &text, QByteArray &bytes, QString *error)
+{
+    bytes.clear();
+    for (int i = 0; i < text.size(); i++) {
+        QChar c = text.at(i);
+        if (c != '\\') {
+            int j = i;
+            while (j < text.size() && text.at(j) != '\\') {
+                j++;
+            }
+            bytes += text.mid(i, j - i).toUtf8();
+            i = j - 1;
+            continue;
+        }
+        if (++i >= text.size()) {
+            *error = QObject::tr("incomplete escape at the end");
+            return false;
+        }
+        switch (text.at(i).unicode()) {
+        case 'n':
+            bytes += '\n';
+            break;
+        case 'r':
+            bytes += '\r';
+            break;
+        case 't':
+            bytes += '\t';
+            break;
+        case '0':
+            bytes += '\0';
+            break;
+        case '\\':
+            bytes += '\\';
+            break;
+        case 'x': {
+            int high = i + 1 < text.size() ? hexValue(text.at(i + 1)) : -1;
+            int low = i + 2 < text.size() ? hexValue(text.at(i + 2)) : -1;
+            if (high < 0 || low < 0) {
+                *error = QObject::tr("\\x must be followed by two hex digits");
+                return false;
+            }
+            bytes += static_cast<char>(high << 4 | low);
+            i += 2;
+            break;
+        }
+        default:
+            *error = QObject::tr("unknown escape \\%1").arg(text.at(i));
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Parse hex digits, with ? as a wildcard nibble, ignoring whitespace
+ */
+bool parseHex(const QString &text, QByteArray &bytes, QByteArray &mask, QString *error)
+{
+    bytes.clear();
+    mask.clear();
+    int nibbles = 0;
+    uchar byte = 0;
+    uchar byteMask = 0;
+    for (QChar c : text) {
+        if (c.isSpace()) {
+            continue;
+        }
+        int value = hexValue(c);
+        if (value < 0 && c != '?') {
+            *error = QObject::tr("%1 is neither a hex digit nor ?").arg(c);
+            return false;
+        }
+        byte = static_cast<uchar>(byte << 4 | (value < 0 ? 0 : value));
+        byteMask = static_cast<uchar>(byteMask << 4 | (value < 0 ? 0 : 0xf));
+        if (++nibbles % 2 == 0) {
+            bytes += static_cast<char>(byte);
+            mask += static_cast<char>(byteMask);
+        }
+    }
+    if (nibbles % 2) {
+        *error = QObject::tr("odd number of hex digits");
+        return false;
+    }
+    return true;
+}
+
+}
+
+bool PatternSet::add(const QString &name, const QByteArray &bytes, const QByteArray &mask,
+                     QString *error)
+{
+    Pattern pattern;
+    pattern.name = name;
+    pattern.mask = mask.isNull() ? QByteArray(bytes.size(), '\xff') : mask;
+    if (pattern.mask.size() != bytes.size() || !pattern.mask.contains('\xff')) {
+        if (error) {
+            *error = QObject::tr("%1 has no exact byte to search for").arg(name);
+        }
+        return false;
+    }
+    // Stored masked, so that matching only needs to mask the data
+    pattern.bytes = bytes;
+    for (int i = 0; i < bytes.size(); i++) {
+        pattern.bytes[i] = static_cast<char>(bytes.at(i) & pattern.mask.at(i));
+    }
+    patterns.append(pattern);
+    longest = std::max(longest, bytes.size());
+    return true;
+}
+
+bool PatternSet::parse(const QString &text, QString *error)
+{
+    QStringList lines = text.split('\n');
+    for (int i = 0; i < lines.size(); i++) {
+        QString lineError;
+        if (!parseLine(lines.at(i).trimmed(), &lineError)) {
+            if (error) {
+                *error = QObject::tr("Line %1: %2").arg(i + 1).arg(lineError);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PatternSet::load(const QString &path, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (error) {
+            *error = QObject::tr("Can't open %1: %2").arg(path, file.errorString());
+        }
+        return false;
+    }
+    return parse(QString::fromUtf8(file.readAll()), error);
+}
+
+bool PatternSet::parseLine(const QString &line, QString *error)
+{
+    if (line.isEmpty() || line.startsWith('#')) {
+        return true;
+    }
+
+    static const QRegularExpression kindExpression(
+        QStringLiteral("^(?:([^=:]+?)\\s*=\\s*)?(str|wide|hex)\\s*:\\s?(.*)$"));
+    QRegularExpressionMatch match = kindExpression.match(line);
+    QString name = line;
+    QString kind = QStringLiteral("str");
+    QString value = line;
+    if (match.hasMatch()) {
+        if (!match.captured(1).isEmpty()) {
+            name = match.captured(1);
+        }
+        kind = match.captured(2);
+        value = match.captured(3);
+    }
+
+    QByteArray bytes;
+    QByteArray mask;
+    if (kind == "hex") {
+        if (!parseHex(value, bytes, mask, error)) {
+            return false;
+        }
+    } else {
+        if (!unescape(value, bytes, error)) {
+            return false;
+        }
+        if (kind == "wide") {
+            QString wide = QString::fromUtf8(bytes);
+            bytes.clear();
+            for (QChar c : wide) {
+                bytes += static_cast<char>(c.unicode() & 0xff);
+                bytes += static_cast<char>(c.unicode() >> 8);
+            }
+        }
+    }
+    if (bytes.isEmpty()) {
+        *error = QObject::tr("empty pattern");
+        return false;
+    }
+    return add(name, bytes, mask, error);
+}
+
+void PatternSet::compile()
+{
+    next.assign(256, -1);
+    std::vector<std::vector<Anchor>> own(1);
+
+    // The longest run of exact bytes is the least likely to be found where the pattern isn't
+    for (int i = 0; i < patterns.size(); i++) {
+        const Pattern &pattern = patterns.at(i);
+        int bestBegin = 0;
+        int bestLength = 0;
+        for (int begin = 0; begin < pattern.mask.size();) {
+            int end = begin;
+            while (end < pattern.mask.size() && static_cast<uchar>(pattern.mask.at(end)) == 0xff) {
+                end++;
+            }
+            if (end - begin > bestLength) {
+                bestBegin = begin;
+                bestLength = end - begin;
+            }
+            begin = end + 1;
+        }
+        bestLength = std::min(bestLength, static_cast<int>(maxAnchorLength));
+
+        size_t state = 0;
+        for (int j = bestBegin; j < bestBegin + bestLength; j++) {
+            size_t transition = state * 256 + static_cast<uchar>(pattern.bytes.at(j));
+            if (next[transition] < 0) {
+                next[transition] = static_cast<qint32>(own.size());
+                next.resize(next.size() + 256, -1);
+                own.emplace_back();
+            }
+            state = static_cast<size_t>(next[transition]);
+        }
+        own[state].push_back({ i, bestBegin + bestLength });
+    }
+
+    // Breadth first, so that the failure state of every state is complete before the state is
+    size_t states = own.size();
+    std::vector<qint32> fail(states, 0);
+    std::vector<std::vector<Anchor>> all(states);
+    std::vector<size_t> queue;
+    queue.reserve(states);
+    for (size_t b = 0; b < 256; b++) {
+        if (next[b] < 0) {
+            next[b] = 0;
+        } else {
+            queue.push_back(static_cast<size_t>(next[b]));
+        }
+    }
+    all[0] = own[0];
+    for (size_t q = 0; q < queue.size(); q++) {
+        size_t state = queue[q];
+        size_t failure = static_cast<size_t>(fail[state]);
+        all[state] = own[state];
+        all[state].insert(all[state].end(), all[failure].begin(), all[failure].end());
+        for (size_t b = 0; b < 256; b++) {
+            qint32 &target = next[state * 256 + b];
+            qint32 fallback = next[failure * 256 + b];
+            if (target < 0) {
+                target = fallback;
+            } else {
+                fail[static_cast<size_t>(target)] = fallback;
+                queue.push_back(static_cast<size_t>(target));
+            }
+        }
+    }
+
+    outputs.assign(states + 1, 0);
+    anchors.clear();
+    for (size_t state = 0; state < states; state++) {
+        outputs[state] = static_cast<quint32>(anchors.size());
+        anchors.insert(anchors.end(), all[state].begin(), all[state].end());
+    }
+    outputs[states] = static_cast<quint32>(anchors.size());
+}
+
+void PatternSet::scan(const uchar *data, size_t begin, size_t end, size_t limit,
+                      std::vector<Match> &matches) const
+{
+    if (next.empty() || begin >= end || longest == 0) {
+        return;
+    }
+    size_t scanEnd = std::min(limit, end + static_cast<size_t>(longest) - 1);
+    const qint32 *table = next.data();
+    size_t state = 0;
+    for (size_t p = begin; p < scanEnd; p++) {
+        state = static_cast<size_t>(table[state * 256 + data[p]]);
+        quint32 last = outputs[state + 1];
+        for (quint32 a = outputs[state]; a < last; a++) {
+            const Anchor &anchor = anchors[a];
+            size_t anchorEnd = p + 1;
+            if (anchorEnd - begin < static_cast<size_t>(anchor.end)) {
+                continue;
+            }
+            size_t start = anchorEnd - static_cast<size_t>(anchor.end);
+            const Pattern &pattern = patterns.at(anchor.pattern);
+            if (start >= end || limit - start < static_cast<size_t>(pattern.bytes.size())) {
+                continue;
+            }
+            if (matchesAt(pattern, data + start)) {
+                matches.push_back({ anchor.pattern, start });
+            }
+        }
+    }
+}
+
+bool PatternSet::matchesAt(const Pattern &pattern, const uchar *p) const
+{
+    const char *bytes = pattern.bytes.constData();
+    const char *mask = pattern.mask.constData();
+    for (int i = 0; i < pattern.bytes.size(); i++) {
+        if ((p[i] & static_cast<uchar>(mask[i])) != static_cast<uchar>(bytes[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+PatternScanner::PatternScanner(const QString &filePath, const QList<SectionDescription> &sections,
+                               QSharedPointer<const PatternSet> patterns)
+    : file(filePath),
+      sections(sections),
+      patterns(patterns)
+{
+}
+
+QSharedPointer<PatternScanner> PatternScanner::forOpenFile(QSharedPointer<const PatternSet> patterns)
+{
+    return QSharedPointer<PatternScanner>(new PatternScanner(Core()->getConfig("file.path"),
+                                                             Core()->getAllSections(),
+                                                             patterns));
+}
+
+bool PatternScanner::open()
+{
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    size = static_cast<size_t>(file.size());
+    if (size > 0) {
+        data = file.map(0, file.size());
+        if (!data) {
+            return false;
+        }
+    }
+    buildChunks();
+    return true;
+}
+
+void PatternScanner::buildChunks()
+{
+    auto vaddrLess = [](const SectionDescription &a, const SectionDescription &b) {
+        return a.vaddr < b.vaddr;
+    };
+    QList<SectionDescription> sorted = sections;
+    std::sort(sorted.begin(), sorted.end(), vaddrLess);
+
+    // Only what is mapped from the file is searched, and every address only once
+    RVA covered = 0;
+    for (const SectionDescription &section : sorted) {
+        RVA length = std::min(section.size, section.vsize);
+        if (length == 0 || section.paddr >= size) {
+            continue;
+        }
+        RVA skip = covered > section.vaddr ? covered - section.vaddr : 0;
+        size_t begin = static_cast<size_t>(section.paddr + skip);
+        size_t end = static_cast<size_t>(std::min<RVA>(section.paddr + length, size));
+        if (skip >= length || begin >= end) {
+            continue;
+        }
+        covered = section.vaddr + length;
+
+        int index = static_cast<int>(regions.size());
+        regions.push_back({ begin, end, section.vaddr + skip });
+        for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += chunkSize) {
+            chunks.push_back({ index, chunkBegin, std::min(chunkBegin + chunkSize, end) });
+        }
+    }
+}
+
+bool PatternScanner::scan(const std::function<bool(std::vector<Hit> &)> &handleHits,
+                          const std::function<bool(int)> &chunkDone)
+{
+    std::vector<std::vector<Hit>> results(chunks.size());
+    std::vector<char> finished(chunks.size(), false);
+    std::mutex mutex;
+    std::condition_variable chunkFinished;
+    std::atomic<size_t> nextChunk(0);
+    std::atomic<bool> stop(false);
+
+    auto work = [&]() {
+        for (;;) {
+            size_t i = nextChunk++;
+            if (i >= chunks.size() || stop) {
+                return;
+            }
+            std::vector<Hit> hits = scanChunk(chunks[i]);
+            std::lock_guard<std::mutex> lock(mutex);
+            results[i] = std::move(hits);
+            finished[i] = true;
+            chunkFinished.notify_all();
+        }
+    };
+    size_t threadCount = std::min(static_cast<size_t>(std::max(1, QThread::idealThreadCount())),
+                                  chunks.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(work);
+    }
+
+    // The chunks are handed over in order, while the workers continue with the next ones
+    bool completed = true;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        std::vector<Hit> hits;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            chunkFinished.wait(lock, [&]() {
+                return finished[i] != 0;
+            });
+            hits.swap(results[i]);
+        }
+        if (!hits.empty() && !handleHits(hits)) {
+            completed = false;
+            break;
+        }
+        if (chunkDone && !chunkDone(static_cast<int>(i + 1))) {
+            completed = false;
+            break;
+        }
+    }
+
+    stop = true;
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    return completed;
+}
+
+QByteArray PatternScanner::bytesAt(size_t offset, size_t length) const
+{
+    if (offset >= size) {
+        return QByteArray();
+    }
+    length = std::min(length, size - offset);
+    return QByteArray(reinterpret_cast<const char *>(data + offset), static_cast<int>(length));
+}
+
+std::vector<PatternScanner::Hit> PatternScanner::scanChunk(const Chunk &chunk) const
+{
+    const Region &region = regions[static_cast<size_t>(chunk.region)];
+    std::vector<PatternSet::Match> matches;
+    patterns->scan(data, chunk.begin, chunk.end, region.end, matches);
+    std::sort(matches.begin(), matches.end(), [](const PatternSet::Match &a,
+                                                 const PatternSet::Match &b) {
+        return a.offset != b.offset ? a.offset < b.offset : a.pattern < b.pattern;
+    });
+
+    std::vector<Hit> hits;
+    hits.reserve(matches.size());
+    for (const PatternSet::Match &match : matches) {
+        hits.push_back({ match.pattern, region.vaddr + (match.offset - region.begin), match.offset });
+    }
+    return hits;
+}
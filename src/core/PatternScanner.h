@@ -0,0 +1,170 @@
+#ifndef PATTERNSCANNER_H
+#define PATTERNSCANNER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+
+#include <functional>
+#include <vector>
+
+#include "core/CutterCommon.h"
+#include "core/CutterDescriptions.h"
+
+/**
+ * @brief A set of byte patterns compiled into a single Aho-Corasick automaton.
+ *
+ * Patterns may contain wildcard bytes and nibbles. Only the longest run of exact bytes of each
+ * pattern, cut to maxAnchorLength bytes, goes into the automaton, the rest of the pattern is
+ * compared wherever that run is found. The automaton is a complete transition table, so the
+ * data is scanned with a single table lookup per byte, no matter how many patterns there are.
+ *
+ * Pattern set files have one pattern per line, empty lines and lines starting with # are
+ * ignored:
+ *
+ *     [name =] str: text with \n, \t, \\ and \xff escapes
+ *     [name =] wide: text that is searched as UTF-16LE
+ *     [name =] hex: 4d 5a ?? 00 e?
+ *
+ * A line without a kind is searched as a string and a pattern without a name is named after its
+ * line.
+ */
+class PatternSet
+{
+public:
+    struct Pattern {
+        QString name;
+        QByteArray bytes;
+        // 0xff for bytes that must be equal, 0x00 for wildcards, 0xf0 or 0x0f for nibbles
+        QByteArray mask;
+    };
+
+    struct Match {
+        int pattern;
+        size_t offset;
+    };
+
+    static const int maxAnchorLength = 8;
+
+    /**
+     * @brief Add a pattern, which can't be matched until compile() is called again
+     * @return false with error set if the pattern has no exact byte to look for
+     */
+    bool add(const QString &name, const QByteArray &bytes, const QByteArray &mask,
+             QString *error = nullptr);
+    /**
+     * @brief Add the patterns of text in the pattern set file format
+     * @return false with error set to the first line that can't be parsed
+     */
+    bool parse(const QString &text, QString *error = nullptr);
+    bool load(const QString &path, QString *error = nullptr);
+
+    void compile();
+
+    int count() const                           { return patterns.size(); }
+    const Pattern &pattern(int i) const         { return patterns.at(i); }
+    int maxLength() const                       { return longest; }
+
+    /**
+     * @brief Find the patterns that start from begin to end and end before limit.
+     *
+     * data must be readable from begin to limit, matches are appended in order of their end.
+     */
+    void scan(const uchar *data, size_t begin, size_t end, size_t limit,
+              std::vector<Match> &matches) const;
+
+private:
+    struct Anchor {
+        int pattern;
+        // Offset of the end of the anchor in the pattern
+        int end;
+    };
+
+    QList<Pattern> patterns;
+    int longest = 0;
+
+    // next[state * 256 + byte], state 0 is the root
+    std::vector<qint32> next;
+    // The anchors that end in state are anchors[outputs[state]] to anchors[outputs[state + 1]]
+    std::vector<quint32> outputs;
+    std::vector<Anchor> anchors;
+
+    bool parseLine(const QString &line, QString *error);
+    bool matchesAt(const Pattern &pattern, const uchar *p) const;
+};
+
+/**
+ * @brief Searches the mapped sections of the opened file for all patterns of a PatternSet at
+ * once.
+ *
+ * Like StringScanner, the file is mapped read-only and split into chunks that are scanned by
+ * one thread per core. A chunk finds the matches that start within it and reads past its end as
+ * far as the longest pattern needs, so matches across chunk boundaries are found exactly once
+ * while matches never cross the end of a section.
+ */
+class PatternScanner
+{
+public:
+    struct Hit {
+        int pattern;
+        RVA vaddr;
+        size_t offset;
+    };
+
+    PatternScanner(const QString &filePath, const QList<SectionDescription> &sections,
+                   QSharedPointer<const PatternSet> patterns);
+
+    static QSharedPointer<PatternScanner> forOpenFile(QSharedPointer<const PatternSet> patterns);
+
+    /**
+     * @brief Map the file, scan() can't be used if this fails
+     */
+    bool open();
+
+    int chunkCount() const                      { return static_cast<int>(chunks.size()); }
+
+    /**
+     * @brief Scan the sections.
+     * @param handleHits receives the hits of every chunk in address order, returns false to stop
+     * scanning
+     * @param chunkDone called after each chunk with the number of chunks done so far, returns
+     * false to stop scanning
+     * @return false if stopped
+     */
+    bool scan(const std::function<bool(std::vector<Hit> &hits)> &handleHits,
+              const std::function<bool(int done)> &chunkDone = nullptr);
+
+    /**
+     * @return the bytes of the file at offset, which must have been mapped by open()
+     */
+    QByteArray bytesAt(size_t offset, size_t length) const;
+
+private:
+    struct Region {
+        size_t begin;
+        size_t end;
+        RVA vaddr;
+    };
+
+    struct Chunk {
+        int region;
+        size_t begin;
+        size_t end;
+    };
+
+    QFile file;
+    QList<SectionDescription> sections;
+    QSharedPointer<const PatternSet> patterns;
+
+    const uchar *data = nullptr;
+    size_t size = 0;
+    std::vector<Region> regions;
+    std::vector<Chunk> chunks;
+
+    void buildChunks();
+    std::vector<Hit> scanChunk(const Chunk &chunk) const;
+};
+
+#endif // PATTERNSCANNER_H
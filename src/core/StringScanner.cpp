@@ -0,0 +1,433 @@
+#include "core/StringScanner.h"
+#include "core/Cutter.h"
+
+#include <QThread>
+#include <QtEndian>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// A multiple of 4, so that all chunks of a region look for wide strings at the same alignments
+const size_t chunkSize = 1 << 20;
+
+bool isPrintable(uint cp)
+{
+    if (cp < 0x80) {
+        return (cp >= 0x20 && cp < 0x7f) || cp == '\t' || cp == '\n' || cp == '\r';
+    }
+    return cp >= 0xa0 && cp <= 0x10ffff
+           && (cp < 0xd800 || cp > 0xdfff)
+           && (cp & 0xfffe) != 0xfffe;
+}
+
+/**
+ * @brief Classify 8 bytes at once
+ * @return whether all of them are printable ASCII (0x20 to 0x7e)
+ */
+bool allPrintableAscii(const uchar *p)
+{
+    const quint64 ones = 0x0101010101010101ULL;
+    const quint64 highBits = 0x8080808080808080ULL;
+    quint64 x;
+    memcpy(&x, p, sizeof(x));
+    quint64 below = (x - ones * 0x20) & ~x & highBits;
+    quint64 above = ((x + ones * (0x7f - 0x7e)) | x) & highBits;
+    return !(below | above);
+}
+
+/**
+ * @return length of the UTF-8 sequence at p, 0 if it is invalid
+ */
+int decodeUtf8(const uchar *p, size_t available, uint &cp)
+{
+    uchar lead = p[0];
+    if (lead < 0x80) {
+        cp = lead;
+        return 1;
+    }
+
+    size_t length;
+    uint minimum;
+    if (lead >= 0xc2 && lead <= 0xdf) {
+        length = 2;
+        cp = lead & 0x1f;
+        minimum = 0x80;
+    } else if (lead >= 0xe0 && lead <= 0xef) {
+        length = 3;
+        cp = lead & 0x0f;
+        minimum = 0x800;
+    } else if (lead >= 0xf0 && lead <= 0xf4) {
+        length = 4;
+        cp = lead & 0x07;
+        minimum = 0x10000;
+    } else {
+        return 0;
+    }
+    if (available < length) {
+        return 0;
+    }
+    for (size_t i = 1; i < length; i++) {
+        if ((p[i] & 0xc0) != 0x80) {
+            return 0;
+        }
+        cp = (cp << 6) | (p[i] & 0x3f);
+    }
+    if (cp < minimum || cp > 0x10ffff) {
+        return 0;
+    }
+    return static_cast<int>(length);
+}
+
+quint16 readUnit16(const uchar *p, bool bigEndian)
+{
+    return bigEndian ? qFromBigEndian<quint16>(p) : qFromLittleEndian<quint16>(p);
+}
+
+quint32 readUnit32(const uchar *p, bool bigEndian)
+{
+    return bigEndian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p);
+}
+
+/**
+ * @brief Wide strings are limited to the alphabetic scripts below U+0800. Any two ASCII bytes
+ * already form a CJK character, so accepting those would turn all text and most data into
+ * UTF-16 strings.
+ */
+bool isPrintableWide(uint cp)
+{
+    return cp < 0x800 && isPrintable(cp);
+}
+
+/**
+ * @brief Like r2, wide strings must be mostly ASCII. Tables of small integers are printable
+ * below U+0800 too, but rarely hit the ASCII range for more than a few entries in a row.
+ */
+bool isMostlyAscii(quint32 asciiChars, quint32 chars)
+{
+    return asciiChars * 2 > chars;
+}
+
+}
+
+StringScanner::StringScanner(const QString &filePath, const QList<SectionDescription> &sections,
+                             int minLength)
+    : file(filePath),
+      sections(sections),
+      minLength(static_cast<quint32>(std::max(1, minLength)))
+{
+}
+
+QSharedPointer<StringScanner> StringScanner::forOpenFile()
+{
+    // 0 leaves the choice to the bin plugin, which picks 4 for all common formats
+    int minLength = Core()->getConfigi("bin.minstr");
+    return QSharedPointer<StringScanner>(new StringScanner(Core()->getConfig("file.path"),
+                                                           Core()->getAllSections(),
+                                                           minLength > 0 ? minLength : 4));
+}
+
+bool StringScanner::open()
+{
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    size = static_cast<size_t>(file.size());
+    if (size > 0) {
+        data = file.map(0, file.size());
+        if (!data) {
+            return false;
+        }
+    }
+    buildChunks();
+    return true;
+}
+
+void StringScanner::buildChunks()
+{
+    auto addRegion = [this](size_t begin, size_t end, RVA vaddr, const QString &section) {
+        int index = static_cast<int>(regions.size());
+        regions.push_back({ begin, end, vaddr, section });
+        for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += chunkSize) {
+            chunks.push_back({ index, chunkBegin, std::min(chunkBegin + chunkSize, end) });
+        }
+    };
+
+    auto paddrLess = [](const SectionDescription &a, const SectionDescription &b) {
+        return a.paddr < b.paddr;
+    };
+    QList<SectionDescription> sorted = sections;
+    std::sort(sorted.begin(), sorted.end(), paddrLess);
+
+    // Like izz, the parts of the file outside of any section are scanned too
+    size_t pos = 0;
+    for (const SectionDescription &section : sorted) {
+        if (section.size == 0 || section.paddr >= size) {
+            continue;
+        }
+        size_t begin = std::max(static_cast<size_t>(section.paddr), pos);
+        size_t end = static_cast<size_t>(std::min<RVA>(section.paddr + section.size, size));
+        if (begin >= end) {
+            continue;
+        }
+        if (pos < begin) {
+            addRegion(pos, begin, pos, QString());
+        }
+        addRegion(begin, end, section.vaddr + (begin - section.paddr), section.name);
+        pos = end;
+    }
+    if (pos < size) {
+        addRegion(pos, size, pos, QString());
+    }
+}
+
+bool StringScanner::scan(int batchSize,
+                         const std::function<bool(CompactStringList &)> &handleBatch,
+                         const std::function<bool(int)> &chunkDone)
+{
+    std::vector<std::vector<Run>> results(chunks.size());
+    std::vector<char> finished(chunks.size(), false);
+    std::mutex mutex;
+    std::condition_variable chunkFinished;
+    std::atomic<size_t> nextChunk(0);
+    std::atomic<bool> stop(false);
+
+    auto work = [&]() {
+        for (;;) {
+            size_t i = nextChunk++;
+            if (i >= chunks.size() || stop) {
+                return;
+            }
+            std::vector<Run> runs = scanChunk(chunks[i]);
+            std::lock_guard<std::mutex> lock(mutex);
+            results[i] = std::move(runs);
+            finished[i] = true;
+            chunkFinished.notify_all();
+        }
+    };
+    size_t threadCount = std::min(static_cast<size_t>(std::max(1, QThread::idealThreadCount())),
+                                  chunks.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(work);
+    }
+
+    // The chunks are merged in order, while the workers continue with the next ones. A string
+    // that starts before the end of the previous one of the same width is either its tail, seen
+    // again from the next chunk, or the same bytes at another alignment.
+    bool completed = true;
+    size_t covered[3] = { 0, 0, 0 };
+    CompactStringList batch;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        std::vector<Run> runs;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            chunkFinished.wait(lock, [&]() {
+                return finished[i] != 0;
+            });
+            runs.swap(results[i]);
+        }
+
+        const Chunk &chunk = chunks[i];
+        const Region &region = regions[static_cast<size_t>(chunk.region)];
+        for (const Run &run : runs) {
+            size_t &end = covered[run.encoding == Utf8 ? 0 : (run.encoding <= Utf16BE ? 1 : 2)];
+            if (run.begin < end) {
+                continue;
+            }
+            end = run.end;
+            appendRun(run, region, batch);
+        }
+
+        bool sectionEnd = i + 1 == chunks.size() || chunks[i + 1].region != chunk.region;
+        if ((sectionEnd && !batch.isEmpty()) || batch.count() >= batchSize) {
+            if (!handleBatch(batch)) {
+                completed = false;
+                break;
+            }
+            batch = CompactStringList();
+        }
+        if (chunkDone && !chunkDone(static_cast<int>(i + 1))) {
+            completed = false;
+            break;
+        }
+    }
+
+    stop = true;
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    return completed;
+}
+
+std::vector<StringScanner::Run> StringScanner::scanChunk(const Chunk &chunk) const
+{
+    // Strings must start in the chunk, but may continue up to the end of the section
+    const Region &region = regions[static_cast<size_t>(chunk.region)];
+    size_t regionBegin = region.begin;
+    size_t limit = region.end;
+
+    std::vector<Run> runs;
+    scanUtf8(regionBegin, chunk.begin, chunk.end, limit, runs);
+    for (Encoding encoding : { Utf16LE, Utf16BE, Utf32LE, Utf32BE }) {
+        scanWide(encoding, regionBegin, chunk.begin, chunk.end, limit, runs);
+    }
+
+    std::sort(runs.begin(), runs.end(), [](const Run &a, const Run &b) {
+        return a.begin != b.begin ? a.begin < b.begin : a.end > b.end;
+    });
+    return runs;
+}
+
+void StringScanner::scanUtf8(size_t regionBegin, size_t begin, size_t chunkEnd, size_t limit,
+                             std::vector<Run> &runs) const
+{
+    size_t p = begin;
+
+    // A run that continues from the previous chunk was followed to its end there already, so
+    // skip to its first break instead of following it once more for every chunk it crosses
+    if (p > regionBegin) {
+        size_t sequence = p - 1;
+        while (sequence > regionBegin && p - sequence < 4 && (data[sequence] & 0xc0) == 0x80) {
+            sequence--;
+        }
+        // The sequence may also end inside the chunk
+        uint cp;
+        int length = decodeUtf8(data + sequence, limit - sequence, cp);
+        if (length && sequence + static_cast<size_t>(length) >= p && isPrintable(cp)) {
+            p = sequence + static_cast<size_t>(length);
+            while (p < chunkEnd) {
+                if (limit - p >= 8 && allPrintableAscii(data + p)) {
+                    p += 8;
+                    continue;
+                }
+                length = decodeUtf8(data + p, limit - p, cp);
+                if (!length || !isPrintable(cp)) {
+                    break;
+                }
+                p += static_cast<size_t>(length);
+            }
+        }
+    }
+
+    while (p < chunkEnd) {
+        size_t start = p;
+        quint32 chars = 0;
+        quint32 asciiChars = 0;
+        while (p < limit) {
+            if (limit - p >= 8 && allPrintableAscii(data + p)) {
+                p += 8;
+                chars += 8;
+                asciiChars += 8;
+                continue;
+            }
+            uint cp;
+            int length = decodeUtf8(data + p, limit - p, cp);
+            if (!length || !isPrintable(cp)) {
+                break;
+            }
+            p += static_cast<size_t>(length);
+            chars++;
+            if (cp < 0x80) {
+                asciiChars++;
+            }
+        }
+        if (chars >= minLength) {
+            runs.push_back({ start, p, chars, Utf8, asciiChars == chars });
+        }
+        if (p == start) {
+            p++;
+        }
+    }
+}
+
+void StringScanner::scanWide(Encoding encoding, size_t regionBegin, size_t begin, size_t chunkEnd,
+                             size_t limit, std::vector<Run> &runs) const
+{
+    bool wide32 = encoding == Utf32LE || encoding == Utf32BE;
+    bool bigEndian = encoding == Utf16BE || encoding == Utf32BE;
+    size_t unit = wide32 ? 4 : 2;
+    auto readUnit = [&](size_t p) -> uint {
+        return wide32 ? readUnit32(data + p, bigEndian) : readUnit16(data + p, bigEndian);
+    };
+
+    for (size_t lane = 0; lane < unit; lane++) {
+        size_t p = begin + lane;
+        // Same as for UTF-8, the run through the previous unit of this lane was handled by the
+        // previous chunk
+        if (p >= regionBegin + unit && isPrintableWide(readUnit(p - unit))) {
+            while (p < chunkEnd && limit - p >= unit && isPrintableWide(readUnit(p))) {
+                p += unit;
+            }
+        }
+        while (p < chunkEnd) {
+            size_t start = p;
+            quint32 chars = 0;
+            quint32 asciiChars = 0;
+            while (p < limit && limit - p >= unit) {
+                uint cp = readUnit(p);
+                if (!isPrintableWide(cp)) {
+                    break;
+                }
+                p += unit;
+                chars++;
+                if (cp < 0x80) {
+                    asciiChars++;
+                }
+            }
+            if (chars >= minLength && isMostlyAscii(asciiChars, chars)) {
+                runs.push_back({ start, p, chars, encoding, false });
+            }
+            if (p == start) {
+                p += unit;
+            }
+        }
+    }
+}
+
+void StringScanner::appendRun(const Run &run, const Region &region, CompactStringList &batch) const
+{
+    const uchar *p = data + run.begin;
+    size_t bytes = run.end - run.begin;
+
+    StringDescription string;
+    switch (run.encoding) {
+    case Utf8:
+        string.string = QString::fromUtf8(reinterpret_cast<const char *>(p), static_cast<int>(bytes));
+        string.type = run.ascii ? QStringLiteral("ascii") : QStringLiteral("utf8");
+        break;
+    case Utf16LE:
+    case Utf16BE: {
+        bool bigEndian = run.encoding == Utf16BE;
+        string.string.resize(static_cast<int>(bytes / 2));
+        QChar *out = string.string.data();
+        for (size_t i = 0; i < bytes / 2; i++) {
+            out[i] = QChar(readUnit16(p + i * 2, bigEndian));
+        }
+        string.type = bigEndian ? QStringLiteral("utf16be") : QStringLiteral("utf16le");
+        break;
+    }
+    case Utf32LE:
+    case Utf32BE: {
+        bool bigEndian = run.encoding == Utf32BE;
+        std::vector<uint> codePoints(bytes / 4);
+        for (size_t i = 0; i < codePoints.size(); i++) {
+            codePoints[i] = readUnit32(p + i * 4, bigEndian);
+        }
+        string.string = QString::fromUcs4(codePoints.data(), static_cast<int>(codePoints.size()));
+        string.type = bigEndian ? QStringLiteral("utf32be") : QStringLiteral("utf32le");
+        break;
+    }
+    }
+
+    string.vaddr = region.vaddr + (run.begin - region.begin);
+    string.section = region.section;
+    string.length = run.chars;
+    string.size = static_cast<ut32>(bytes);
+    batch.append(string);
+}
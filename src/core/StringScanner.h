@@ -0,0 +1,98 @@
+#ifndef STRINGSCANNER_H
+#define STRINGSCANNER_H
+
+#include <QFile>
+#include <QList>
+#include <QSharedPointer>
+
+#include <functional>
+#include <vector>
+
+#include "core/CutterCommon.h"
+#include "core/CutterDescriptions.h"
+#include "core/CompactStringList.h"
+
+/**
+ * @brief Native replacement for izzj, finds the strings in the whole file that is opened.
+ *
+ * The file is mapped read-only and split into chunks that are scanned by one thread per core.
+ * Each chunk is searched for ASCII/UTF-8, UTF-16LE/BE and UTF-32LE/BE strings, the results are
+ * merged in file order and handed over section by section, filling CompactStringList directly
+ * instead of going through JSON and base64.
+ */
+class StringScanner
+{
+public:
+    StringScanner(const QString &filePath, const QList<SectionDescription> &sections,
+                  int minLength);
+
+    /**
+     * @brief Scanner for the file opened in the core, with the minimum length that izzj uses
+     */
+    static QSharedPointer<StringScanner> forOpenFile();
+
+    /**
+     * @brief Map the file, scan() can't be used if this fails
+     */
+    bool open();
+
+    /**
+     * @return number of chunks that scan() processes, for progress reporting
+     */
+    int chunkCount() const                      { return static_cast<int>(chunks.size()); }
+
+    /**
+     * @brief Scan the file.
+     * @param batchSize handleBatch is called at the end of each section and whenever this many
+     * strings were found
+     * @param handleBatch receives the strings in file order, returns false to stop scanning
+     * @param chunkDone called after each chunk with the number of chunks done so far, returns
+     * false to stop scanning
+     * @return false if stopped
+     */
+    bool scan(int batchSize, const std::function<bool(CompactStringList &batch)> &handleBatch,
+              const std::function<bool(int done)> &chunkDone = nullptr);
+
+private:
+    enum Encoding : quint8 { Utf8, Utf16LE, Utf16BE, Utf32LE, Utf32BE };
+
+    struct Run {
+        size_t begin;
+        size_t end;
+        quint32 chars;
+        Encoding encoding;
+        bool ascii;
+    };
+
+    struct Region {
+        size_t begin;
+        size_t end;
+        RVA vaddr;
+        QString section;
+    };
+
+    struct Chunk {
+        int region;
+        size_t begin;
+        size_t end;
+    };
+
+    QFile file;
+    QList<SectionDescription> sections;
+    quint32 minLength;
+
+    const uchar *data = nullptr;
+    size_t size = 0;
+    std::vector<Region> regions;
+    std::vector<Chunk> chunks;
+
+    void buildChunks();
+    std::vector<Run> scanChunk(const Chunk &chunk) const;
+    void scanUtf8(size_t regionBegin, size_t begin, size_t chunkEnd, size_t limit,
+                  std::vector<Run> &runs) const;
+    void scanWide(Encoding encoding, size_t regionBegin, size_t begin, size_t chunkEnd, size_t limit,
+                  std::vector<Run> &runs) const;
+    void appendRun(const Run &run, const Region &region, CompactStringList &batch) const;
+};
+
+#endif // STRINGSCANNER_H
@@ -0,0 +1,505 @@
+#include "core/TextIndex.h"
+#include "core/Cutter.h"
+
+#include <QObject>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+
+namespace {
+
+// Basic blocks larger than this are only indexed up to it
+const RVA maxBlockSize = 1 << 16;
+
+struct SegmentSource {
+    RVA offset;
+    QString name;
+    std::vector<std::pair<RVA, RVA>> blocks;
+    std::vector<std::pair<RVA, QString>> comments;
+    std::vector<std::pair<RVA, QString>> flags;
+    quint64 fingerprint;
+};
+
+// FNV-1a
+void hashValue(quint64 &hash, quint64 value)
+{
+    for (int i = 0; i < 8; i++) {
+        hash ^= (value >> (8 * i)) & 0xff;
+        hash *= 0x100000001b3ULL;
+    }
+}
+
+void hashText(quint64 &hash, const QString &text)
+{
+    for (QChar c : text) {
+        hashValue(hash, c.unicode());
+    }
+}
+
+quint64 fingerprintOf(const SegmentSource &source)
+{
+    quint64 hash = 0xcbf29ce484222325ULL;
+    hashText(hash, source.name);
+    for (const std::pair<RVA, RVA> &block : source.blocks) {
+        hashValue(hash, block.first);
+        hashValue(hash, block.second);
+    }
+    for (const auto *texts : { &source.comments, &source.flags }) {
+        // Separates the comments from the flags
+        hashValue(hash, texts->size());
+        for (const std::pair<RVA, QString> &text : *texts) {
+            hashValue(hash, text.first);
+            hashText(hash, text.second);
+        }
+    }
+    return hash;
+}
+
+/**
+ * @brief Collect the functions with their basic blocks, comments and flags, and the comments and
+ * flags outside of all functions as the last segment.
+ */
+std::vector<SegmentSource> segmentSources()
+{
+    std::vector<SegmentSource> sources;
+    {
+        RCoreLocked core = Core()->core();
+        RListIter *it;
+        RListIter *bbIt;
+        RAnalFunction *fcn;
+        RAnalBlock *bb;
+        CutterRListForeach(core->anal->fcns, it, RAnalFunction, fcn) {
+            SegmentSource source;
+            source.offset = fcn->addr;
+            source.name = QString::fromUtf8(fcn->name);
+            CutterRListForeach(fcn->bbs, bbIt, RAnalBlock, bb) {
+                source.blocks.push_back({ bb->addr, static_cast<RVA>(bb->size) });
+            }
+            std::sort(source.blocks.begin(), source.blocks.end());
+            sources.push_back(std::move(source));
+        }
+    }
+    SegmentSource outside;
+    outside.offset = RVA_INVALID;
+    sources.push_back(std::move(outside));
+
+    // Blocks by address, to find the function of every comment and flag
+    struct BlockRange {
+        RVA begin;
+        RVA end;
+        size_t source;
+        bool operator<(const BlockRange &other) const { return begin < other.begin; }
+    };
+    std::vector<BlockRange> ranges;
+    for (size_t i = 0; i < sources.size(); i++) {
+        for (const std::pair<RVA, RVA> &block : sources[i].blocks) {
+            ranges.push_back({ block.first, block.first + block.second, i });
+        }
+    }
+    std::sort(ranges.begin(), ranges.end());
+    auto sourceAt = [&](RVA offset) -> SegmentSource & {
+        auto it = std::upper_bound(ranges.begin(), ranges.end(), BlockRange { offset, offset, 0 });
+        if (it != ranges.begin() && offset < std::prev(it)->end) {
+            return sources[std::prev(it)->source];
+        }
+        return sources.back();
+    };
+
+    for (const CommentDescription &comment : Core()->getAllComments("CCu")) {
+        sourceAt(comment.offset).comments.push_back({ comment.offset, comment.name });
+    }
+    for (const FlagDescription &flag : Core()->getFlags()) {
+        sourceAt(flag.offset).flags.push_back({ flag.offset, flag.name });
+    }
+    for (SegmentSource &source : sources) {
+        std::sort(source.comments.begin(), source.comments.end());
+        std::sort(source.flags.begin(), source.flags.end());
+        source.fingerprint = fingerprintOf(source);
+    }
+    return sources;
+}
+
+bool containsAny(const std::vector<std::pair<RVA, RVA>> &blocks, const std::vector<RVA> &sortedOffsets)
+{
+    for (const std::pair<RVA, RVA> &block : blocks) {
+        auto it = std::lower_bound(sortedOffsets.begin(), sortedOffsets.end(), block.first);
+        if (it != sortedOffsets.end() && *it < block.first + block.second) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Disassemble the basic blocks into normalized instructions
+ */
+std::vector<std::pair<RVA, QString>> disassemble(const std::vector<std::pair<RVA, RVA>> &blocks)
+{
+    std::vector<std::pair<RVA, QString>> instructions;
+    std::vector<ut8> buffer;
+    // One function at a time, so other users of the core don't wait for the whole index
+    RCoreLocked core = Core()->core();
+    for (const std::pair<RVA, RVA> &block : blocks) {
+        RVA size = std::min(block.second, maxBlockSize);
+        buffer.resize(static_cast<size_t>(size));
+        if (size == 0 || !r_io_read_at(core->io, block.first, buffer.data(), static_cast<int>(size))) {
+            continue;
+        }
+        RVA offset = 0;
+        while (offset < size) {
+            RVA address = block.first + offset;
+            RAsmOp op = {};
+            r_asm_set_pc(core->assembler, address);
+            int length = r_asm_disassemble(core->assembler, &op, buffer.data() + offset,
+                                           static_cast<int>(size - offset));
+            if (length > 0) {
+                instructions.push_back({ address, TextIndex::normalize(QString::fromUtf8(r_asm_op_get_asm(&op))) });
+            }
+            r_asm_op_fini(&op);
+            offset += static_cast<RVA>(std::max(length, 1));
+        }
+    }
+
+    // Blocks of a function can overlap
+    std::stable_sort(instructions.begin(), instructions.end(), [](const std::pair<RVA, QString> &a,
+                                                                  const std::pair<RVA, QString> &b) {
+        return a.first < b.first;
+    });
+    instructions.erase(std::unique(instructions.begin(), instructions.end(),
+                                   [](const std::pair<RVA, QString> &a, const std::pair<RVA, QString> &b) {
+        return a.first == b.first;
+    }), instructions.end());
+    return instructions;
+}
+
+bool isTokenChar(QChar c)
+{
+    return c.isLetterOrNumber() || c == QLatin1Char('_');
+}
+
+/**
+ * @return whether text contains token with no token characters right before or after it
+ */
+bool containsToken(const QString &text, const QString &token)
+{
+    int from = 0;
+    for (;;) {
+        int i = text.indexOf(token, from, Qt::CaseInsensitive);
+        if (i < 0) {
+            return false;
+        }
+        int end = i + token.size();
+        if ((i == 0 || !isTokenChar(text.at(i - 1))) && (end == text.size() || !isTokenChar(text.at(end)))) {
+            return true;
+        }
+        from = i + 1;
+    }
+}
+
+}
+
+QSharedPointer<const TextIndex> TextIndex::build(const QSharedPointer<const TextIndex> &previous,
+                                                 const QSet<RVA> &changed,
+                                                 const std::function<bool()> &interrupted)
+{
+    QSharedPointer<TextIndex> index(new TextIndex());
+    index->asmOptions = QStringList {
+        Core()->getConfig("asm.arch"),
+        QString::number(Core()->getConfigi("asm.bits")),
+        Core()->getConfig("asm.syntax")
+    }.join(QLatin1Char(' '));
+    // Every line of disassembly changes with these
+    if (previous && previous->asmOptions == index->asmOptions) {
+        index->segments = previous->segments;
+        index->postings = previous->postings;
+    }
+
+    std::vector<RVA> changedOffsets(changed.begin(), changed.end());
+    std::sort(changedOffsets.begin(), changedOffsets.end());
+
+    // What changes in the postings of each token, collected over all segments first so that
+    // every postings list is decoded and encoded only once
+    QHash<QString, std::vector<RVA>> removed;
+    QHash<QString, std::vector<RVA>> added;
+
+    std::vector<SegmentSource> sources = segmentSources();
+    QSet<RVA> present;
+    for (const SegmentSource &source : sources) {
+        present.insert(source.offset);
+    }
+    for (auto it = index->segments.begin(); it != index->segments.end();) {
+        if (present.contains(it.key())) {
+            ++it;
+            continue;
+        }
+        for (const QString &token : it.value()->tokens) {
+            removed[token].push_back(it.key());
+        }
+        it = index->segments.erase(it);
+    }
+
+    for (const SegmentSource &source : sources) {
+        auto it = index->segments.find(source.offset);
+        if (it != index->segments.end() && it.value()->fingerprint == source.fingerprint
+                && !containsAny(source.blocks, changedOffsets)) {
+            continue;
+        }
+        if (interrupted && interrupted()) {
+            return QSharedPointer<const TextIndex>();
+        }
+        if (it != index->segments.end()) {
+            for (const QString &token : it.value()->tokens) {
+                removed[token].push_back(source.offset);
+            }
+        }
+
+        struct SourceLine {
+            RVA offset;
+            LineType type;
+            const QString *text;
+        };
+        std::vector<std::pair<RVA, QString>> instructions = disassemble(source.blocks);
+        std::vector<SourceLine> sourceLines;
+        sourceLines.reserve(instructions.size() + source.comments.size() + source.flags.size());
+        for (const std::pair<RVA, QString> &instruction : instructions) {
+            sourceLines.push_back({ instruction.first, LineType::Instruction, &instruction.second });
+        }
+        for (const std::pair<RVA, QString> &comment : source.comments) {
+            sourceLines.push_back({ comment.first, LineType::Comment, &comment.second });
+        }
+        for (const std::pair<RVA, QString> &flag : source.flags) {
+            sourceLines.push_back({ flag.first, LineType::Flag, &flag.second });
+        }
+        std::stable_sort(sourceLines.begin(), sourceLines.end(), [](const SourceLine &a, const SourceLine &b) {
+            return a.offset < b.offset || (a.offset == b.offset && a.type < b.type);
+        });
+
+        QSharedPointer<Segment> segment(new Segment());
+        segment->fingerprint = source.fingerprint;
+        segment->name = source.name;
+        segment->offsets.reserve(sourceLines.size());
+        segment->types.reserve(sourceLines.size());
+        QSet<QString> tokens;
+        for (const SourceLine &line : sourceLines) {
+            segment->offsets.push_back(line.offset);
+            segment->types.push_back(line.type);
+            segment->lines.append(*line.text);
+            for (const QString &token : tokenize(*line.text)) {
+                tokens.insert(token);
+            }
+        }
+        segment->lines.squeeze();
+        segment->tokens = tokens.toList();
+        for (const QString &token : segment->tokens) {
+            added[token].push_back(source.offset);
+        }
+        index->segments.insert(source.offset, segment);
+        index->builtSegments++;
+    }
+
+    QSet<QString> tokens;
+    for (auto it = removed.constBegin(); it != removed.constEnd(); ++it) {
+        tokens.insert(it.key());
+    }
+    for (auto it = added.constBegin(); it != added.constEnd(); ++it) {
+        tokens.insert(it.key());
+    }
+
+    std::vector<RVA> offsets;
+    for (const QString &token : tokens) {
+        offsets.clear();
+        DeltaCoding::decode(index->postings.value(token), offsets);
+        auto removedIt = removed.find(token);
+        if (removedIt != removed.end()) {
+            std::vector<RVA> &toRemove = removedIt.value();
+            std::sort(toRemove.begin(), toRemove.end());
+            std::vector<RVA> kept;
+            kept.reserve(offsets.size());
+            std::set_difference(offsets.begin(), offsets.end(), toRemove.begin(), toRemove.end(),
+                                std::back_inserter(kept));
+            offsets.swap(kept);
+        }
+        auto addedIt = added.constFind(token);
+        if (addedIt != added.constEnd()) {
+            offsets.insert(offsets.end(), addedIt.value().begin(), addedIt.value().end());
+            std::sort(offsets.begin(), offsets.end());
+        }
+        if (offsets.empty()) {
+            index->postings.remove(token);
+        } else {
+            index->postings.insert(token, DeltaCoding::encode(offsets));
+        }
+    }
+    return index;
+}
+
+QList<TextIndex::Group> TextIndex::search(const QString &query, int limit, QString *error) const
+{
+    QString trimmed = query.trimmed();
+    if (trimmed.size() > 2 && trimmed.startsWith(QLatin1Char('/')) && trimmed.endsWith(QLatin1Char('/'))) {
+        QRegularExpression regExp(trimmed.mid(1, trimmed.size() - 2),
+                                  QRegularExpression::CaseInsensitiveOption);
+        if (!regExp.isValid()) {
+            if (error) {
+                *error = QObject::tr("Invalid regular expression: %1").arg(regExp.errorString());
+            }
+            return QList<Group>();
+        }
+        std::vector<RVA> keys;
+        keys.reserve(static_cast<size_t>(segments.size()));
+        for (auto it = segments.constBegin(); it != segments.constEnd(); ++it) {
+            keys.push_back(it.key());
+        }
+        std::sort(keys.begin(), keys.end());
+        return scan(keys, [regExp](const QString &line) {
+            return regExp.match(line).hasMatch();
+        }, limit);
+    }
+
+    QString normalized = normalize(trimmed);
+    QStringList tokens = tokenize(normalized);
+    if (tokens.isEmpty()) {
+        if (error) {
+            *error = QObject::tr("The query contains no words to search for");
+        }
+        return QList<Group>();
+    }
+    // Anything but words and spaces, like "[rip+", has to appear as it is
+    bool phrase = std::any_of(normalized.begin(), normalized.end(), [](QChar c) {
+        return !isTokenChar(c) && c != QLatin1Char(' ');
+    });
+    return scan(candidates(tokens), [tokens, phrase, normalized](const QString &line) {
+        for (const QString &token : tokens) {
+            if (!containsToken(line, token)) {
+                return false;
+            }
+        }
+        return !phrase || line.contains(normalized, Qt::CaseInsensitive);
+    }, limit);
+}
+
+QString TextIndex::normalize(const QString &disassembly)
+{
+    static const QRegularExpression sizeKeyword(
+        QStringLiteral("\\b(?:byte|word|dword|fword|qword|tword|oword|xmmword|ymmword|zmmword)\\s+(?:ptr\\s+)?(?=\\[)"));
+    static const QRegularExpression operatorSpaces(QStringLiteral("\\s*([+\\-*,])\\s*"));
+    static const QRegularExpression spaces(QStringLiteral("\\s+"));
+
+    QString text = disassembly.toLower();
+    text.replace(sizeKeyword, QString());
+    text.replace(operatorSpaces, QStringLiteral("\\1"));
+    text.replace(spaces, QStringLiteral(" "));
+    return text.trimmed();
+}
+
+QStringList TextIndex::tokenize(const QString &text)
+{
+    QStringList tokens;
+    int start = -1;
+    for (int i = 0; i <= text.size(); i++) {
+        if (i < text.size() && isTokenChar(text.at(i))) {
+            if (start < 0) {
+                start = i;
+            }
+            continue;
+        }
+        if (start >= 0) {
+            QString token = text.mid(start, i - start).toLower();
+            if (!tokens.contains(token)) {
+                tokens << token;
+            }
+            start = -1;
+        }
+    }
+    return tokens;
+}
+
+std::vector<RVA> TextIndex::candidates(const QStringList &tokens) const
+{
+    std::vector<RVA> result;
+    std::vector<RVA> offsets;
+    for (int i = 0; i < tokens.size(); i++) {
+        auto it = postings.constFind(tokens.at(i));
+        if (it == postings.constEnd()) {
+            return std::vector<RVA>();
+        }
+        offsets.clear();
+        DeltaCoding::decode(it.value(), offsets);
+        if (i == 0) {
+            result.swap(offsets);
+            continue;
+        }
+        std::vector<RVA> both;
+        std::set_intersection(result.begin(), result.end(), offsets.begin(), offsets.end(),
+                              std::back_inserter(both));
+        result.swap(both);
+        if (result.empty()) {
+            break;
+        }
+    }
+    return result;
+}
+
+QList<TextIndex::Group> TextIndex::scan(const std::vector<RVA> &keys,
+                                        const std::function<bool(const QString &)> &matches,
+                                        int limit) const
+{
+    // Line numbers of the matches of each segment
+    std::vector<std::vector<size_t>> results(keys.size());
+    std::atomic<size_t> nextSegment(0);
+    std::atomic<int> found(0);
+
+    // Segments are taken in order and always finished once taken, so those searched when the
+    // limit is reached are the first ones
+    auto work = [&]() {
+        for (;;) {
+            if (limit > 0 && found >= limit) {
+                return;
+            }
+            size_t i = nextSegment++;
+            if (i >= keys.size()) {
+                return;
+            }
+            const Segment &segment = *segments.value(keys[i]);
+            for (size_t line = 0; line < segment.lines.count(); line++) {
+                if (matches(segment.lines.at(line))) {
+                    results[i].push_back(line);
+                }
+            }
+            found += static_cast<int>(results[i].size());
+        }
+    };
+    size_t threadCount = std::min(static_cast<size_t>(std::max(1, QThread::idealThreadCount())),
+                                  keys.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(work);
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    QList<Group> groups;
+    int count = 0;
+    for (size_t i = 0; i < keys.size() && (limit <= 0 || count < limit); i++) {
+        if (results[i].empty()) {
+            continue;
+        }
+        const Segment &segment = *segments.value(keys[i]);
+        Group group;
+        group.offset = keys[i];
+        group.name = segment.name;
+        for (size_t line : results[i]) {
+            if (limit > 0 && count >= limit) {
+                break;
+            }
+            group.lines.append({ segment.offsets[line], segment.types[line], segment.lines.at(line) });
+            count++;
+        }
+        groups.append(group);
+    }
+    return groups;
+}
@@ -0,0 +1,119 @@
+#ifndef TEXTINDEX_H
+#define TEXTINDEX_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QRegularExpression>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+#include <vector>
+
+#include "core/CutterCommon.h"
+#include "common/CompactStorage.h"
+
+/**
+ * @brief Full-text index over the disassembly of the analysed functions, the comments and the
+ * flag names.
+ *
+ * Every function is a segment holding one line per instruction, comment and flag inside its
+ * basic blocks. Comments and flags outside of all functions make up one more segment. The
+ * disassembly is normalized, so the same instruction always reads the same: lowercase, single
+ * spaces, no spaces around operators and no size keywords before memory operands, e.g.
+ * "call [rip+0x2fe2]".
+ *
+ * Tokens, i.e. runs of letters, digits and underscores, have a postings list of the segments
+ * that contain them, stored with DeltaCoding. Token queries only look at the segments that
+ * contain all of their tokens, regular expressions are matched against all lines by one
+ * thread per core.
+ *
+ * The index is immutable once built and can be shared between threads. Building it again from
+ * the previous one only disassembles the segments whose basic blocks, comments or flags changed,
+ * or that contain one of the changed addresses passed to build().
+ */
+class TextIndex
+{
+public:
+    // In the order the lines of the same address are shown in the disassembly
+    enum class LineType : quint8 { Flag, Instruction, Comment };
+
+    struct Line {
+        RVA offset;
+        LineType type;
+        QString text;
+    };
+
+    /**
+     * @brief Lines of one function, or of no function if offset is RVA_INVALID
+     */
+    struct Group {
+        RVA offset;
+        QString name;
+        QList<Line> lines;
+    };
+
+    /**
+     * @brief Index the core, reusing previous for the unchanged segments.
+     * @param changed addresses whose bytes changed, e.g. by writing to them, their segments are
+     * disassembled again
+     * @param interrupted polled between segments, stops building if it returns true
+     * @return null if interrupted
+     */
+    static QSharedPointer<const TextIndex> build(const QSharedPointer<const TextIndex> &previous,
+                                                 const QSet<RVA> &changed = QSet<RVA>(),
+                                                 const std::function<bool()> &interrupted = nullptr);
+
+    /**
+     * @brief Find the lines that contain query, ignoring case, after normalizing it like the
+     * disassembly. A query enclosed in slashes is a regular expression instead, e.g. /^call.*rax$/.
+     * @param limit stop after that many lines, 0 for no limit
+     * @param error set if query is an invalid regular expression or has no words
+     * @return matching lines grouped by function, in address order, lines outside of functions
+     * last
+     */
+    QList<Group> search(const QString &query, int limit = 0, QString *error = nullptr) const;
+
+    int segmentCount() const                    { return segments.size(); }
+    int tokenCount() const                      { return postings.size(); }
+    /**
+     * @return number of segments disassembled by the build that made this index
+     */
+    int builtSegmentCount() const               { return builtSegments; }
+
+    /**
+     * @brief Normalize an instruction the way the index stores it
+     */
+    static QString normalize(const QString &disassembly);
+
+private:
+    struct Segment {
+        // Changes with the basic blocks, comments and flags of the segment
+        quint64 fingerprint;
+        QString name;
+        // Sorted by offset, then type
+        std::vector<RVA> offsets;
+        std::vector<LineType> types;
+        StringArena lines;
+        // Distinct tokens of the lines, so they can be removed from the postings
+        QStringList tokens;
+    };
+
+    // Keyed by function offset, RVA_INVALID for the lines outside of functions. Shared with the
+    // next builds until the segment changes.
+    QHash<RVA, QSharedPointer<const Segment>> segments;
+    QHash<QString, QByteArray> postings;
+    // Disassembly options the lines were made with
+    QString asmOptions;
+    int builtSegments = 0;
+
+    static QStringList tokenize(const QString &text);
+    std::vector<RVA> candidates(const QStringList &tokens) const;
+    QList<Group> scan(const std::vector<RVA> &keys, const std::function<bool(const QString &)> &matches,
+                      int limit) const;
+};
+
+#endif // TEXTINDEX_H
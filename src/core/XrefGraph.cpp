@@ -0,0 +1,315 @@
+#include "core/XrefGraph.h"
+#include "core/Cutter.h"
+
+#include <QHash>
+#include <QObject>
+
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+
+namespace {
+
+struct FunctionSource {
+    RVA offset;
+    QString name;
+    std::vector<std::pair<RVA, RVA>> blocks;
+};
+
+struct RefSource {
+    size_t function;
+    RVA to;
+    char type;
+};
+
+/**
+ * @brief Fill begin, targets and types with the edges grouped by their first node
+ * @param edges (first node, second node, type), sorted
+ */
+void buildRows(const std::vector<std::tuple<int, int, quint8>> &edges, int nodeCount,
+               std::vector<int> &begin, std::vector<int> &targets, std::vector<quint8> &types)
+{
+    begin.assign(static_cast<size_t>(nodeCount) + 1, 0);
+    targets.reserve(edges.size());
+    types.reserve(edges.size());
+    for (const std::tuple<int, int, quint8> &edge : edges) {
+        begin[static_cast<size_t>(std::get<0>(edge)) + 1]++;
+        targets.push_back(std::get<1>(edge));
+        types.push_back(std::get<2>(edge));
+    }
+    for (size_t i = 1; i < begin.size(); i++) {
+        begin[i] += begin[i - 1];
+    }
+}
+
+}
+
+QSharedPointer<const XrefGraph> XrefGraph::build(const std::function<bool()> &interrupted)
+{
+    // Only copied under the lock, everything else is done without holding up the core
+    std::vector<FunctionSource> functions;
+    std::vector<RefSource> refs;
+    {
+        RCoreLocked core = Core()->core();
+        RListIter *it;
+        RListIter *bbIt;
+        RListIter *refIt;
+        RAnalFunction *fcn;
+        RAnalBlock *bb;
+        RAnalRef *ref;
+        CutterRListForeach(core->anal->fcns, it, RAnalFunction, fcn) {
+            if (interrupted && interrupted()) {
+                return QSharedPointer<const XrefGraph>();
+            }
+            FunctionSource function;
+            function.offset = fcn->addr;
+            function.name = QString::fromUtf8(fcn->name);
+            CutterRListForeach(fcn->bbs, bbIt, RAnalBlock, bb) {
+                function.blocks.push_back({ bb->addr, static_cast<RVA>(bb->size) });
+            }
+            RList *fcnRefs = r_anal_fcn_get_refs(core->anal, fcn);
+            CutterRListForeach(fcnRefs, refIt, RAnalRef, ref) {
+                refs.push_back({ functions.size(), ref->addr, static_cast<char>(ref->type) });
+            }
+            r_list_free(fcnRefs);
+            functions.push_back(std::move(function));
+        }
+    }
+
+    QSharedPointer<XrefGraph> graph(new XrefGraph());
+
+    // Function entries win over the blocks of other functions containing them
+    QHash<RVA, size_t> entries;
+    for (size_t i = 0; i < functions.size(); i++) {
+        if (!entries.contains(functions[i].offset)) {
+            entries.insert(functions[i].offset, i);
+        }
+    }
+    std::vector<BlockRange> functionBlocks;
+    for (size_t i = 0; i < functions.size(); i++) {
+        for (const std::pair<RVA, RVA> &block : functions[i].blocks) {
+            functionBlocks.push_back({ block.first, block.first + block.second, static_cast<int>(i) });
+        }
+    }
+    auto byBegin = [](const BlockRange &a, const BlockRange &b) {
+        return a.begin < b.begin;
+    };
+    std::sort(functionBlocks.begin(), functionBlocks.end(), byBegin);
+    // The function containing offset, -1 if none
+    auto functionAt = [&](RVA offset) -> int {
+        auto entry = entries.constFind(offset);
+        if (entry != entries.constEnd()) {
+            return static_cast<int>(entry.value());
+        }
+        auto it = std::upper_bound(functionBlocks.begin(), functionBlocks.end(),
+                                   BlockRange { offset, offset, -1 }, byBegin);
+        if (it != functionBlocks.begin() && offset < std::prev(it)->end) {
+            return std::prev(it)->node;
+        }
+        return -1;
+    };
+
+    // Targets resolved to a function, or the address itself
+    std::vector<int> targetFunctions(refs.size());
+    std::vector<std::pair<RVA, int>> nodes;
+    for (size_t i = 0; i < functions.size(); i++) {
+        nodes.push_back({ functions[i].offset, static_cast<int>(i) });
+    }
+    for (size_t i = 0; i < refs.size(); i++) {
+        targetFunctions[i] = functionAt(refs[i].to);
+        if (targetFunctions[i] < 0) {
+            nodes.push_back({ refs[i].to, -1 });
+        }
+    }
+    if (interrupted && interrupted()) {
+        return QSharedPointer<const XrefGraph>();
+    }
+    // Functions sort before the addresses at the same offset, so they are the ones kept
+    std::sort(nodes.begin(), nodes.end(), [](const std::pair<RVA, int> &a, const std::pair<RVA, int> &b) {
+        return a.first < b.first || (a.first == b.first && a.second > b.second);
+    });
+    nodes.erase(std::unique(nodes.begin(), nodes.end(), [](const std::pair<RVA, int> &a,
+                                                           const std::pair<RVA, int> &b) {
+        return a.first == b.first;
+    }), nodes.end());
+
+    graph->offsets.reserve(nodes.size());
+    graph->names.reserve(nodes.size());
+    graph->functionNodes.reserve(nodes.size());
+    for (const std::pair<RVA, int> &node : nodes) {
+        graph->offsets.push_back(node.first);
+        graph->names.push_back(node.second >= 0 ? functions[static_cast<size_t>(node.second)].name : QString());
+        graph->functionNodes.push_back(node.second >= 0);
+    }
+    auto nodeOf = [&](RVA offset) {
+        return static_cast<int>(std::lower_bound(graph->offsets.begin(), graph->offsets.end(), offset)
+                                - graph->offsets.begin());
+    };
+
+    graph->blocks = functionBlocks;
+    for (BlockRange &block : graph->blocks) {
+        block.node = nodeOf(functions[static_cast<size_t>(block.node)].offset);
+    }
+
+    std::vector<std::tuple<int, int, quint8>> edges;
+    edges.reserve(refs.size());
+    for (size_t i = 0; i < refs.size(); i++) {
+        int from = nodeOf(functions[refs[i].function].offset);
+        int to = targetFunctions[i] >= 0 ? nodeOf(functions[static_cast<size_t>(targetFunctions[i])].offset)
+                                         : nodeOf(refs[i].to);
+        edges.push_back(std::make_tuple(from, to, static_cast<quint8>(edgeType(refs[i].type))));
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    buildRows(edges, graph->nodeCount(), graph->outBegin, graph->outTargets, graph->outTypes);
+
+    for (std::tuple<int, int, quint8> &edge : edges) {
+        std::swap(std::get<0>(edge), std::get<1>(edge));
+    }
+    std::sort(edges.begin(), edges.end());
+    buildRows(edges, graph->nodeCount(), graph->inBegin, graph->inSources, graph->inTypes);
+    return graph;
+}
+
+int XrefGraph::nodeAt(RVA offset) const
+{
+    auto node = std::lower_bound(offsets.begin(), offsets.end(), offset);
+    if (node != offsets.end() && *node == offset) {
+        return static_cast<int>(node - offsets.begin());
+    }
+    auto it = std::upper_bound(blocks.begin(), blocks.end(), offset, [](RVA offset, const BlockRange &block) {
+        return offset < block.begin;
+    });
+    if (it != blocks.begin() && offset < std::prev(it)->end) {
+        return std::prev(it)->node;
+    }
+    return -1;
+}
+
+QVector<XrefGraph::Edge> XrefGraph::edges(int node, Direction direction, int types) const
+{
+    const bool incoming = direction == Direction::Incoming;
+    const std::vector<int> &begin = incoming ? inBegin : outBegin;
+    const std::vector<int> &targets = incoming ? inSources : outTargets;
+    const std::vector<quint8> &edgeTypes = incoming ? inTypes : outTypes;
+
+    QVector<Edge> result;
+    if (node < 0 || node >= nodeCount()) {
+        return result;
+    }
+    for (int i = begin[static_cast<size_t>(node)]; i < begin[static_cast<size_t>(node) + 1]; i++) {
+        if (edgeTypes[static_cast<size_t>(i)] & types) {
+            result.append({ targets[static_cast<size_t>(i)], static_cast<EdgeType>(edgeTypes[static_cast<size_t>(i)]) });
+        }
+    }
+    return result;
+}
+
+QVector<XrefGraph::Reached> XrefGraph::neighbourhood(int node, Direction direction, int maxDistance,
+                                                     int types) const
+{
+    return walk(node, direction, maxDistance, types, types);
+}
+
+QVector<XrefGraph::Reached> XrefGraph::walk(int node, Direction direction, int maxDistance,
+                                            int firstTypes, int types) const
+{
+    const bool incoming = direction == Direction::Incoming;
+    const std::vector<int> &begin = incoming ? inBegin : outBegin;
+    const std::vector<int> &targets = incoming ? inSources : outTargets;
+    const std::vector<quint8> &edgeTypes = incoming ? inTypes : outTypes;
+
+    // The result is the queue of the walk
+    QVector<Reached> reached;
+    if (node < 0 || node >= nodeCount()) {
+        return reached;
+    }
+    std::vector<char> seen(offsets.size(), false);
+    reached.append({ node, 0, -1 });
+    seen[static_cast<size_t>(node)] = true;
+    for (int next = 0; next < reached.size(); next++) {
+        Reached current = reached.at(next);
+        if (maxDistance > 0 && current.distance >= maxDistance) {
+            break;
+        }
+        for (int i = begin[static_cast<size_t>(current.node)]; i < begin[static_cast<size_t>(current.node) + 1]; i++) {
+            int target = targets[static_cast<size_t>(i)];
+            int allowed = current.distance == 0 ? firstTypes : types;
+            if (!(edgeTypes[static_cast<size_t>(i)] & allowed) || seen[static_cast<size_t>(target)]) {
+                continue;
+            }
+            seen[static_cast<size_t>(target)] = true;
+            reached.append({ target, current.distance + 1, current.node });
+        }
+    }
+    return reached;
+}
+
+QVector<int> XrefGraph::path(int from, int to, int types) const
+{
+    if (from < 0 || from >= nodeCount() || to < 0 || to >= nodeCount()) {
+        return QVector<int>();
+    }
+    // Same walk as walk(), stopping as soon as to is reached
+    std::vector<int> previous(offsets.size(), -2);
+    std::vector<int> queue = { from };
+    previous[static_cast<size_t>(from)] = -1;
+    for (size_t next = 0; next < queue.size() && previous[static_cast<size_t>(to)] == -2; next++) {
+        int node = queue[next];
+        for (int i = outBegin[static_cast<size_t>(node)]; i < outBegin[static_cast<size_t>(node) + 1]; i++) {
+            int target = outTargets[static_cast<size_t>(i)];
+            if (!(outTypes[static_cast<size_t>(i)] & types) || previous[static_cast<size_t>(target)] != -2) {
+                continue;
+            }
+            previous[static_cast<size_t>(target)] = node;
+            queue.push_back(target);
+        }
+    }
+
+    QVector<int> result;
+    if (previous[static_cast<size_t>(to)] == -2) {
+        return result;
+    }
+    for (int node = to; node != -1; node = previous[static_cast<size_t>(node)]) {
+        result.prepend(node);
+    }
+    return result;
+}
+
+QVector<XrefGraph::Reached> XrefGraph::transitiveCallers(int node, int maxDistance) const
+{
+    // Whatever references node, e.g. the address of an import in a table, calls it
+    QVector<Reached> callers = walk(node, Direction::Incoming, maxDistance, AllEdges, Call);
+    if (!callers.isEmpty()) {
+        callers.removeFirst();
+    }
+    return callers;
+}
+
+XrefGraph::EdgeType XrefGraph::edgeType(char r2Type)
+{
+    switch (r2Type) {
+    case R_ANAL_REF_TYPE_CALL:
+        return Call;
+    case R_ANAL_REF_TYPE_DATA:
+        return Data;
+    case R_ANAL_REF_TYPE_STRING:
+        return String;
+    default:
+        return Code;
+    }
+}
+
+QString XrefGraph::edgeTypeName(EdgeType type)
+{
+    switch (type) {
+    case Call:
+        return QObject::tr("Call");
+    case Data:
+        return QObject::tr("Data");
+    case String:
+        return QObject::tr("String");
+    default:
+        return QObject::tr("Code");
+    }
+}
@@ -0,0 +1,136 @@
+#ifndef XREFGRAPH_H
+#define XREFGRAPH_H
+
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+#include <vector>
+
+#include "core/CutterCommon.h"
+
+/**
+ * @brief Graph of the code and data references between the analysed functions, for queries
+ * that go further than the one hop of axtj and axfj.
+ *
+ * Nodes are the functions and the referenced addresses outside of all functions, e.g. data or
+ * imports without a stub, sorted by address. A reference from or to anywhere inside a function
+ * is an edge of the function, references of the same type between the same nodes are merged.
+ * The edges are stored as compressed sparse rows in both directions, so the callers and callees
+ * of a node are contiguous ranges and walking the graph doesn't allocate per node.
+ *
+ * The graph is immutable once built and can be shared between threads.
+ */
+class XrefGraph
+{
+public:
+    enum EdgeType {
+        Call = 1 << 0,
+        Code = 1 << 1,
+        Data = 1 << 2,
+        String = 1 << 3,
+        AllEdges = Call | Code | Data | String
+    };
+
+    enum class Direction { Incoming, Outgoing };
+
+    struct Edge {
+        int node;
+        EdgeType type;
+    };
+
+    struct Reached {
+        int node;
+        // Number of edges from the start
+        int distance;
+        // Node before this one on a shortest path from the start, -1 for the start
+        int previous;
+    };
+
+    /**
+     * @brief Collect the references of all functions of the core.
+     * @return null if interrupted returned true
+     */
+    static QSharedPointer<const XrefGraph> build(const std::function<bool()> &interrupted = nullptr);
+
+    int nodeCount() const                       { return static_cast<int>(offsets.size()); }
+    int edgeCount() const                       { return static_cast<int>(outTargets.size()); }
+
+    RVA nodeOffset(int node) const              { return offsets[node]; }
+    /**
+     * @return name of the function, empty for addresses outside of functions
+     */
+    QString nodeName(int node) const            { return names[node]; }
+    bool isFunction(int node) const             { return functionNodes[node] != 0; }
+
+    /**
+     * @return node of the function containing offset, or of the address itself outside of
+     * functions, -1 if nothing references it
+     */
+    int nodeAt(RVA offset) const;
+
+    /**
+     * @return direct callers of node, or the nodes referencing it with the other types
+     */
+    QVector<Edge> callers(int node, int types = Call) const { return edges(node, Direction::Incoming, types); }
+    /**
+     * @return direct callees of node, or the nodes it references with the other types
+     */
+    QVector<Edge> callees(int node, int types = Call) const { return edges(node, Direction::Outgoing, types); }
+    QVector<Edge> edges(int node, Direction direction, int types = AllEdges) const;
+
+    /**
+     * @brief Breadth-first walk from node along the edges of types. All queries taking nodes
+     * return nothing for -1.
+     * @param maxDistance stop this many edges away from node, 0 for no limit
+     * @return the nodes reached, ordered by distance, starting with node itself
+     */
+    QVector<Reached> neighbourhood(int node, Direction direction, int maxDistance = 0,
+                                   int types = AllEdges) const;
+
+    /**
+     * @return nodes of a shortest path from one node to the other along the edges of types,
+     * both included, empty if to can't be reached
+     */
+    QVector<int> path(int from, int to, int types = Call | Code) const;
+    bool reachable(int from, int to, int types = Call | Code) const { return !path(from, to, types).isEmpty(); }
+
+    /**
+     * @return the functions that reference node, then those that call them, and so on,
+     * excluding node itself
+     */
+    QVector<Reached> transitiveCallers(int node, int maxDistance = 0) const;
+
+    static EdgeType edgeType(char r2Type);
+    static QString edgeTypeName(EdgeType type);
+
+private:
+    // Sorted, node ids are the indexes
+    std::vector<RVA> offsets;
+    std::vector<QString> names;
+    std::vector<char> functionNodes;
+
+    // Basic blocks of the functions sorted by begin, to find the function at an address
+    struct BlockRange {
+        RVA begin;
+        RVA end;
+        int node;
+    };
+    std::vector<BlockRange> blocks;
+
+    // Edges of node i are [outBegin[i], outBegin[i + 1]) in outTargets and outTypes
+    std::vector<int> outBegin;
+    std::vector<int> outTargets;
+    std::vector<quint8> outTypes;
+    std::vector<int> inBegin;
+    std::vector<int> inSources;
+    std::vector<quint8> inTypes;
+
+    /**
+     * @brief Breadth-first walk, along the edges of firstTypes from node and of types after that
+     */
+    QVector<Reached> walk(int node, Direction direction, int maxDistance, int firstTypes, int types) const;
+};
+
+#endif // XREFGRAPH_H
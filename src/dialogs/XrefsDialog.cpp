@@ -5,8 +5,10 @@
 #include "common/Helpers.h"
 
 #include "core/MainWindow.h"
+#include "core/XrefGraph.h"
 
 #include <QJsonArray>
+#include <QHash>
 
 XrefsDialog::XrefsDialog(QWidget *parent) :
     QDialog(parent),
@@ -31,6 +33,7 @@ XrefsDialog::XrefsDialog(QWidget *parent) :
     connect(ui->previewTextEdit, SIGNAL(cursorPositionChanged()), this, SLOT(highlightCurrentLine()));
     connect(Config(), SIGNAL(fontsUpdated()), this, SLOT(setupPreviewFont()));
     connect(Config(), SIGNAL(colorsUpdated()), this, SLOT(setupPreviewColors()));
+    connect(Core()->getDataStore(), &AnalysisDataStore::dataReady, this, &XrefsDialog::onDataReady);
 }
 
 XrefsDialog::~XrefsDialog() { }
@@ -52,8 +55,27 @@ void XrefsDialog::fillRefs(QList<XrefDescription> refs, QList<XrefDescription> x
     qhelpers::adjustColumns(ui->fromTreeWidget, 0);
 
     // Fill Xrefs
+    xrefsTo = xrefs;
+    if (ui->transitiveCheckBox->isChecked()) {
+        fillTransitiveCallers();
+    } else {
+        fillXrefsTo();
+    }
+
+    // try to select first item from refs or xrefs
+    if (!qhelpers::selectFirstItem(ui->toTreeWidget)) {
+        qhelpers::selectFirstItem(ui->fromTreeWidget);
+    }
+
+}
+
+void XrefsDialog::fillXrefsTo()
+{
+    waitingForGraph = false;
+    updateLabels(func_name);
     ui->toTreeWidget->clear();
-    for (const auto &xref : xrefs) {
+    ui->toTreeWidget->setHeaderLabels({ tr("Address"), tr("Code"), tr("Type") });
+    for (const auto &xref : xrefsTo) {
         auto *tempItem = new QTreeWidgetItem();
         tempItem->setText(0, xref.from_str);
         tempItem->setText(1, Core()->disassembleSingleInstruction(xref.from));
@@ -64,12 +86,81 @@ void XrefsDialog::fillRefs(QList<XrefDescription> refs, QList<XrefDescription> x
 
     // Adjust columns to content
     qhelpers::adjustColumns(ui->toTreeWidget, 0);
+}
 
-    // try to select first item from refs or xrefs
-    if (!qhelpers::selectFirstItem(ui->toTreeWidget)) {
-        qhelpers::selectFirstItem(ui->fromTreeWidget);
+void XrefsDialog::fillTransitiveCallers()
+{
+    ui->toTreeWidget->clear();
+    ui->toTreeWidget->setHeaderLabels({ tr("Function"), tr("Path"), tr("Depth") });
+
+    AnalysisDataStore *store = Core()->getDataStore();
+    QSharedPointer<const XrefGraph> graph = store->getXrefGraph();
+    if (!graph || !store->isCurrent(AnalysisDataStore::Kind::Xrefs)) {
+        // Continued by onDataReady
+        waitingForGraph = true;
+        ui->label_xTo->setText(tr("Building the cross-reference graph..."));
+        store->request(AnalysisDataStore::Kind::Xrefs);
+        return;
     }
+    waitingForGraph = false;
+
+    int node = graph->nodeAt(addr);
+    QVector<XrefGraph::Reached> callers = graph->transitiveCallers(node, ui->depthSpinBox->value());
+    ui->label_xTo->setText(tr("%n function(s) reaching %1:", nullptr, callers.size()).arg(func_name));
+
+    auto nodeName = [&graph](int caller) {
+        QString name = graph->nodeName(caller);
+        return name.isEmpty() ? RAddressString(graph->nodeOffset(caller)) : name;
+    };
+    // The path of a caller continues with the path of the node it was reached from
+    QHash<int, QString> paths;
+    paths.insert(node, func_name);
+    QList<QTreeWidgetItem *> items;
+    for (const XrefGraph::Reached &caller : callers) {
+        QString path = nodeName(caller.node) + QStringLiteral(" -> ") + paths.value(caller.previous);
+        paths.insert(caller.node, path);
+
+        XrefDescription xref;
+        xref.from = graph->nodeOffset(caller.node);
+        xref.from_str = nodeName(caller.node);
+        xref.to = addr;
+        xref.to_str = func_name;
+        xref.type = QString(QChar(R_ANAL_REF_TYPE_CALL));
 
+        auto *tempItem = new QTreeWidgetItem();
+        tempItem->setText(0, xref.from_str);
+        tempItem->setText(1, path);
+        tempItem->setText(2, QString::number(caller.distance));
+        tempItem->setData(0, Qt::UserRole, QVariant::fromValue(xref));
+        items << tempItem;
+    }
+    ui->toTreeWidget->addTopLevelItems(items);
+    qhelpers::adjustColumns(ui->toTreeWidget, 0);
+}
+
+void XrefsDialog::on_transitiveCheckBox_toggled(bool checked)
+{
+    ui->depthSpinBox->setEnabled(checked);
+    if (checked) {
+        fillTransitiveCallers();
+    } else {
+        fillXrefsTo();
+    }
+}
+
+void XrefsDialog::on_depthSpinBox_valueChanged(int value)
+{
+    Q_UNUSED(value);
+    if (ui->transitiveCheckBox->isChecked()) {
+        fillTransitiveCallers();
+    }
+}
+
+void XrefsDialog::onDataReady(AnalysisDataStore::Kind kind)
+{
+    if (kind == AnalysisDataStore::Kind::Xrefs && waitingForGraph) {
+        fillTransitiveCallers();
+    }
 }
 
 void XrefsDialog::on_fromTreeWidget_itemDoubleClicked(QTreeWidgetItem *item, int column)
@@ -177,6 +268,8 @@ void XrefsDialog::fillRefsForAddress(RVA addr, QString name, bool whole_function
     tempConfig.set("scr.html", false);
     tempConfig.set("scr.color", COLOR_MODE_DISABLED);
 
+    this->addr = addr;
+    func_name = name;
     setWindowTitle(tr("X-Refs for %1").arg(name));
     updateLabels(name);
 
@@ -6,6 +6,7 @@
 #include <memory>
 #include "common/Highlighter.h"
 #include "core/Cutter.h"
+#include "core/AnalysisDataStore.h"
 
 class MainWindow;
 
@@ -37,13 +38,22 @@ private slots:
 
     void on_toTreeWidget_itemSelectionChanged();
 
+    void on_transitiveCheckBox_toggled(bool checked);
+    void on_depthSpinBox_valueChanged(int value);
+    void onDataReady(AnalysisDataStore::Kind kind);
+
 private:
     RVA addr;
     QString func_name;
+    QList<XrefDescription> xrefsTo;
+    // Transitive callers are shown once the graph is current
+    bool waitingForGraph = false;
 
     std::unique_ptr<Ui::XrefsDialog> ui;
 
     void fillRefs(QList<XrefDescription> refs, QList<XrefDescription> xrefs);
+    void fillXrefsTo();
+    void fillTransitiveCallers();
     void updateLabels(QString name);
     void updatePreview(RVA addr);
 
@@ -0,0 +1,497 @@
+#include "CallGraphView.h"
+
+#include "common/Configuration.h"
+
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QToolTip>
+#include <QFontMetricsF>
+#include <QShortcut>
+
+#include <cmath>
+#include <functional>
+
+// Side length of a cell of the spatial index, larger than most blocks
+static const int cellSize = 512;
+// Below this scale individual functions are replaced by clusters
+static const qreal clusterScale = 0.15;
+// Below this scale function names are not drawn
+static const qreal textScale = 0.4;
+// Minimum on screen size of a cluster
+static const int minClusterPixels = 48;
+
+CallGraphView::CallGraphView(QWidget *parent)
+    : GraphView(parent)
+{
+    connect(Config(), SIGNAL(colorsUpdated()), this, SLOT(colorsUpdatedSlot()));
+    connect(Config(), SIGNAL(fontsUpdated()), this, SLOT(fontsUpdatedSlot()));
+    connect(Core(), SIGNAL(seekChanged(RVA)), this, SLOT(onSeekChanged(RVA)));
+
+    QShortcut *shortcut_zoom_in = new QShortcut(QKeySequence(Qt::Key_Plus), this);
+    shortcut_zoom_in->setContext(Qt::WidgetShortcut);
+    connect(shortcut_zoom_in, &QShortcut::activated, this, std::bind(&CallGraphView::zoom, this, QPointF(0.5, 0.5), 1));
+    QShortcut *shortcut_zoom_out = new QShortcut(QKeySequence(Qt::Key_Minus), this);
+    shortcut_zoom_out->setContext(Qt::WidgetShortcut);
+    connect(shortcut_zoom_out, &QShortcut::activated, this, std::bind(&CallGraphView::zoom, this, QPointF(0.5, 0.5), -1));
+    QShortcut *shortcut_zoom_reset = new QShortcut(QKeySequence(Qt::Key_Equal), this);
+    shortcut_zoom_reset->setContext(Qt::WidgetShortcut);
+    connect(shortcut_zoom_reset, SIGNAL(activated()), this, SLOT(zoomReset()));
+    QShortcut *shortcut_zoom_fit = new QShortcut(QKeySequence(Qt::Key_0), this);
+    shortcut_zoom_fit->setContext(Qt::WidgetShortcut);
+    connect(shortcut_zoom_fit, SIGNAL(activated()), this, SLOT(zoomToFit()));
+
+    block_padding = 8;
+    colorsUpdatedSlot();
+    fontsUpdatedSlot();
+}
+
+CallGraphView::~CallGraphView()
+{
+}
+
+void CallGraphView::setGraph(CallGraphLayoutResult result)
+{
+    bool firstGraph = blocks.empty();
+    blocks = std::move(result.blocks);
+    nodes = std::move(result.nodes);
+    width = result.width;
+    height = result.height;
+    buildIndex();
+
+    onSeekChanged(Core()->getOffset());
+    if (firstGraph) {
+        if (blocks.find(currentFunction) != blocks.end()) {
+            current_scale = 1.0;
+            showFunction(currentFunction);
+        } else {
+            zoomToFit();
+        }
+    }
+    viewport()->update();
+}
+
+void CallGraphView::clearGraph()
+{
+    blocks.clear();
+    nodes.clear();
+    cells.clear();
+    callers.clear();
+    clusterLevels.clear();
+    maxBlockWidth = 0;
+    maxBlockHeight = 0;
+    width = 0;
+    height = 0;
+    viewport()->update();
+}
+
+void CallGraphView::showFunction(RVA addr)
+{
+    auto it = blocks.find(addr);
+    if (it != blocks.end()) {
+        showBlock(it->second);
+    }
+}
+
+void CallGraphView::buildIndex()
+{
+    cells.clear();
+    callers.clear();
+    clusterLevels.clear();
+    maxBlockWidth = 0;
+    maxBlockHeight = 0;
+    for (auto &blockIt : blocks) {
+        GraphBlock &block = blockIt.second;
+        cells[cellKey(block.x / cellSize, block.y / cellSize)].push_back(block.entry);
+        maxBlockWidth = std::max(maxBlockWidth, block.width);
+        maxBlockHeight = std::max(maxBlockHeight, block.height);
+        for (const GraphEdge &edge : block.edges) {
+            callers[edge.target].push_back(block.entry);
+        }
+    }
+}
+
+std::vector<GraphView::GraphBlock *> CallGraphView::blocksIn(const QRectF &rect)
+{
+    std::vector<GraphBlock *> ret;
+    // Blocks are indexed by their top left corner, so also look at the cells left and above
+    // as far as the largest block reaches
+    int spanCols = (maxBlockWidth + cellSize - 1) / cellSize;
+    int spanRows = (maxBlockHeight + cellSize - 1) / cellSize;
+    int firstCol = std::max(0, int(std::floor(rect.left() / cellSize)) - spanCols);
+    int firstRow = std::max(0, int(std::floor(rect.top() / cellSize)) - spanRows);
+    int lastCol = int(std::floor(rect.right() / cellSize));
+    int lastRow = int(std::floor(rect.bottom() / cellSize));
+    if (lastCol < firstCol || lastRow < firstRow) {
+        return ret;
+    }
+
+    auto collect = [&](const std::vector<ut64> &ids) {
+        for (ut64 id : ids) {
+            GraphBlock &block = blocks[id];
+            if (rect.intersects(QRectF(block.x, block.y, block.width, block.height))) {
+                ret.push_back(&block);
+            }
+        }
+    };
+
+    ut64 cellCount = ut64(lastCol - firstCol + 1) * ut64(lastRow - firstRow + 1);
+    if (cellCount > cells.size()) {
+        for (auto &cellIt : cells) {
+            int col = int(cellIt.first >> 32);
+            int row = int(cellIt.first & 0xffffffff);
+            if (col >= firstCol && col <= lastCol && row >= firstRow && row <= lastRow) {
+                collect(cellIt.second);
+            }
+        }
+        return ret;
+    }
+    for (int col = firstCol; col <= lastCol; col++) {
+        for (int row = firstRow; row <= lastRow; row++) {
+            auto cellIt = cells.find(cellKey(col, row));
+            if (cellIt != cells.end()) {
+                collect(cellIt->second);
+            }
+        }
+    }
+    return ret;
+}
+
+GraphView::GraphBlock *CallGraphView::blockAt(const QPointF &pos)
+{
+    auto found = blocksIn(QRectF(pos, QSizeF(1, 1)));
+    return found.empty() ? nullptr : found.front();
+}
+
+int CallGraphView::clusterFactor() const
+{
+    if (current_scale >= clusterScale) {
+        return 0;
+    }
+    int factor = 1;
+    while (cellSize * factor * current_scale < minClusterPixels) {
+        factor *= 2;
+    }
+    return factor;
+}
+
+const CallGraphView::ClusterLevel &CallGraphView::clusterLevel(int factor)
+{
+    auto levelIt = clusterLevels.find(factor);
+    if (levelIt != clusterLevels.end()) {
+        return levelIt->second;
+    }
+
+    ClusterLevel &level = clusterLevels[factor];
+    int clusterSize = cellSize * factor;
+    auto clusterOf = [clusterSize](const GraphBlock &block) {
+        return cellKey(block.x / clusterSize, block.y / clusterSize);
+    };
+
+    QHash<QPair<ut64, ut64>, int> edgeCounts;
+    for (auto &blockIt : blocks) {
+        const GraphBlock &block = blockIt.second;
+        ut64 key = clusterOf(block);
+        Cluster &cluster = level.clusters[key];
+        QRectF rect(block.x, block.y, block.width, block.height);
+        cluster.rect = cluster.count ? cluster.rect.united(rect) : rect;
+        cluster.count++;
+
+        for (const GraphEdge &edge : block.edges) {
+            auto targetIt = blocks.find(edge.target);
+            if (targetIt == blocks.end()) {
+                continue;
+            }
+            ut64 targetKey = clusterOf(targetIt->second);
+            if (targetKey != key) {
+                edgeCounts[qMakePair(key, targetKey)]++;
+            }
+        }
+    }
+
+    level.edges.reserve(edgeCounts.size());
+    for (auto it = edgeCounts.constBegin(); it != edgeCounts.constEnd(); ++it) {
+        level.edges.push_back({it.key().first, it.key().second, it.value()});
+    }
+    return level;
+}
+
+void CallGraphView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter p(viewport());
+    p.fillRect(viewport()->rect(), backgroundColor);
+    if (blocks.empty()) {
+        return;
+    }
+
+    QRectF visible(offset.x(), offset.y(),
+                   viewport()->width() / current_scale, viewport()->height() / current_scale);
+    p.scale(current_scale, current_scale);
+    p.translate(-offset.x(), -offset.y());
+
+    if (clusterFactor()) {
+        drawClusters(p, visible);
+    } else {
+        p.setRenderHint(QPainter::Antialiasing);
+        drawNodes(p, visible);
+    }
+}
+
+void CallGraphView::drawEdge(QPainter &p, const QPointF &from, const QPointF &to)
+{
+    p.drawLine(from, to);
+    qreal angle = std::atan2(to.y() - from.y(), to.x() - from.x());
+    const qreal arrowSize = 8.0;
+    QPolygonF arrow;
+    arrow << to;
+    arrow << to - QPointF(std::cos(angle - 0.4), std::sin(angle - 0.4)) * arrowSize;
+    arrow << to - QPointF(std::cos(angle + 0.4), std::sin(angle + 0.4)) * arrowSize;
+    p.drawConvexPolygon(arrow);
+}
+
+void CallGraphView::drawNodes(QPainter &p, const QRectF &visible)
+{
+    std::vector<GraphBlock *> visibleBlocks = blocksIn(visible);
+
+    QPen edgePen(edgeColor);
+    edgePen.setCosmetic(true);
+    p.setPen(edgePen);
+    p.setBrush(edgeColor);
+    auto blockRect = [](const GraphBlock &block) {
+        return QRectF(block.x, block.y, block.width, block.height);
+    };
+    for (GraphBlock *block : visibleBlocks) {
+        for (const GraphEdge &edge : block->edges) {
+            if (edge.polyline.size() >= 2) {
+                drawEdge(p, edge.polyline.first(), edge.polyline.last());
+            }
+        }
+        // Incoming edges from callers outside of the view, the others are drawn above
+        auto callersIt = callers.find(block->entry);
+        if (callersIt == callers.end()) {
+            continue;
+        }
+        for (ut64 callerAddr : callersIt->second) {
+            const GraphBlock &caller = blocks[callerAddr];
+            if (visible.intersects(blockRect(caller))) {
+                continue;
+            }
+            drawEdge(p, QPointF(caller.x + caller.width / 2, caller.y + caller.height),
+                     QPointF(block->x + block->width / 2, block->y));
+        }
+    }
+
+    QPen borderPen(borderColor);
+    borderPen.setCosmetic(true);
+    bool drawText = current_scale >= textScale;
+    QFontMetricsF metrics(font());
+    for (GraphBlock *block : visibleBlocks) {
+        QRectF rect = blockRect(*block);
+        p.setPen(borderPen);
+        p.setBrush(block->entry == currentFunction ? currentColor : nodeColor);
+        p.drawRect(rect);
+        if (!drawText) {
+            continue;
+        }
+        p.setPen(textColor);
+        QRectF textRect = rect.adjusted(block_padding, block_padding, -block_padding,
+                                        -block_padding);
+        QString name = metrics.elidedText(nodes[block->entry].name, Qt::ElideRight,
+                                          textRect.width() + 1);
+        p.drawText(QPointF(textRect.left(), textRect.top() + baseline), name);
+    }
+}
+
+void CallGraphView::drawClusters(QPainter &p, const QRectF &visible)
+{
+    const ClusterLevel &level = clusterLevel(clusterFactor());
+
+    QColor edgeLineColor = edgeColor;
+    edgeLineColor.setAlpha(120);
+    QPen edgePen(edgeLineColor);
+    edgePen.setCosmetic(true);
+    for (const ClusterEdge &edge : level.edges) {
+        QPointF from = level.clusters[edge.from].rect.center();
+        QPointF to = level.clusters[edge.to].rect.center();
+        if (!visible.intersects(QRectF(from, to).normalized().adjusted(-1, -1, 1, 1))) {
+            continue;
+        }
+        edgePen.setWidthF(std::min(1.0 + std::log2(qreal(edge.count)), 6.0));
+        p.setPen(edgePen);
+        p.drawLine(from, to);
+    }
+
+    QPen borderPen(borderColor);
+    borderPen.setCosmetic(true);
+    p.setPen(borderPen);
+    std::vector<std::pair<QRectF, int>> labels;
+    for (auto it = level.clusters.constBegin(); it != level.clusters.constEnd(); ++it) {
+        const Cluster &cluster = it.value();
+        if (!visible.intersects(cluster.rect)) {
+            continue;
+        }
+        QColor fill = clusterColor;
+        fill.setAlpha(std::min(255, 60 + int(30 * std::log2(qreal(cluster.count) + 1))));
+        p.setBrush(fill);
+        p.drawRect(cluster.rect);
+        labels.emplace_back(cluster.rect, cluster.count);
+    }
+
+    // Counts are drawn untransformed so that they stay readable
+    p.resetTransform();
+    p.setPen(textColor);
+    QFontMetricsF metrics(font());
+    for (const auto &label : labels) {
+        QRectF rect((label.first.topLeft() - offset) * current_scale,
+                    label.first.size() * current_scale);
+        QString text = QString::number(label.second);
+        if (rect.width() < metrics.width(text) || rect.height() < charHeight) {
+            continue;
+        }
+        p.drawText(rect, Qt::AlignCenter, text);
+    }
+}
+
+void CallGraphView::zoom(QPointF mouseRelativePos, double velocity)
+{
+    mouseRelativePos.rx() *= size().width();
+    mouseRelativePos.ry() *= size().height();
+    mouseRelativePos /= current_scale;
+
+    auto globalMouse = mouseRelativePos + offset;
+    mouseRelativePos *= current_scale;
+    qreal fitScale = 1.0;
+    if (width > 0 && height > 0) {
+        fitScale = std::min(qreal(viewport()->width()) / width,
+                            qreal(viewport()->height()) / height);
+    }
+    current_scale *= std::pow(1.25, velocity);
+    current_scale = std::max(current_scale, std::min(0.3, fitScale / 2));
+    current_scale = std::min(current_scale, 3.0);
+    mouseRelativePos /= current_scale;
+
+    // Adjusting offset, so that zooming will be approaching to the cursor.
+    offset = globalMouse.toPoint() - mouseRelativePos.toPoint();
+
+    viewport()->update();
+}
+
+void CallGraphView::zoomReset()
+{
+    current_scale = 1.0;
+    viewport()->update();
+}
+
+void CallGraphView::zoomToFit()
+{
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    current_scale = std::min(qreal(1.0), std::min(qreal(viewport()->width()) / width,
+                                                  qreal(viewport()->height()) / height));
+    center();
+    viewport()->update();
+}
+
+void CallGraphView::wheelEvent(QWheelEvent *event)
+{
+    // when CTRL is pressed, we zoom in/out with mouse wheel
+    if (Qt::ControlModifier == event->modifiers()) {
+        const QPoint numDegrees = event->angleDelta() / 8;
+        if (!numDegrees.isNull()) {
+            int numSteps = numDegrees.y() / 15;
+
+            QPointF relativeMousePos = event->pos();
+            relativeMousePos.rx() /= size().width();
+            relativeMousePos.ry() /= size().height();
+
+            zoom(relativeMousePos, numSteps);
+        }
+        event->accept();
+    } else {
+        GraphView::wheelEvent(event);
+    }
+}
+
+bool CallGraphView::helpEvent(QHelpEvent *event)
+{
+    if (clusterFactor()) {
+        return false;
+    }
+    QPointF pos = QPointF(event->pos()) / current_scale + offset;
+    GraphBlock *block = blockAt(pos);
+    if (!block) {
+        return false;
+    }
+    const CallGraphNodeDescription &node = nodes[block->entry];
+    auto callersIt = callers.find(block->entry);
+    int callerCount = callersIt != callers.end() ? int(callersIt->second.size()) : 0;
+    QToolTip::showText(event->globalPos(),
+                       QString("<b>%1</b><br>%2<br>").arg(node.name.toHtmlEscaped(),
+                                                          RAddressString(node.offset))
+                       + tr("Size: %1").arg(RSizeString(node.size)) + "<br>"
+                       + tr("Calls: %1").arg(node.callees.size()) + "<br>"
+                       + tr("Called by: %1").arg(callerCount), this);
+    return true;
+}
+
+void CallGraphView::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    if (clusterFactor()) {
+        // Zoom into the clicked cluster
+        QPointF relativePos = event->pos();
+        relativePos.rx() /= size().width();
+        relativePos.ry() /= size().height();
+        zoom(relativePos, std::ceil(std::log(clusterScale / current_scale) / std::log(1.25)));
+        return;
+    }
+    QPointF pos = QPointF(event->pos()) / current_scale + offset;
+    GraphBlock *block = blockAt(pos);
+    if (block) {
+        Core()->seek(block->entry);
+    }
+}
+
+void CallGraphView::blockClicked(GraphView::GraphBlock &block, QMouseEvent *event, QPoint pos)
+{
+    Q_UNUSED(block);
+    Q_UNUSED(event);
+    Q_UNUSED(pos);
+}
+
+void CallGraphView::blockTransitionedTo(GraphView::GraphBlock *to)
+{
+    Q_UNUSED(to);
+}
+
+void CallGraphView::onSeekChanged(RVA addr)
+{
+    RAnalFunction *fcn = Core()->functionAt(addr);
+    RVA function = fcn ? fcn->addr : RVA_INVALID;
+    if (function != currentFunction) {
+        currentFunction = function;
+        viewport()->update();
+    }
+}
+
+void CallGraphView::colorsUpdatedSlot()
+{
+    backgroundColor = ConfigColor("gui.background");
+    nodeColor = ConfigColor("gui.alt_background");
+    borderColor = ConfigColor("gui.border");
+    textColor = ConfigColor("fname");
+    edgeColor = ConfigColor("graph.trufae");
+    currentColor = ConfigColor("highlightPC");
+    clusterColor = ConfigColor("gui.overview.node");
+    viewport()->update();
+}
+
+void CallGraphView::fontsUpdatedSlot()
+{
+    setFont(Config()->getFont());
+    QFontMetricsF metrics(font());
+    baseline = int(metrics.ascent());
+    charWidth = metrics.width('X');
+    charHeight = static_cast<int>(metrics.height());
+    emit fontChanged();
+}
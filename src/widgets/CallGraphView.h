@@ -0,0 +1,122 @@
+#ifndef CALLGRAPHVIEW_H
+#define CALLGRAPHVIEW_H
+
+#include <QWidget>
+#include <QPainter>
+#include <QHash>
+
+#include <map>
+
+#include "widgets/GraphView.h"
+#include "common/CallGraphTask.h"
+
+/**
+ * @brief Whole program call graph, one block per function.
+ *
+ * Blocks are looked up through a uniform grid over the graph so that painting and hit testing
+ * only touch the visible part of the graph. When zoomed out, grid cells are merged into
+ * clusters and drawn with aggregated edges instead of individual functions.
+ */
+class CallGraphView : public GraphView
+{
+    Q_OBJECT
+
+public:
+    explicit CallGraphView(QWidget *parent);
+    ~CallGraphView() override;
+
+    void setGraph(CallGraphLayoutResult result);
+    void clearGraph();
+    bool isEmpty() const                        { return blocks.empty(); }
+
+    qreal getCharWidth() const                  { return charWidth; }
+    int getCharHeight() const                   { return charHeight; }
+    int getBlockPadding() const                 { return block_padding; }
+
+    /**
+     * @brief Center the view on the block of the function at addr, if there is one.
+     */
+    void showFunction(RVA addr);
+
+public slots:
+    void zoom(QPointF mouseRelativePos, double velocity);
+    void zoomReset();
+    /**
+     * @brief Scale the view so that the whole graph is visible.
+     */
+    void zoomToFit();
+
+signals:
+    void fontChanged();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    bool helpEvent(QHelpEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+    void blockClicked(GraphView::GraphBlock &block, QMouseEvent *event, QPoint pos) override;
+    void blockTransitionedTo(GraphView::GraphBlock *to) override;
+
+private slots:
+    void colorsUpdatedSlot();
+    void fontsUpdatedSlot();
+    void onSeekChanged(RVA addr);
+
+private:
+    struct Cluster {
+        QRectF rect;
+        int count = 0;
+    };
+
+    struct ClusterEdge {
+        ut64 from;
+        ut64 to;
+        int count;
+    };
+
+    struct ClusterLevel {
+        QHash<ut64, Cluster> clusters;
+        std::vector<ClusterEdge> edges;
+    };
+
+    static ut64 cellKey(int col, int row)
+    {
+        return (ut64(ut32(col)) << 32) | ut32(row);
+    }
+
+    void buildIndex();
+    int clusterFactor() const;
+    const ClusterLevel &clusterLevel(int factor);
+    GraphBlock *blockAt(const QPointF &pos);
+    std::vector<GraphBlock *> blocksIn(const QRectF &rect);
+
+    void drawNodes(QPainter &p, const QRectF &visible);
+    void drawClusters(QPainter &p, const QRectF &visible);
+    void drawEdge(QPainter &p, const QPointF &from, const QPointF &to);
+
+    QHash<ut64, CallGraphNodeDescription> nodes;
+    // Grid cell -> blocks whose top left corner is in the cell
+    std::unordered_map<ut64, std::vector<ut64>> cells;
+    // Size of the largest block, blocksIn() looks this far back for blocks reaching into a cell
+    int maxBlockWidth = 0;
+    int maxBlockHeight = 0;
+    // Function -> functions calling it
+    std::unordered_map<ut64, std::vector<ut64>> callers;
+    // Merge factor -> clusters, computed on demand
+    std::map<int, ClusterLevel> clusterLevels;
+
+    RVA currentFunction = RVA_INVALID;
+
+    qreal charWidth = 10.0;
+    int charHeight = 0;
+    int baseline = 0;
+
+    QColor nodeColor;
+    QColor borderColor;
+    QColor textColor;
+    QColor edgeColor;
+    QColor currentColor;
+    QColor clusterColor;
+};
+
+#endif // CALLGRAPHVIEW_H
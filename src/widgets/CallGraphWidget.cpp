@@ -0,0 +1,64 @@
+#include "CallGraphWidget.h"
+#include "CallGraphView.h"
+#include "core/MainWindow.h"
+
+CallGraphWidget::CallGraphWidget(MainWindow *main, QAction *action) :
+    CutterDockWidget(main, action)
+{
+    setObjectName("CallGraphWidget");
+    setWindowTitle(tr("Call Graph"));
+    setAllowedAreas(Qt::AllDockWidgetAreas);
+    graphView = new CallGraphView(this);
+    setWidget(graphView);
+
+    refreshDeferrer = createRefreshDeferrer([this]() {
+        refreshCallGraph();
+    });
+
+    connect(Core(), &CutterCore::refreshAll, this, &CallGraphWidget::refreshCallGraph);
+    connect(Core(), &CutterCore::functionsChanged, this, &CallGraphWidget::refreshCallGraph);
+    connect(Core(), &CutterCore::functionRenamed, this, &CallGraphWidget::refreshCallGraph);
+    connect(graphView, &CallGraphView::fontChanged, this, &CallGraphWidget::refreshCallGraph);
+}
+
+CallGraphWidget::~CallGraphWidget()
+{
+    if (task) {
+        disconnect(task.data(), nullptr, this, nullptr);
+        task->interrupt();
+    }
+}
+
+QWidget *CallGraphWidget::widgetToFocusOnRaise()
+{
+    return graphView;
+}
+
+void CallGraphWidget::refreshCallGraph()
+{
+    if (!refreshDeferrer->attemptRefresh(nullptr)) {
+        return;
+    }
+
+    // A newer snapshot makes the running layout useless, drop it instead of waiting for it
+    if (task) {
+        disconnect(task.data(), nullptr, this, nullptr);
+        task->interrupt();
+    }
+
+    task = QSharedPointer<CallGraphTask>(new CallGraphTask(graphView->getCharWidth(),
+                                                           graphView->getCharHeight(),
+                                                           graphView->getBlockPadding()));
+    connect(task.data(), &CallGraphTask::layoutFinished, this, &CallGraphWidget::layoutFinished);
+    Core()->getAsyncTaskManager()->start(task);
+}
+
+void CallGraphWidget::layoutFinished()
+{
+    // The signal is queued, so it may still arrive from a task that was replaced meanwhile
+    if (!task || sender() != task.data()) {
+        return;
+    }
+    graphView->setGraph(task->takeResult());
+    task = nullptr;
+}
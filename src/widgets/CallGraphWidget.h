@@ -0,0 +1,31 @@
+#ifndef CALLGRAPHWIDGET_H
+#define CALLGRAPHWIDGET_H
+
+#include "CutterDockWidget.h"
+#include "common/CallGraphTask.h"
+
+class MainWindow;
+class CallGraphView;
+
+class CallGraphWidget : public CutterDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit CallGraphWidget(MainWindow *main, QAction *action = nullptr);
+    ~CallGraphWidget() override;
+
+private slots:
+    void refreshCallGraph();
+    void layoutFinished();
+
+protected:
+    QWidget *widgetToFocusOnRaise() override;
+
+private:
+    CallGraphView *graphView;
+    QSharedPointer<CallGraphTask> task;
+    RefreshDeferrer *refreshDeferrer;
+};
+
+#endif // CALLGRAPHWIDGET_H
@@ -518,12 +518,16 @@ QVariant AnalClassesModel::data(const QModelIndex &index, int role) const
 
 
 ClassesSortFilterProxyModel::ClassesSortFilterProxyModel(QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : IndexedFilterProxyModel(ClassesModel::NAME, ClassesModel::NameRole, parent)
 {
 }
 
 bool ClassesSortFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) const
 {
+    if (!mayMatchFilter(row, parent)) {
+        return false;
+    }
+
     QModelIndex index = sourceModel()->index(row, 0, parent);
     return index.data(ClassesModel::NameRole).toString().contains(filterRegExp());
 }
@@ -5,6 +5,7 @@
 
 #include "core/Cutter.h"
 #include "CutterDockWidget.h"
+#include "common/IndexedFilterProxyModel.h"
 
 #include <QAbstractListModel>
 #include <QSortFilterProxyModel>
@@ -147,7 +148,7 @@ public slots:
 
 
 
-class ClassesSortFilterProxyModel : public QSortFilterProxyModel
+class ClassesSortFilterProxyModel : public IndexedFilterProxyModel
 {
     Q_OBJECT
 
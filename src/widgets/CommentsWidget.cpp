@@ -10,7 +10,7 @@
 CommentsModel::CommentsModel(QList<CommentDescription> *comments,
                              QMap<QString, QList<CommentDescription> > *nestedComments,
                              QObject *parent)
-    : QAbstractItemModel(parent),
+    : KeyedListModel(parent),
       comments(comments),
       nestedComments(nestedComments),
       nested(false)
@@ -164,7 +164,7 @@ QVariant CommentsModel::headerData(int section, Qt::Orientation, int role) const
 }
 
 CommentsProxyModel::CommentsProxyModel(CommentsModel *sourceModel, QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : IndexedFilterProxyModel(CommentsModel::CommentColumn, Qt::DisplayRole, parent)
 {
     setSourceModel(sourceModel);
     setFilterCaseSensitivity(Qt::CaseInsensitive);
@@ -179,6 +179,9 @@ bool CommentsProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) co
         return true;
     }
 
+    if (!mayMatchFilter(row, parent))
+        return false;
+
     QModelIndex index = sourceModel()->index(row, 0, parent);
     auto comment = index.data(CommentsModel::CommentDescriptionRole).value<CommentDescription>();
 
@@ -257,7 +260,7 @@ CommentsWidget::CommentsWidget(MainWindow *main, QAction *action) :
     connect(this, SIGNAL(customContextMenuRequested(const QPoint &)),
             this, SLOT(showTitleContextMenu(const QPoint &)));
 
-    connect(Core(), SIGNAL(commentsChanged()), this, SLOT(refreshTree()));
+    connect(Core(), SIGNAL(commentsChanged(RVA)), this, SLOT(refreshTree()));
     connect(Core(), SIGNAL(refreshAll()), this, SLOT(refreshTree()));
 }
 
@@ -325,16 +328,25 @@ void CommentsWidget::resizeEvent(QResizeEvent *event)
 
 void CommentsWidget::refreshTree()
 {
-    commentsModel->beginResetModel();
-
-    comments = Core()->getAllComments("CCu");
-    nestedComments.clear();
-    for (const CommentDescription &comment : comments) {
+    QList<CommentDescription> newComments = Core()->getAllComments("CCu");
+    QMap<QString, QList<CommentDescription>> newNestedComments;
+    for (const CommentDescription &comment : newComments) {
         QString fcnName = Core()->cmdFunctionAt(comment.offset);
-        nestedComments[fcnName].append(comment);
+        newNestedComments[fcnName].append(comment);
     }
 
-    commentsModel->endResetModel();
+    if (commentsModel->isNested()) {
+        // Rows of the nested view are grouped by function, only the flat list is diffed
+        commentsModel->beginResetModel();
+        comments = newComments;
+        nestedComments = newNestedComments;
+        commentsModel->endResetModel();
+    } else {
+        nestedComments = newNestedComments;
+        commentsModel->updateList(comments, newComments, [](const CommentDescription &comment) {
+            return comment.offset;
+        });
+    }
 
     qhelpers::adjustColumns(ui->commentsTreeView, 3, 0);
 
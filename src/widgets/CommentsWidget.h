@@ -8,6 +8,8 @@
 #include "core/Cutter.h"
 #include "CutterDockWidget.h"
 #include "CutterTreeWidget.h"
+#include "common/KeyedListModel.h"
+#include "common/IndexedFilterProxyModel.h"
 
 class MainWindow;
 class QTreeWidgetItem;
@@ -17,7 +19,7 @@ namespace Ui {
 class CommentsWidget;
 }
 
-class CommentsModel : public QAbstractItemModel
+class CommentsModel : public KeyedListModel<QAbstractItemModel>
 {
     Q_OBJECT
 
@@ -50,7 +52,7 @@ public:
     void setNested(bool nested);
 };
 
-class CommentsProxyModel : public QSortFilterProxyModel
+class CommentsProxyModel : public IndexedFilterProxyModel
 {
     Q_OBJECT
 
@@ -23,4 +23,11 @@ void CutterTreeWidget::showItemsNumber(int count)
     }
 }
 
+void CutterTreeWidget::addPermanentWidget(QWidget *widget)
+{
+    if(bar){
+        bar->addPermanentWidget(widget);
+    }
+}
+
 CutterTreeWidget::~CutterTreeWidget() {}
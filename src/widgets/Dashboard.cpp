@@ -3,10 +3,10 @@
 #include "common/Helpers.h"
 #include "common/JsonModel.h"
 #include "common/JsonTreeItem.h"
-#include "common/TempConfig.h"
 #include "dialogs/VersionInfoDialog.h"
 
 #include "core/MainWindow.h"
+#include "core/EntropyMap.h"
 #include "CutterTreeView.h"
 
 #include <QDebug>
@@ -28,10 +28,22 @@ Dashboard::Dashboard(MainWindow *main, QAction *action) :
     ui->setupUi(this);
 
     connect(Core(), SIGNAL(refreshAll()), this, SLOT(updateContents()));
+    connect(Core()->getDataStore(), &AnalysisDataStore::dataReady, this, &Dashboard::onDataReady);
 }
 
 Dashboard::~Dashboard() {}
 
+void Dashboard::onDataReady(AnalysisDataStore::Kind kind)
+{
+    if (kind != AnalysisDataStore::Kind::Entropy) {
+        return;
+    }
+    QSharedPointer<const EntropyMap> map = Core()->getDataStore()->getEntropyMap();
+    if (map) {
+        ui->lblEntropy->setText(QString::number(map->getFileEntropy(), 'f', 8));
+    }
+}
+
 void Dashboard::updateContents()
 {
     QJsonDocument docu = Core()->getFileInfo();
@@ -111,14 +123,9 @@ void Dashboard::updateContents()
     QSpacerItem *spacer = new QSpacerItem(1, 1, QSizePolicy::Fixed, QSizePolicy::Expanding);
     ui->verticalLayout_2->addSpacerItem(spacer);
 
-    // Add entropy value
-    {
-        // Scope for TempConfig
-        TempConfig tempConfig;
-        tempConfig.set("io.va", false);
-        QString entropy = Core()->cmd("ph entropy $s @ 0").trimmed();
-        ui->lblEntropy->setText(entropy);
-    }
+    // Add entropy value, the entropy map is computed in the background
+    ui->lblEntropy->clear();
+    Core()->getDataStore()->request(AnalysisDataStore::Kind::Entropy);
 
 
     // Get stats for the graphs
@@ -3,6 +3,7 @@
 
 #include <memory>
 #include "CutterDockWidget.h"
+#include "core/AnalysisDataStore.h"
 
 QT_BEGIN_NAMESPACE
 QT_FORWARD_DECLARE_CLASS(QLineEdit)
@@ -25,6 +26,7 @@ public:
 
 private slots:
     void updateContents();
+    void onDataReady(AnalysisDataStore::Kind kind);
     void on_certificateButton_clicked();
     void on_versioninfoButton_clicked();
 
@@ -38,12 +38,12 @@ DisassemblerGraphView::DisassemblerGraphView(QWidget *parent)
     auto *layout = new QVBoxLayout(this);
     // Signals that require a refresh all
     connect(Core(), SIGNAL(refreshAll()), this, SLOT(refreshView()));
-    connect(Core(), SIGNAL(commentsChanged()), this, SLOT(refreshView()));
+    connect(Core(), SIGNAL(commentsChanged(RVA)), this, SLOT(refreshBlockAt(RVA)));
     connect(Core(), SIGNAL(functionRenamed(const QString &, const QString &)), this,
             SLOT(refreshView()));
     connect(Core(), SIGNAL(flagsChanged()), this, SLOT(refreshView()));
     connect(Core(), SIGNAL(varsChanged()), this, SLOT(refreshView()));
-    connect(Core(), SIGNAL(instructionChanged(RVA)), this, SLOT(refreshView()));
+    connect(Core(), SIGNAL(instructionChanged(RVA)), this, SLOT(refreshBlockAt(RVA)));
     connect(Core(), SIGNAL(functionsChanged()), this, SLOT(refreshView()));
     connect(Core(), SIGNAL(graphOptionsChanged()), this, SLOT(refreshView()));
     connect(Core(), SIGNAL(asmOptionsChanged()), this, SLOT(refreshView()));
@@ -53,6 +53,18 @@ DisassemblerGraphView::DisassemblerGraphView(QWidget *parent)
     connect(Config(), SIGNAL(fontsUpdated()), this, SLOT(fontsUpdatedSlot()));
     connectSeekChanged(false);
 
+    connect(Core(), &CutterCore::breakpointsChanged, this, [this]() {
+        renderState.breakpointsValid = false;
+        viewport()->update();
+    });
+    auto invalidatePC = [this]() {
+        renderState.pcValid = false;
+        viewport()->update();
+    };
+    connect(Core(), &CutterCore::registersChanged, this, invalidatePC);
+    connect(Core(), &CutterCore::changeDebugView, this, invalidatePC);
+    connect(Core(), &CutterCore::changeDefinedView, this, invalidatePC);
+
     // Space to switch to disassembly
     QShortcut *shortcut_disassembly = new QShortcut(QKeySequence(Qt::Key_Space), this);
     shortcut_disassembly->setContext(Qt::WidgetShortcut);
@@ -168,6 +180,8 @@ void DisassemblerGraphView::toggleSync()
 
 void DisassemblerGraphView::refreshView()
 {
+    // Colors, fonts, breakpoints or the debugger state may have changed
+    renderState = RenderState();
     initFont();
     loadCurrentGraph();
     viewport()->update();
@@ -183,6 +197,7 @@ void DisassemblerGraphView::loadCurrentGraph()
     .set("asm.lines.fcn", false);
 
     QJsonArray functions;
+    RVA prevFcnAddr = currentFcnAddr;
     RAnalFunction *fcn = Core()->functionAt(seekable->getOffset());
     if (fcn) {
         currentFcnAddr = fcn->addr;
@@ -192,6 +207,7 @@ void DisassemblerGraphView::loadCurrentGraph()
 
     disassembly_blocks.clear();
     blocks.clear();
+    snapshot.reset();
 
     if (highlight_token) {
         delete highlight_token;
@@ -272,62 +288,169 @@ void DisassemblerGraphView::loadCurrentGraph()
             }
         }
 
-        QJsonArray opArray = block["ops"].toArray();
-        for (int opIndex = 0; opIndex < opArray.size(); opIndex++) {
-            QJsonObject op = opArray[opIndex].toObject();
-            Instr i;
-            i.addr = op["offset"].toVariant().toULongLong();
-
-            if (opIndex < opArray.size() - 1) {
-                // get instruction size from distance to next instruction ...
-                RVA nextOffset = opArray[opIndex + 1].toObject()["offset"].toVariant().toULongLong();
-                i.size = nextOffset - i.addr;
-            } else {
-                // or to the end of the block.
-                i.size = (block_entry + block_size) - i.addr;
-            }
+        db.instrs = parseInstructions(block["ops"].toArray(), block_entry + block_size);
+        disassembly_blocks[db.entry] = db;
+        prepareGraphNode(gb);
+
+        addBlock(gb);
+    }
+
+    if (!func["blocks"].toArray().isEmpty()) {
+        if (fcn && fcn->addr == prevFcnAddr) {
+            // Reloading the same function, keep the placement if only block contents changed
+            computeGraphGeometry();
+        } else {
+            computeGraph(entry);
+        }
+    }
+}
+
+std::vector<DisassemblerGraphView::Instr> DisassemblerGraphView::parseInstructions(
+    const QJsonArray &opArray, RVA blockEnd)
+{
+    std::vector<Instr> instrs;
+    int blockLength = Config()->getGraphBlockMaxChars() + Core()->getConfigb("asm.bytes") * 24 +
+                      Core()->getConfigb("asm.emu") * 10;
+    for (int opIndex = 0; opIndex < opArray.size(); opIndex++) {
+        QJsonObject op = opArray[opIndex].toObject();
+        Instr i;
+        i.addr = op["offset"].toVariant().toULongLong();
+
+        if (opIndex < opArray.size() - 1) {
+            // get instruction size from distance to next instruction ...
+            RVA nextOffset = opArray[opIndex + 1].toObject()["offset"].toVariant().toULongLong();
+            i.size = nextOffset - i.addr;
+        } else {
+            // or to the end of the block.
+            i.size = blockEnd - i.addr;
+        }
 
-            // Skip last byte, otherwise it will overlap with next instruction
-            i.size -= 1;
+        // Skip last byte, otherwise it will overlap with next instruction
+        i.size -= 1;
 
-            QTextDocument textDoc;
-            textDoc.setHtml(CutterCore::ansiEscapeToHtml(op["text"].toString()));
+        QTextDocument textDoc;
+        textDoc.setHtml(CutterCore::ansiEscapeToHtml(op["text"].toString()));
 
-            i.plainText = textDoc.toPlainText();
+        i.plainText = textDoc.toPlainText();
 
-            RichTextPainter::List richText = RichTextPainter::fromTextDocument(textDoc);
-            //Colors::colorizeAssembly(richText, textDoc.toPlainText(), 0);
+        RichTextPainter::List richText = RichTextPainter::fromTextDocument(textDoc);
+        //Colors::colorizeAssembly(richText, textDoc.toPlainText(), 0);
 
-            bool cropped;
-            int blockLength = Config()->getGraphBlockMaxChars() + Core()->getConfigb("asm.bytes") * 24 +
-                              Core()->getConfigb("asm.emu") * 10;
-            i.text = Text(RichTextPainter::cropped(richText, blockLength, "...", &cropped));
-            if (cropped)
-                i.fullText = richText;
-            else
-                i.fullText = Text();
-            db.instrs.push_back(i);
+        bool cropped;
+        i.text = Text(RichTextPainter::cropped(richText, blockLength, "...", &cropped));
+        if (cropped)
+            i.fullText = richText;
+        else
+            i.fullText = Text();
+        instrs.push_back(i);
+    }
+    return instrs;
+}
+
+void DisassemblerGraphView::refreshBlockAt(RVA addr)
+{
+    DisassemblyBlock *db = blockForAddress(addr);
+    if (!db) {
+        refreshView();
+        return;
+    }
+    auto blockIt = blocks.find(db->entry);
+    if (blockIt == blocks.end()) {
+        refreshView();
+        return;
+    }
+    GraphBlock &block = blockIt->second;
+
+    // Look up the current bounds and successors of the block, without disassembling anything
+    QJsonObject bbObject;
+    for (const QJsonValue &value : Core()->cmdj("afbj @ " + RAddressString(db->entry)).array()) {
+        QJsonObject object = value.toObject();
+        if (object["addr"].toVariant().toULongLong() == db->entry) {
+            bbObject = object;
+            break;
         }
-        disassembly_blocks[db.entry] = db;
-        prepareGraphNode(gb);
+    }
+    if (bbObject.isEmpty()) {
+        refreshView();
+        return;
+    }
+    RVA blockSize = bbObject["size"].toVariant().toULongLong();
+    RVA blockFail = bbObject["fail"].toVariant().toULongLong();
+    RVA blockJump = bbObject["jump"].toVariant().toULongLong();
+    int instrCount = bbObject["ninstr"].toInt();
+
+    // A changed size or different successors change the graph itself, reload everything
+    std::vector<ut64> targets;
+    if (blockFail && blockFail != RVA_INVALID) {
+        targets.push_back(blockFail);
+    }
+    if (blockJump && blockJump != RVA_INVALID) {
+        targets.push_back(blockJump);
+    }
+    bool sameEdges = targets.size() == block.edges.size();
+    for (size_t i = 0; sameEdges && i < targets.size(); i++) {
+        sameEdges = targets[i] == block.edges[i].target;
+    }
+    if (!sameEdges || db->instrs.empty() || instrCount <= 0
+            || blockSize != db->instrs.back().addr + db->instrs.back().size + 1 - db->entry) {
+        refreshView();
+        return;
+    }
 
-        addBlock(gb);
+    QJsonArray opArray;
+    {
+        TempConfig tempConfig;
+        tempConfig.set("scr.color", COLOR_MODE_16M)
+        .set("asm.bb.line", false)
+        .set("asm.lines", false)
+        .set("asm.lines.fcn", false);
+        opArray = Core()->cmdj(QString("pdJ %1 @ %2").arg(instrCount).arg(db->entry)).array();
+    }
+    if (opArray.isEmpty()) {
+        refreshView();
+        return;
     }
 
-    if (!func["blocks"].toArray().isEmpty()) {
-        computeGraph(entry);
+    // The highlighted token points into the instructions that are about to be replaced
+    if (highlight_token) {
+        delete highlight_token;
+        highlight_token = nullptr;
     }
+    db->instrs = parseInstructions(opArray, db->entry + blockSize);
+
+    int oldX = block.x;
+    int oldY = block.y;
+    int oldWidth = block.width;
+    int oldHeight = block.height;
+    prepareGraphNode(block);
+    if (block.width != oldWidth || block.height != oldHeight) {
+        computeGraphGeometry();
+        snapshot.reset();
+        // Keep the changed block at the same place in the viewport
+        offset += QPoint(block.x - oldX, block.y - oldY);
+    }
+
+    viewport()->update();
+    emit viewRefreshed();
 }
 
-DisassemblerGraphView::EdgeConfigurationMapping DisassemblerGraphView::getEdgeConfigurations()
+GraphView::GraphSnapshotPtr DisassemblerGraphView::getSnapshot()
 {
-    EdgeConfigurationMapping result;
+    if (snapshot) {
+        return snapshot;
+    }
+    auto newSnapshot = std::make_shared<GraphSnapshot>();
+    newSnapshot->width = width;
+    newSnapshot->height = height;
+    newSnapshot->blocks = blocks;
     for (auto &block : blocks) {
         for (const auto &edge : block.second.edges) {
-            result[ {block.first, edge.target}] = edgeConfiguration(block.second, &blocks[edge.target]);
+            newSnapshot->edgeConfigurations[ {block.first, edge.target}] =
+                edgeConfiguration(block.second, &blocks[edge.target]);
         }
     }
-    return result;
+    snapshot = newSnapshot;
+    return snapshot;
 }
 
 void DisassemblerGraphView::prepareGraphNode(GraphBlock &block)
@@ -381,18 +504,36 @@ void DisassemblerGraphView::initFont()
     mFontMetrics = new CachedFontMetrics(this, font());
 }
 
+void DisassemblerGraphView::updateRenderState()
+{
+    if (!renderState.configValid) {
+        renderState.font = Config()->getFont();
+        renderState.highlightWordColor = ConfigColor("highlightWord");
+        renderState.breakpointBackgroundColor = ConfigColor("gui.breakpoint_background");
+        renderState.configValid = true;
+    }
+    if (!renderState.breakpointsValid) {
+        renderState.breakpoints = Core()->getBreakpointsAddresses().toSet();
+        renderState.breakpointsValid = true;
+    }
+    if (!renderState.pcValid) {
+        renderState.pc = Core()->getProgramCounterValue();
+        renderState.pcValid = true;
+    }
+}
+
 void DisassemblerGraphView::drawBlock(QPainter &p, GraphView::GraphBlock &block)
 {
     int blockX = block.x - offset.x();
     int blockY = block.y - offset.y();
 
+    updateRenderState();
+
     p.setPen(Qt::black);
     p.setBrush(Qt::gray);
-    p.setFont(Config()->getFont());
+    p.setFont(renderState.font);
     p.drawRect(blockX, blockY, block.width, block.height);
 
-    breakpoints = Core()->getBreakpointsAddresses();
-
     // Render node
     DisassemblyBlock &db = disassembly_blocks[block.entry];
     bool block_selected = false;
@@ -401,7 +542,7 @@ void DisassemblerGraphView::drawBlock(QPainter &p, GraphView::GraphBlock &block)
 
     // Figure out if the current block is selected
     RVA addr = seekable->getOffset();
-    RVA PCAddr = Core()->getProgramCounterValue();
+    RVA PCAddr = renderState.pc;
     for (const Instr &instr : db.instrs) {
         if ((instr.addr <= addr) && (addr <= instr.addr + instr.size)) {
             block_selected = true;
@@ -490,10 +631,8 @@ void DisassemblerGraphView::drawBlock(QPainter &p, GraphView::GraphBlock &block)
                     highlightWidth = static_cast<int>(block.width - widthBefore - (10 + 4 * charWidth));
                 }
 
-                QColor selectionColor = ConfigColor("highlightWord");
-
                 p.fillRect(QRect(static_cast<int>(blockX + charWidth * 3 + widthBefore), y, highlightWidth,
-                                 charHeight), selectionColor);
+                                 charHeight), renderState.highlightWordColor);
             }
 
             y += int(instr.text.lines.size()) * charHeight;
@@ -539,10 +678,10 @@ void DisassemblerGraphView::drawBlock(QPainter &p, GraphView::GraphBlock &block)
     }
 
     for (const Instr &instr : db.instrs) {
-        if (Core()->isBreakpoint(breakpoints, instr.addr)) {
+        if (renderState.breakpoints.contains(instr.addr)) {
             p.fillRect(QRect(static_cast<int>(blockX + charWidth), y,
                              static_cast<int>(block.width - (10 + 2 * charWidth)),
-                             int(instr.text.lines.size()) * charHeight), ConfigColor("gui.breakpoint_background"));
+                             int(instr.text.lines.size()) * charHeight), renderState.breakpointBackgroundColor);
             if (instr.addr == selected_instruction) {
                 p.fillRect(QRect(static_cast<int>(blockX + charWidth), y,
                                  static_cast<int>(block.width - (10 + 2 * charWidth)),
@@ -7,6 +7,7 @@
 #include <QPainter>
 #include <QShortcut>
 #include <QLabel>
+#include <QSet>
 
 #include "widgets/GraphView.h"
 #include "menus/DisassemblyContextMenu.h"
@@ -103,12 +104,19 @@ public:
 
     int getWidth() { return width; }
     int getHeight() { return height; }
-    std::unordered_map<ut64, GraphBlock> getBlocks() { return blocks; }
-    using EdgeConfigurationMapping = std::map<std::pair<ut64, ut64>, EdgeConfiguration>;
-    EdgeConfigurationMapping getEdgeConfigurations();
+    /**
+     * @brief Shared copy of the current layout, created at most once per graph change.
+     */
+    GraphSnapshotPtr getSnapshot();
 
 public slots:
     void refreshView();
+    /**
+     * @brief Reload only the basic block containing addr, e.g. after a patch or a new comment.
+     * The layout is kept if the block size on screen doesn't change, otherwise only the
+     * coordinates are recomputed. Falls back to refreshView() if the graph itself changed.
+     */
+    void refreshBlockAt(RVA addr);
     void colorsUpdatedSlot();
     void fontsUpdatedSlot();
     void onSeekChanged(RVA addr);
@@ -136,6 +144,9 @@ private slots:
 private:
     bool transition_dont_seek = false;
 
+    // Cached result of getSnapshot(), reset whenever the layout or edge styles change
+    GraphSnapshotPtr snapshot;
+
     Token *highlight_token;
     // Font data
     CachedFontMetrics *mFontMetrics;
@@ -151,6 +162,7 @@ private:
 
     void initFont();
     void prepareGraphNode(GraphBlock &block);
+    std::vector<Instr> parseInstructions(const QJsonArray &opArray, RVA blockEnd);
     void prepareHeader();
     Token *getToken(Instr *instr, int x);
     RVA getAddrForMouseEvent(GraphBlock &block, QPoint *point);
@@ -160,7 +172,23 @@ private:
     void seekInstruction(bool previous_instr);
     CutterSeekable *seekable = nullptr;
     QList<QShortcut *> shortcuts;
-    QList<RVA> breakpoints;
+
+    /**
+     * @brief Values used by drawBlock that are expensive to look up. They are fetched on the
+     * first drawBlock of a paint and then kept until a signal tells that they changed.
+     */
+    struct RenderState {
+        bool configValid = false;
+        bool breakpointsValid = false;
+        bool pcValid = false;
+        QFont font;
+        QColor highlightWordColor;
+        QColor breakpointBackgroundColor;
+        QSet<RVA> breakpoints;
+        RVA pc = RVA_INVALID;
+    };
+    RenderState renderState;
+    void updateRenderState();
 
     QColor disassemblyBackgroundColor;
     QColor disassemblySelectedBackgroundColor;
@@ -10,7 +10,7 @@
 #include <QTreeWidget>
 
 FlagsModel::FlagsModel(QList<FlagDescription> *flags, QObject *parent)
-    : QAbstractListModel(parent),
+    : KeyedListModel(parent),
       flags(flags)
 {
 }
@@ -75,24 +75,46 @@ QVariant FlagsModel::headerData(int section, Qt::Orientation, int role) const
 
 
 FlagsSortFilterProxyModel::FlagsSortFilterProxyModel(FlagsModel *source_model, QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : ParallelSortFilterProxyModel(FlagsModel::NAME, Qt::DisplayRole, parent)
 {
     setSourceModel(source_model);
 }
 
-bool FlagsSortFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) const
+bool FlagsSortFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &) const
 {
-    QModelIndex index = sourceModel()->index(row, 0, parent);
-    FlagDescription flag = index.data(FlagsModel::FlagDescriptionRole).value<FlagDescription>();
-    return flag.name.contains(filterRegExp());
+    return filterMatches(row);
+}
+
+bool FlagsSortFilterProxyModel::sourceRowMatches(int row, QRegExp &regExp) const
+{
+    return sortFlags[row].name.contains(regExp);
 }
 
-bool FlagsSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+void FlagsSortFilterProxyModel::cacheSortKeys()
 {
-    FlagDescription left_flag = left.data(FlagsModel::FlagDescriptionRole).value<FlagDescription>();
-    FlagDescription right_flag = right.data(FlagsModel::FlagDescriptionRole).value<FlagDescription>();
+    int rowCount = sourceModel()->rowCount();
+    sortFlags.clear();
+    sortFlags.reserve(rowCount);
+    for (int row = 0; row < rowCount; row++) {
+        QModelIndex index = sourceModel()->index(row, 0);
+        sortFlags.push_back(index.data(FlagsModel::FlagDescriptionRole).value<FlagDescription>());
+    }
+}
 
-    switch (left.column()) {
+void FlagsSortFilterProxyModel::updateSortKeys(int first, int last)
+{
+    for (int row = first; row <= last && row < static_cast<int>(sortFlags.size()); row++) {
+        QModelIndex index = sourceModel()->index(row, 0);
+        sortFlags[row] = index.data(FlagsModel::FlagDescriptionRole).value<FlagDescription>();
+    }
+}
+
+bool FlagsSortFilterProxyModel::sourceRowLessThan(int leftRow, int rightRow, int column) const
+{
+    const FlagDescription &left_flag = sortFlags[leftRow];
+    const FlagDescription &right_flag = sortFlags[rightRow];
+
+    switch (column) {
     case FlagsModel::SIZE:
         if (left_flag.size != right_flag.size)
             return left_flag.size < right_flag.size;
@@ -158,6 +180,8 @@ FlagsWidget::FlagsWidget(MainWindow *main, QAction *action) :
 
     connect(Core(), SIGNAL(flagsChanged()), this, SLOT(flagsChanged()));
     connect(Core(), SIGNAL(refreshAll()), this, SLOT(refreshFlagspaces()));
+    connect(Core()->getDataStore(), &AnalysisDataStore::dataReady, this,
+            &FlagsWidget::onDataReady);
 }
 
 FlagsWidget::~FlagsWidget() {}
@@ -232,28 +256,46 @@ void FlagsWidget::refreshFlagspaces()
     refreshFlags();
 }
 
-void FlagsWidget::refreshFlags()
+QString FlagsWidget::currentFlagspace()
 {
-    QString flagspace;
-
     QVariant flagspace_data = ui->flagspaceCombo->currentData();
     if (flagspace_data.isValid())
-        flagspace = flagspace_data.value<FlagspaceDescription>().name;
+        return flagspace_data.value<FlagspaceDescription>().name;
+    return QString();
+}
 
+void FlagsWidget::refreshFlags()
+{
+    QString flagspace = currentFlagspace();
+    if (flagspace.isEmpty()) {
+        // All flags are shared with the Omnibar, they arrive through onDataReady
+        Core()->getDataStore()->request(AnalysisDataStore::Kind::Flags);
+        return;
+    }
+    setFlags(Core()->getAllFlags(flagspace));
+}
+
+void FlagsWidget::onDataReady(AnalysisDataStore::Kind kind)
+{
+    if (kind != AnalysisDataStore::Kind::Flags || !currentFlagspace().isEmpty()) {
+        return;
+    }
+    QList<FlagDescription> newFlags = Core()->getDataStore()->getFlags();
+    if (newFlags.isSharedWith(flags)) {
+        return;
+    }
+    setFlags(newFlags);
+}
 
-    flags_model->beginResetModel();
-    flags = Core()->getAllFlags(flagspace);
-    flags_model->endResetModel();
+void FlagsWidget::setFlags(const QList<FlagDescription> &newFlags)
+{
+    flags_model->updateList(flags, newFlags, [](const FlagDescription &flag) {
+        return flag.name;
+    });
 
     qhelpers::adjustColumns(ui->flagsTreeView, 2, 0);
 
     tree->showItemsNumber(flags_proxy_model->rowCount());
-    
-    // TODO: this is not a very good place for the following:
-    QStringList flagNames;
-    for (const FlagDescription &i : flags)
-        flagNames.append(i.name);
-    main->refreshOmniBar(flagNames);
 }
 
 void FlagsWidget::setScrollMode()
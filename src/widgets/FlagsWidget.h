@@ -7,15 +7,18 @@
 #include <QSortFilterProxyModel>
 
 #include "core/Cutter.h"
+#include "core/AnalysisDataStore.h"
 #include "CutterDockWidget.h"
 #include "CutterTreeWidget.h"
+#include "common/KeyedListModel.h"
+#include "common/ParallelSortFilterProxyModel.h"
 
 class MainWindow;
 class QTreeWidgetItem;
 class FlagsWidget;
 
 
-class FlagsModel: public QAbstractListModel
+class FlagsModel: public KeyedListModel<QAbstractListModel>
 {
     Q_OBJECT
 
@@ -39,7 +42,7 @@ public:
 
 
 
-class FlagsSortFilterProxyModel : public QSortFilterProxyModel
+class FlagsSortFilterProxyModel : public ParallelSortFilterProxyModel
 {
     Q_OBJECT
 
@@ -48,7 +51,13 @@ public:
 
 protected:
     bool filterAcceptsRow(int row, const QModelIndex &parent) const override;
-    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+    void cacheSortKeys() override;
+    void updateSortKeys(int first, int last) override;
+    bool sourceRowLessThan(int leftRow, int rightRow, int column) const override;
+    bool sourceRowMatches(int row, QRegExp &regExp) const override;
+
+private:
+    std::vector<FlagDescription> sortFlags;
 };
 
 
@@ -76,6 +85,7 @@ private slots:
 
     void flagsChanged();
     void refreshFlagspaces();
+    void onDataReady(AnalysisDataStore::Kind kind);
 
 private:
     std::unique_ptr<Ui::FlagsWidget> ui;
@@ -86,7 +96,9 @@ private:
     QList<FlagDescription> flags;
     CutterTreeWidget *tree;
 
+    QString currentFlagspace();
     void refreshFlags();
+    void setFlags(const QList<FlagDescription> &newFlags);
     void setScrollMode();
 };
 
@@ -6,7 +6,6 @@
 #include "dialogs/CommentsDialog.h"
 #include "dialogs/RenameDialog.h"
 #include "dialogs/XrefsDialog.h"
-#include "common/FunctionsTask.h"
 #include "common/TempConfig.h"
 
 #include <algorithm>
@@ -28,7 +27,7 @@ static const int kMaxTooltipHighlightsLines = 5;
 
 FunctionModel::FunctionModel(QList<FunctionDescription> *functions, QSet<RVA> *importAddresses,
                              ut64 *mainAdress, bool nested, QFont default_font, QFont highlight_font, QObject *parent)
-    : QAbstractItemModel(parent),
+    : KeyedListModel(parent),
       functions(functions),
       importAddresses(importAddresses),
       mainAdress(mainAdress),
@@ -332,11 +331,14 @@ void FunctionModel::seekChanged(RVA)
 {
     int previousIndex = currentIndex;
     if (updateCurrentIndex()) {
+        // Only the font shows the current function, so the proxies don't sort or filter again
         if (previousIndex >= 0) {
-            emit dataChanged(index(previousIndex, 0), index(previousIndex, columnCount() - 1));
+            emit dataChanged(index(previousIndex, 0), index(previousIndex, columnCount() - 1),
+                             { Qt::FontRole });
         }
         if (currentIndex >= 0) {
-            emit dataChanged(index(currentIndex, 0), index(currentIndex, columnCount() - 1));
+            emit dataChanged(index(currentIndex, 0), index(currentIndex, columnCount() - 1),
+                             { Qt::FontRole });
         }
     }
 }
@@ -371,14 +373,15 @@ void FunctionModel::functionRenamed(const QString &prev_name, const QString &new
         FunctionDescription &function = (*functions)[i];
         if (function.name == prev_name) {
             function.name = new_name;
-            emit dataChanged(index(i, 0), index(i, columnCount() - 1));
+            emit dataChanged(index(i, 0), index(i, columnCount() - 1),
+                             { Qt::DisplayRole, Qt::ToolTipRole, FunctionDescriptionRole });
         }
     }
 }
 
 FunctionSortFilterProxyModel::FunctionSortFilterProxyModel(FunctionModel *source_model,
                                                            QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : ParallelSortFilterProxyModel(FunctionModel::NameColumn, Qt::DisplayRole, parent)
 {
     setSourceModel(source_model);
     setFilterCaseSensitivity(Qt::CaseInsensitive);
@@ -387,30 +390,59 @@ FunctionSortFilterProxyModel::FunctionSortFilterProxyModel(FunctionModel *source
 
 bool FunctionSortFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) const
 {
+    if (!parent.isValid())
+        return filterMatches(row);
+
+    // Detail rows of the nested view have no keys of their own
+    if (!mayMatchFilter(row, parent))
+        return false;
+
     QModelIndex index = sourceModel()->index(row, 0, parent);
     FunctionDescription function = index.data(
                                        FunctionModel::FunctionDescriptionRole).value<FunctionDescription>();
     return function.name.contains(filterRegExp());
 }
 
-bool FunctionSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+bool FunctionSortFilterProxyModel::sourceRowMatches(int row, QRegExp &regExp) const
 {
-    if (!left.isValid() || !right.isValid())
-        return false;
+    return sortFunctions[row].name.contains(regExp);
+}
 
-    if (left.parent().isValid() || right.parent().isValid())
-        return false;
+void FunctionSortFilterProxyModel::cacheSortKeys()
+{
+    FunctionModel *model = static_cast<FunctionModel *>(sourceModel());
+    int rowCount = model->rowCount();
+    sortNested = model->isNested();
+    sortFunctions.clear();
+    sortFunctions.reserve(rowCount);
+    sortIsImport.assign(rowCount, false);
+    for (int row = 0; row < rowCount; row++) {
+        QModelIndex index = model->index(row, 0);
+        sortFunctions.push_back(index.data(
+                                    FunctionModel::FunctionDescriptionRole).value<FunctionDescription>());
+        sortIsImport[row] = index.data(FunctionModel::IsImportRole).toBool();
+    }
+}
 
-    FunctionDescription left_function = left.data(
-                                            FunctionModel::FunctionDescriptionRole).value<FunctionDescription>();
-    FunctionDescription right_function = right.data(
-                                             FunctionModel::FunctionDescriptionRole).value<FunctionDescription>();
+void FunctionSortFilterProxyModel::updateSortKeys(int first, int last)
+{
+    FunctionModel *model = static_cast<FunctionModel *>(sourceModel());
+    for (int row = first; row <= last && row < static_cast<int>(sortFunctions.size()); row++) {
+        QModelIndex index = model->index(row, 0);
+        sortFunctions[row] = index.data(FunctionModel::FunctionDescriptionRole).value<FunctionDescription>();
+        sortIsImport[row] = index.data(FunctionModel::IsImportRole).toBool();
+    }
+}
 
+bool FunctionSortFilterProxyModel::sourceRowLessThan(int leftRow, int rightRow, int column) const
+{
+    const FunctionDescription &left_function = sortFunctions[leftRow];
+    const FunctionDescription &right_function = sortFunctions[rightRow];
 
-    if (static_cast<FunctionModel *>(sourceModel())->isNested()) {
+    if (sortNested) {
         return left_function.name < right_function.name;
     } else {
-        switch (left.column()) {
+        switch (column) {
         case FunctionModel::OffsetColumn:
             return left_function.offset < right_function.offset;
         case FunctionModel::SizeColumn:
@@ -418,10 +450,10 @@ bool FunctionSortFilterProxyModel::lessThan(const QModelIndex &left, const QMode
                 return left_function.size < right_function.size;
             break;
         case FunctionModel::ImportColumn: {
-            bool left_is_import = left.data(FunctionModel::IsImportRole).toBool();
-            bool right_is_import = right.data(FunctionModel::IsImportRole).toBool();
-            if (!left_is_import && right_is_import)
-                return true;
+            bool left_is_import = sortIsImport[leftRow];
+            bool right_is_import = sortIsImport[rightRow];
+            if (left_is_import != right_is_import)
+                return right_is_import;
             break;
         }
         case FunctionModel::NameColumn:
@@ -444,7 +476,6 @@ bool FunctionSortFilterProxyModel::lessThan(const QModelIndex &left, const QMode
             break;
         case FunctionModel::CalltypeColumn:
             return left_function.calltype < right_function.calltype;
-            break;
         case FunctionModel::EdgesColumn:
             if (left_function.edges != right_function.edges)
                 return left_function.edges < right_function.edges;
@@ -533,39 +564,65 @@ FunctionsWidget::FunctionsWidget(MainWindow *main, QAction *action) :
 
     connect(Core(), SIGNAL(functionsChanged()), this, SLOT(refreshTree()));
     connect(Core(), SIGNAL(refreshAll()), this, SLOT(refreshTree()));
+    connect(Core()->getDataStore(), &AnalysisDataStore::dataReady, this,
+            &FunctionsWidget::onDataReady);
 }
 
 FunctionsWidget::~FunctionsWidget() {}
 
 void FunctionsWidget::refreshTree()
 {
-    if (task) {
-        task->wait();
-    }
-
-    task = QSharedPointer<FunctionsTask>(new FunctionsTask());
-    connect(task.data(), &FunctionsTask::fetchFinished,
-    this, [this] (const QList<FunctionDescription> &functions) {
-        functionModel->beginResetModel();
-
-        this->functions = functions;
+    AnalysisDataStore *store = Core()->getDataStore();
+    store->request(AnalysisDataStore::Kind::Functions);
+    store->request(AnalysisDataStore::Kind::Imports);
+}
 
-        importAddresses.clear();
-        for (const ImportDescription &import : Core()->getAllImports()) {
-            importAddresses.insert(import.plt);
-        }
+void FunctionsWidget::onDataReady(AnalysisDataStore::Kind kind)
+{
+    if (kind != AnalysisDataStore::Kind::Functions && kind != AnalysisDataStore::Kind::Imports) {
+        return;
+    }
+    AnalysisDataStore *store = Core()->getDataStore();
+    if (!store->isCurrent(AnalysisDataStore::Kind::Functions)
+            || !store->isCurrent(AnalysisDataStore::Kind::Imports)) {
+        // Wait for the other one
+        return;
+    }
+    QList<FunctionDescription> newFunctions = store->getFunctions();
+    QList<ImportDescription> newImports = store->getImports();
+    if (newFunctions.isSharedWith(functions) && newImports.isSharedWith(imports)) {
+        // Another widget requested the same snapshots
+        return;
+    }
 
-        mainAdress = (ut64)Core()->cmdj("iMj").object()["vaddr"].toInt();
+    // Everything else is derived on the fetching threads, only the model is updated here
+    imports = newImports;
+    QSet<RVA> newImportAddresses = store->getImportAddresses();
+    ut64 newMainAddress = store->getMainAddress();
 
+    if (newImportAddresses != importAddresses || newMainAddress != mainAdress
+            || functionModel->isNested()) {
+        // Changes the color of rows that are otherwise the same. The detail rows of the nested
+        // view are identified by the row of their function, so it is reset too.
+        functionModel->beginResetModel();
+        functions = newFunctions;
+        importAddresses = newImportAddresses;
+        mainAdress = newMainAddress;
         functionModel->updateCurrentIndex();
         functionModel->endResetModel();
+    } else {
+        // Row numbers may change, the highlighted one is looked up again afterwards
+        functionModel->currentIndex = -1;
+        functionModel->updateList(functions, newFunctions, [](const FunctionDescription &function) {
+            return function.offset;
+        });
+        functionModel->seekChanged(Core()->getOffset());
+    }
 
-        // resize offset and size columns
-        qhelpers::adjustColumns(ui->functionsTreeView, 3, 0);
+    // resize offset and size columns
+    qhelpers::adjustColumns(ui->functionsTreeView, 3, 0);
 
-        tree->showItemsNumber(functionProxyModel->rowCount());
-    });
-    Core()->getAsyncTaskManager()->start(task);
+    tree->showItemsNumber(functionProxyModel->rowCount());
 }
 
 void FunctionsWidget::changeSizePolicy(QSizePolicy::Policy hor, QSizePolicy::Policy ver)
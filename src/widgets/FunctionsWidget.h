@@ -6,13 +6,15 @@
 #include <QSortFilterProxyModel>
 
 #include "core/Cutter.h"
+#include "core/AnalysisDataStore.h"
 #include "CutterDockWidget.h"
 #include "CutterTreeWidget.h"
 #include "CutterTreeView.h"
+#include "common/KeyedListModel.h"
+#include "common/ParallelSortFilterProxyModel.h"
 
 class MainWindow;
 class QTreeWidgetItem;
-class FunctionsTask;
 class FunctionsWidget;
 
 namespace Ui {
@@ -20,7 +22,7 @@ class FunctionsWidget;
 }
 
 
-class FunctionModel : public QAbstractItemModel
+class FunctionModel : public KeyedListModel<QAbstractItemModel>
 {
     Q_OBJECT
 
@@ -80,7 +82,7 @@ private slots:
 };
 
 
-class FunctionSortFilterProxyModel : public QSortFilterProxyModel
+class FunctionSortFilterProxyModel : public ParallelSortFilterProxyModel
 {
     Q_OBJECT
 
@@ -89,7 +91,15 @@ public:
 
 protected:
     bool filterAcceptsRow(int row, const QModelIndex &parent) const override;
-    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+    void cacheSortKeys() override;
+    void updateSortKeys(int first, int last) override;
+    bool sourceRowLessThan(int leftRow, int rightRow, int column) const override;
+    bool sourceRowMatches(int row, QRegExp &regExp) const override;
+
+private:
+    std::vector<FunctionDescription> sortFunctions;
+    std::vector<char> sortIsImport;
+    bool sortNested = false;
 };
 
 
@@ -114,6 +124,7 @@ private slots:
     void on_actionVertical_triggered();
     void showTitleContextMenu(const QPoint &pt);
     void refreshTree();
+    void onDataReady(AnalysisDataStore::Kind kind);
 
 protected:
     void resizeEvent(QResizeEvent *event) override;
@@ -121,10 +132,10 @@ protected:
 private:
     std::unique_ptr<Ui::FunctionsWidget> ui;
     MainWindow *main;
-    QSharedPointer<FunctionsTask> task;
     QList<FunctionDescription> functions;
+    QList<ImportDescription> imports;
     QSet<RVA> importAddresses;
-    ut64 mainAdress;
+    ut64 mainAdress = RVA_INVALID;
     FunctionModel *functionModel;
     FunctionSortFilterProxyModel *functionProxyModel;
     CutterTreeWidget *tree;
@@ -109,7 +109,7 @@ std::vector<ut64> GraphGridLayout::topoSort(LayoutState &state, unsigned long lo
 }
 
 void GraphGridLayout::CalculateLayout(std::unordered_map<ut64, GraphBlock> &blocks, ut64 entry,
-                                      int &width, int &height) const
+                                      int &width, int &height)
 {
     LayoutState layoutState;
     layoutState.blocks = &blocks;
@@ -168,15 +168,82 @@ void GraphGridLayout::CalculateLayout(std::unordered_map<ut64, GraphBlock> &bloc
                 col_edge_count[col] = int(vert_edges[row][col].size());
         }
     }
+    for (int i = 0; i < entryb.row_count; i++) {
+        // TODO: The 1 when row_edge_count is 0 is not needed on the original.. not sure why it's required for us
+        if (!row_edge_count[i]) {
+            row_edge_count[i] = 1;
+        }
+    }
+
+    placement.row_count = entryb.row_count;
+    placement.col_count = entryb.col_count;
+    placement.grid_blocks = std::move(layoutState.grid_blocks);
+    placement.edge = std::move(layoutState.edge);
+    placement.col_edge_count = std::move(col_edge_count);
+    placement.row_edge_count = std::move(row_edge_count);
+    placement.valid = true;
+
+    computeGeometry(blocks, width, height);
+}
 
+bool GraphGridLayout::UpdateBlockSizes(std::unordered_map<ut64, GraphBlock> &blocks, int &width,
+                                       int &height)
+{
+    if (!placementMatches(blocks)) {
+        return false;
+    }
+    computeGeometry(blocks, width, height);
+    return true;
+}
+
+bool GraphGridLayout::placementMatches(const std::unordered_map<ut64, GraphBlock> &blocks) const
+{
+    if (!placement.valid) {
+        return false;
+    }
+    size_t matched = 0;
+    for (auto &blockIt : blocks) {
+        const std::vector<GraphEdge> &edges = blockIt.second.edges;
+        auto edgesIt = placement.edge.find(blockIt.first);
+        if (edgesIt == placement.edge.end()) {
+            // Targets of edges leaving the graph only have a grid position
+            if (edges.empty() && placement.grid_blocks.count(blockIt.first)) {
+                continue;
+            }
+            return false;
+        }
+        const std::vector<GridEdge> &gridEdges = edgesIt->second;
+        if (gridEdges.size() != edges.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < edges.size(); i++) {
+            if (gridEdges[i].dest != edges[i].target) {
+                return false;
+            }
+        }
+        matched++;
+    }
+    return matched == placement.edge.size();
+}
+
+// Compute the pixel coordinates of blocks and edges from the grid placement.
+// Row heights and column widths are derived from the current block sizes, so this
+// is all that needs to be redone when blocks are resized.
+void GraphGridLayout::computeGeometry(std::unordered_map<ut64, GraphBlock> &blocks, int &width,
+                                      int &height) const
+{
+    const int row_count = placement.row_count;
+    const int col_count = placement.col_count;
+    const std::vector<int> &col_edge_count = placement.col_edge_count;
+    const std::vector<int> &row_edge_count = placement.row_edge_count;
 
     //Compute row and column sizes
     std::vector<int> col_width, row_height;
-    col_width.assign(entryb.col_count + 1, 0);
-    row_height.assign(entryb.row_count + 1, 0);
+    col_width.assign(col_count + 1, 0);
+    row_height.assign(row_count + 1, 0);
     for (auto &blockIt : blocks) {
         GraphBlock &block = blockIt.second;
-        GridBlock &grid_block = layoutState.grid_blocks[blockIt.first];
+        const GridBlock &grid_block = placement.grid_blocks.at(blockIt.first);
         if ((int(block.width / 2)) > col_width[grid_block.col])
             col_width[grid_block.col] = int(block.width / 2);
         if ((int(block.width / 2)) > col_width[grid_block.col + 1])
@@ -187,39 +254,35 @@ void GraphGridLayout::CalculateLayout(std::unordered_map<ut64, GraphBlock> &bloc
 
     // Compute row and column positions
     std::vector<int> col_x, row_y;
-    col_x.assign(entryb.col_count, 0);
-    row_y.assign(entryb.row_count, 0);
-    std::vector<int> col_edge_x(entryb.col_count + 1);
-    std::vector<int> row_edge_y(entryb.row_count + 1);
+    col_x.assign(col_count, 0);
+    row_y.assign(row_count, 0);
+    std::vector<int> col_edge_x(col_count + 1);
+    std::vector<int> row_edge_y(row_count + 1);
     int x = layoutConfig.block_horizontal_margin * 2;
-    for (int i = 0; i < entryb.col_count; i++) {
+    for (int i = 0; i < col_count; i++) {
         col_edge_x[i] = x;
         x += layoutConfig.block_horizontal_margin * col_edge_count[i];
         col_x[i] = x;
         x += col_width[i];
     }
     int y = layoutConfig.block_vertical_margin * 2;
-    for (int i = 0; i < entryb.row_count; i++) {
+    for (int i = 0; i < row_count; i++) {
         row_edge_y[i] = y;
-        // TODO: The 1 when row_edge_count is 0 is not needed on the original.. not sure why it's required for us
-        if (!row_edge_count[i]) {
-            row_edge_count[i] = 1;
-        }
         y += layoutConfig.block_vertical_margin * row_edge_count[i];
         row_y[i] = y;
         y += row_height[i];
     }
-    col_edge_x[entryb.col_count] = x;
-    row_edge_y[entryb.row_count] = y;
+    col_edge_x[col_count] = x;
+    row_edge_y[row_count] = y;
     width = x + (layoutConfig.block_horizontal_margin * 2) + (layoutConfig.block_horizontal_margin *
-                                                              col_edge_count[entryb.col_count]);
+                                                              col_edge_count[col_count]);
     height = y + (layoutConfig.block_vertical_margin * 2) + (layoutConfig.block_vertical_margin *
-                                                             row_edge_count[entryb.row_count]);
+                                                             row_edge_count[row_count]);
 
     //Compute node positions
     for (auto &blockIt : blocks) {
         GraphBlock &block = blockIt.second;
-        GridBlock &grid_block = layoutState.grid_blocks[blockIt.first];
+        const GridBlock &grid_block = placement.grid_blocks.at(blockIt.first);
         auto column = grid_block.col;
         auto row = grid_block.row;
         block.x = int(col_x[column] + col_width[column] +
@@ -239,9 +302,14 @@ void GraphGridLayout::CalculateLayout(std::unordered_map<ut64, GraphBlock> &bloc
     for (auto &blockIt : blocks) {
         GraphBlock &block = blockIt.second;
 
+        auto gridEdgesIt = placement.edge.find(blockIt.first);
+        if (gridEdgesIt == placement.edge.end()) {
+            continue;
+        }
         size_t index = 0;
-        assert(block.edges.size() == layoutState.edge[block.entry].size());
-        for (GridEdge &edge : layoutState.edge[block.entry]) {
+        const std::vector<GridEdge> &gridEdges = gridEdgesIt->second;
+        assert(block.edges.size() == gridEdges.size());
+        for (const GridEdge &edge : gridEdges) {
             if (edge.points.empty()) {
                 qDebug() << "Warning, unrouted edge.";
                 continue;
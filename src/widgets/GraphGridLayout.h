@@ -17,7 +17,10 @@ public:
     virtual void CalculateLayout(std::unordered_map<ut64, GraphBlock> &blocks,
                                  ut64 entry,
                                  int &width,
-                                 int &height) const override;
+                                 int &height) override;
+    virtual bool UpdateBlockSizes(std::unordered_map<ut64, GraphBlock> &blocks,
+                                  int &width,
+                                  int &height) override;
 private:
     LayoutType layoutType;
 
@@ -63,6 +66,25 @@ private:
         std::unordered_map<ut64, std::vector<GridEdge>> edge;
     };
 
+    /**
+     * @brief Grid placement and edge routing of the last CalculateLayout call.
+     * Only depends on the graph topology, so it can be reused when block sizes change.
+     */
+    struct Placement {
+        bool valid = false;
+        int row_count = 0;
+        int col_count = 0;
+        std::unordered_map<ut64, GridBlock> grid_blocks;
+        std::unordered_map<ut64, std::vector<GridEdge>> edge;
+        std::vector<int> col_edge_count;
+        std::vector<int> row_edge_count;
+    };
+
+    Placement placement;
+
+    bool placementMatches(const std::unordered_map<ut64, GraphBlock> &blocks) const;
+    void computeGeometry(std::unordered_map<ut64, GraphBlock> &blocks, int &width,
+                         int &height) const;
     void computeBlockPlacement(ut64 blockId,
                                LayoutState &layoutState) const;
     void adjustGraphLayout(GridBlock &block, std::unordered_map<ut64, GridBlock> &blocks,
@@ -0,0 +1,234 @@
+#include "GraphLayeredLayout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+GraphLayeredLayout::GraphLayeredLayout()
+    : GraphLayout({})
+{
+}
+
+std::vector<int> GraphLayeredLayout::assignLayers(const std::vector<std::vector<size_t>>
+                                                  &successors)
+{
+    // Longest path layering of an acyclic graph
+    size_t count = successors.size();
+    std::vector<int> layer(count, 0);
+    std::vector<size_t> inDegree(count, 0);
+    for (const auto &targets : successors) {
+        for (size_t target : targets) {
+            inDegree[target]++;
+        }
+    }
+    std::queue<size_t> queue;
+    for (size_t i = 0; i < count; i++) {
+        if (inDegree[i] == 0) {
+            queue.push(i);
+        }
+    }
+    while (!queue.empty()) {
+        size_t node = queue.front();
+        queue.pop();
+        for (size_t target : successors[node]) {
+            layer[target] = std::max(layer[target], layer[node] + 1);
+            if (--inDegree[target] == 0) {
+                queue.push(target);
+            }
+        }
+    }
+    return layer;
+}
+
+void GraphLayeredLayout::orderLayers(Layers &layers,
+                                     const std::vector<std::vector<size_t>> &predecessors)
+{
+    // Single top down barycenter sweep, positions are normalized by the layer size
+    // so that layers of very different width can be compared.
+    std::vector<double> position(predecessors.size(), 0.0);
+    std::vector<double> key(predecessors.size(), 0.0);
+    for (auto &layer : layers) {
+        for (size_t i = 0; i < layer.size(); i++) {
+            size_t node = layer[i];
+            double own = double(i) / layer.size();
+            if (predecessors[node].empty()) {
+                key[node] = own;
+                continue;
+            }
+            double sum = 0.0;
+            for (size_t pred : predecessors[node]) {
+                sum += position[pred];
+            }
+            key[node] = sum / predecessors[node].size();
+        }
+        std::stable_sort(layer.begin(), layer.end(), [&key](size_t a, size_t b) {
+            return key[a] < key[b];
+        });
+        for (size_t i = 0; i < layer.size(); i++) {
+            position[layer[i]] = double(i) / layer.size();
+        }
+    }
+}
+
+void GraphLayeredLayout::CalculateLayout(std::unordered_map<ut64, GraphBlock> &blocks,
+                                         ut64 entry,
+                                         int &width,
+                                         int &height)
+{
+    Q_UNUSED(entry);
+    width = 0;
+    height = 0;
+    if (blocks.empty()) {
+        return;
+    }
+
+    // Work on dense indices in address order so that the result is deterministic
+    std::vector<ut64> ids;
+    ids.reserve(blocks.size());
+    for (auto &blockIt : blocks) {
+        ids.push_back(blockIt.first);
+    }
+    std::sort(ids.begin(), ids.end());
+    std::unordered_map<ut64, size_t> index;
+    index.reserve(ids.size());
+    for (size_t i = 0; i < ids.size(); i++) {
+        index[ids[i]] = i;
+    }
+    size_t count = ids.size();
+    std::vector<std::vector<size_t>> successors(count);
+    std::vector<bool> hasPredecessor(count, false);
+    for (size_t i = 0; i < count; i++) {
+        for (const GraphEdge &edge : blocks[ids[i]].edges) {
+            auto targetIt = index.find(edge.target);
+            if (targetIt == index.end() || targetIt->second == i) {
+                continue;
+            }
+            successors[i].push_back(targetIt->second);
+            hasPredecessor[targetIt->second] = true;
+        }
+    }
+
+    // Break cycles by dropping DFS back edges, roots first so that
+    // the remaining edges point away from them.
+    std::vector<std::vector<size_t>> dagSuccessors(count);
+    std::vector<std::vector<size_t>> dagPredecessors(count);
+    {
+        enum class State : char { Unvisited, Active, Done };
+        std::vector<State> state(count, State::Unvisited);
+        std::vector<std::pair<size_t, size_t>> stack;
+        auto visit = [&](size_t root) {
+            if (state[root] != State::Unvisited) {
+                return;
+            }
+            state[root] = State::Active;
+            stack.emplace_back(root, 0);
+            while (!stack.empty()) {
+                size_t node = stack.back().first;
+                size_t next = stack.back().second;
+                if (next >= successors[node].size()) {
+                    state[node] = State::Done;
+                    stack.pop_back();
+                    continue;
+                }
+                stack.back().second++;
+                size_t target = successors[node][next];
+                if (state[target] == State::Active) {
+                    continue;
+                }
+                dagSuccessors[node].push_back(target);
+                dagPredecessors[target].push_back(node);
+                if (state[target] == State::Unvisited) {
+                    state[target] = State::Active;
+                    stack.emplace_back(target, 0);
+                }
+            }
+        };
+        for (size_t i = 0; i < count; i++) {
+            if (!hasPredecessor[i]) {
+                visit(i);
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            visit(i);
+        }
+    }
+
+    std::vector<int> layerOf = assignLayers(dagSuccessors);
+    int layerCount = *std::max_element(layerOf.begin(), layerOf.end()) + 1;
+    Layers layers(layerCount);
+    for (size_t i = 0; i < count; i++) {
+        layers[layerOf[i]].push_back(i);
+    }
+    orderLayers(layers, dagPredecessors);
+
+    // Wrap wide layers into multiple rows to keep the aspect ratio reasonable. Very deep
+    // graphs would still end up as a tall strip, so there consecutive narrow layers share a row.
+    size_t rowLimit = std::max<size_t>(16, size_t(2 * std::sqrt(double(count))));
+    bool packLayers = layers.size() > rowLimit;
+    struct Row {
+        std::vector<size_t> nodes;
+        int width = 0;
+        int height = 0;
+        bool firstOfLayer = false;
+    };
+    std::vector<Row> rows;
+    for (const auto &layer : layers) {
+        size_t start = 0;
+        if (packLayers && !rows.empty() && rows.back().nodes.size() + layer.size() <= rowLimit) {
+            Row &row = rows.back();
+            for (size_t node : layer) {
+                const GraphBlock &block = blocks[ids[node]];
+                row.nodes.push_back(node);
+                row.width += block.width + layoutConfig.block_horizontal_margin;
+                row.height = std::max(row.height, block.height);
+            }
+            width = std::max(width, row.width);
+            start = layer.size();
+        }
+        for (; start < layer.size(); start += rowLimit) {
+            Row row;
+            row.firstOfLayer = start == 0;
+            size_t end = std::min(layer.size(), start + rowLimit);
+            for (size_t i = start; i < end; i++) {
+                const GraphBlock &block = blocks[ids[layer[i]]];
+                row.nodes.push_back(layer[i]);
+                row.width += block.width + (i > start ? layoutConfig.block_horizontal_margin : 0);
+                row.height = std::max(row.height, block.height);
+            }
+            width = std::max(width, row.width);
+            rows.push_back(std::move(row));
+        }
+    }
+
+    int y = 0;
+    for (size_t r = 0; r < rows.size(); r++) {
+        const Row &row = rows[r];
+        if (r > 0) {
+            y += row.firstOfLayer ? 2 * layoutConfig.block_vertical_margin
+                 : layoutConfig.block_vertical_margin / 2;
+        }
+        int x = (width - row.width) / 2;
+        for (size_t node : row.nodes) {
+            GraphBlock &block = blocks[ids[node]];
+            block.x = x;
+            block.y = y;
+            x += block.width + layoutConfig.block_horizontal_margin;
+        }
+        y += row.height;
+    }
+    height = y;
+
+    for (auto &blockIt : blocks) {
+        GraphBlock &block = blockIt.second;
+        for (GraphEdge &edge : block.edges) {
+            edge.polyline.clear();
+            auto targetIt = blocks.find(edge.target);
+            if (targetIt == blocks.end() || edge.target == block.entry) {
+                continue;
+            }
+            const GraphBlock &target = targetIt->second;
+            edge.polyline.append(QPointF(block.x + block.width / 2, block.y + block.height));
+            edge.polyline.append(QPointF(target.x + target.width / 2, target.y));
+        }
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef GRAPHLAYEREDLAYOUT_H
+#define GRAPHLAYEREDLAYOUT_H
+
+#include "core/Cutter.h"
+#include "GraphLayout.h"
+
+/**
+ * @brief Layered layout for large graphs with many roots, like a whole program call graph.
+ *
+ * Unlike GraphGridLayout it does not assume a single entry and only routes edges as straight
+ * lines, so it runs in roughly linear time. Cycles are broken by ignoring DFS back edges,
+ * blocks are assigned to layers by longest path, ordered inside a layer by the barycenter of
+ * their predecessors and wide layers are wrapped into several rows.
+ */
+class GraphLayeredLayout : public GraphLayout
+{
+public:
+    GraphLayeredLayout();
+    virtual void CalculateLayout(std::unordered_map<ut64, GraphBlock> &blocks,
+                                 ut64 entry,
+                                 int &width,
+                                 int &height) override;
+
+private:
+    using Layers = std::vector<std::vector<size_t>>;
+
+    static std::vector<int> assignLayers(const std::vector<std::vector<size_t>> &successors);
+    static void orderLayers(Layers &layers, const std::vector<std::vector<size_t>> &predecessors);
+};
+
+#endif // GRAPHLAYEREDLAYOUT_H
@@ -32,7 +32,23 @@ public:
     GraphLayout(const LayoutConfig &layout_config) : layoutConfig(layout_config) {}
     virtual ~GraphLayout() {}
     virtual void CalculateLayout(std::unordered_map<ut64, GraphBlock> &blocks, ut64 entry, int &width,
-                                 int &height) const = 0;
+                                 int &height) = 0;
+
+    /**
+     * @brief Recompute block and edge coordinates after only the sizes of some blocks changed,
+     * reusing the placement of the previous CalculateLayout call.
+     * The set of blocks and edges must be the same as in the previous call.
+     * @return false if the layout doesn't support this or no placement can be reused,
+     * in which case CalculateLayout has to be called.
+     */
+    virtual bool UpdateBlockSizes(std::unordered_map<ut64, GraphBlock> &blocks, int &width,
+                                  int &height)
+    {
+        Q_UNUSED(blocks);
+        Q_UNUSED(width);
+        Q_UNUSED(height);
+        return false;
+    }
 protected:
     LayoutConfig layoutConfig;
 };
@@ -104,6 +104,16 @@ void GraphView::computeGraph(ut64 entry)
     viewport()->update();
 }
 
+void GraphView::computeGraphGeometry()
+{
+    if (!graphLayoutSystem->UpdateBlockSizes(blocks, width, height)) {
+        graphLayoutSystem->CalculateLayout(blocks, entry, width, height);
+    }
+    ready = true;
+
+    viewport()->update();
+}
+
 QPolygonF GraphView::recalculatePolygon(QPolygonF polygon)
 {
     QPolygonF ret;
@@ -117,10 +127,6 @@ void GraphView::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
     qreal dpr = devicePixelRatioF();
-    if (useCache && qFuzzyCompare(dpr, pixmap.devicePixelRatioF())) {
-        drawGraph();
-        return;
-    }
     pixmap = QPixmap(int(viewport()->width() * dpr), int(viewport()->height() * dpr));
     pixmap.setDevicePixelRatio(dpr);
     QPainter p(&pixmap);
@@ -9,6 +9,7 @@
 #include <QElapsedTimer>
 #include <QHelpEvent>
 
+#include <map>
 #include <unordered_map>
 #include <unordered_set>
 #include <queue>
@@ -33,6 +34,20 @@ public:
         bool end_arrow = true;
         qreal width_scale = 1.0;
     };
+    using EdgeConfigurationMapping = std::map<std::pair<ut64, ut64>, EdgeConfiguration>;
+
+    /**
+     * @brief Immutable copy of a laid out graph, shared by reference between views.
+     * A new snapshot is created whenever the graph changes, so comparing pointers
+     * is enough to detect changes.
+     */
+    struct GraphSnapshot {
+        int width = 0;
+        int height = 0;
+        std::unordered_map<ut64, GraphBlock> blocks;
+        EdgeConfigurationMapping edgeConfigurations;
+    };
+    using GraphSnapshotPtr = std::shared_ptr<const GraphSnapshot>;
 
     explicit GraphView(QWidget *parent);
     ~GraphView() override;
@@ -46,15 +61,8 @@ public:
 
     QPoint offset = QPoint(0, 0);
 
-    /**
-     * @brief flag to control if the cached pixmap should be used
-     */
-    bool useCache = false;
-
     /**
      * @brief keep the current addr of the fcn of Graph
-     * Everytime overview updates its contents, it compares this value with the one in Graph
-     * if they aren't same, then Overview needs to update the pixmap cache.
      */
     ut64 currentFcnAddr = 0; // TODO: move application specific code out of graph view
 
@@ -69,6 +77,12 @@ protected:
     void addBlock(GraphView::GraphBlock block);
     void setEntry(ut64 e);
     void computeGraph(ut64 entry);
+    /**
+     * @brief Update block and edge coordinates after only the sizes of blocks changed.
+     * Reuses the row/column placement of the last computeGraph call if the graph
+     * topology is the same, otherwise falls back to a full layout.
+     */
+    void computeGraphGeometry();
 
     // Callbacks that should be overridden
     virtual void drawBlock(QPainter &p, GraphView::GraphBlock &block);
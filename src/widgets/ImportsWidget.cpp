@@ -170,14 +170,29 @@ ImportsWidget::ImportsWidget(MainWindow *main, QAction *action) :
     setScrollMode();
 
     connect(Core(), SIGNAL(refreshAll()), this, SLOT(refreshImports()));
+    connect(Core()->getDataStore(), &AnalysisDataStore::dataReady, this,
+            &ImportsWidget::onDataReady);
 }
 
 ImportsWidget::~ImportsWidget() {}
 
 void ImportsWidget::refreshImports()
 {
+    Core()->getDataStore()->request(AnalysisDataStore::Kind::Imports);
+}
+
+void ImportsWidget::onDataReady(AnalysisDataStore::Kind kind)
+{
+    if (kind != AnalysisDataStore::Kind::Imports) {
+        return;
+    }
+    QList<ImportDescription> newImports = Core()->getDataStore()->getImports();
+    if (newImports.isSharedWith(imports)) {
+        return;
+    }
+
     importsModel->beginResetModel();
-    imports = Core()->getAllImports();
+    imports = newImports;
     importsModel->endResetModel();
     qhelpers::adjustColumns(ui->importsTreeView, 4, 0);
 
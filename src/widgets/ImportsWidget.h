@@ -11,6 +11,7 @@
 
 #include "CutterDockWidget.h"
 #include "core/Cutter.h"
+#include "core/AnalysisDataStore.h"
 #include "CutterTreeWidget.h"
 
 class MainWindow;
@@ -82,6 +83,7 @@ private slots:
     void on_importsTreeView_doubleClicked(const QModelIndex &index);
 
     void refreshImports();
+    void onDataReady(AnalysisDataStore::Kind kind);
 
 private:
     std::unique_ptr<Ui::ImportsWidget> ui;
@@ -1,11 +1,16 @@
 #include "Omnibar.h"
 #include "core/MainWindow.h"
 
-#include <QStringListModel>
+#include <QStandardItemModel>
 #include <QCompleter>
 #include <QShortcut>
 #include <QAbstractItemView>
 
+namespace {
+
+const int maxCompletions = 50;
+
+}
 
 Omnibar::Omnibar(MainWindow *main, QWidget *parent) :
     QLineEdit(parent),
@@ -14,51 +19,181 @@ Omnibar::Omnibar(MainWindow *main, QWidget *parent) :
     // QLineEdit basic features
     this->setMinimumHeight(16);
     this->setFrame(false);
-    this->setPlaceholderText(tr("Type flag name or address here"));
+    this->setPlaceholderText(tr("Type name, string or address here"));
     this->setStyleSheet("border-radius: 5px; padding: 0 8px; margin: 5px 0;");
     this->setTextMargins(10, 0, 0, 0);
     this->setClearButtonEnabled(true);
 
+    setupCompleter();
+
     connect(this, SIGNAL(returnPressed()), this, SLOT(on_gotoEntry_returnPressed()));
+    connect(this, &QLineEdit::textEdited, this, &Omnibar::updateCompletions);
 
     // Esc clears omnibar
     QShortcut *clear_shortcut = new QShortcut(QKeySequence(Qt::Key_Escape), this);
     connect(clear_shortcut, SIGNAL(activated()), this, SLOT(clear()));
     clear_shortcut->setContext(Qt::WidgetWithChildrenShortcut);
+
+    // The data of one change arrives kind by kind, build the index once for all of them
+    rebuildTimer.setSingleShot(true);
+    rebuildTimer.setInterval(250);
+    connect(&rebuildTimer, &QTimer::timeout, this, &Omnibar::rebuildIndex);
+
+    connect(Core(), SIGNAL(refreshAll()), this, SLOT(refreshIndex()));
+    connect(Core(), SIGNAL(flagsChanged()), this, SLOT(refreshIndex()));
+    connect(Core(), SIGNAL(functionsChanged()), this, SLOT(refreshIndex()));
+    connect(Core(), &CutterCore::seekChanged, this, [this]() {
+        recencyValid = false;
+    });
+    connect(Core()->getDataStore(), &AnalysisDataStore::dataReady, this, &Omnibar::onDataReady);
 }
 
 void Omnibar::setupCompleter()
 {
-    // Set gotoEntry completer for jump history
-    QCompleter *completer = new QCompleter(flags, this);
+    // The model only holds the best matches of the current text, ranked by the index
+    completionModel = new QStandardItemModel(this);
+    QCompleter *completer = new QCompleter(completionModel, this);
     completer->setMaxVisibleItems(20);
-    completer->setCompletionMode(QCompleter::PopupCompletion);
-    completer->setModelSorting(QCompleter::CaseSensitivelySortedModel);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
     completer->setCaseSensitivity(Qt::CaseInsensitive);
-    completer->setFilterMode(Qt::MatchContains);
 
     this->setCompleter(completer);
 }
 
-void Omnibar::refresh(const QStringList &flagList)
+void Omnibar::refreshIndex()
 {
-    flags = flagList;
+    AnalysisDataStore *store = Core()->getDataStore();
+    store->request(AnalysisDataStore::Kind::Functions);
+    store->request(AnalysisDataStore::Kind::Symbols);
+    store->request(AnalysisDataStore::Kind::Flags);
+    store->request(AnalysisDataStore::Kind::Strings);
+}
 
-    setupCompleter();
+void Omnibar::onDataReady(AnalysisDataStore::Kind kind)
+{
+    AnalysisDataStore *store = Core()->getDataStore();
+    switch (kind) {
+    case AnalysisDataStore::Kind::Functions:
+        if (store->getFunctions().isSharedWith(functionsSnapshot)) {
+            return;
+        }
+        break;
+    case AnalysisDataStore::Kind::Symbols:
+        if (store->getSymbols().isSharedWith(symbolsSnapshot)) {
+            return;
+        }
+        break;
+    case AnalysisDataStore::Kind::Flags:
+        if (store->getFlags().isSharedWith(flagsSnapshot)) {
+            return;
+        }
+        break;
+    case AnalysisDataStore::Kind::Strings:
+        if (store->getStrings() == stringsSnapshot) {
+            return;
+        }
+        break;
+    default:
+        return;
+    }
+    rebuildTimer.start();
 }
 
-void Omnibar::restoreCompleter()
+void Omnibar::rebuildIndex()
 {
-    QCompleter *completer = this->completer();
-    if (!completer) {
+    AnalysisDataStore *store = Core()->getDataStore();
+    functionsSnapshot = store->getFunctions();
+    symbolsSnapshot = store->getSymbols();
+    flagsSnapshot = store->getFlags();
+    // The strings are still appended to while they are fetched
+    stringsSnapshot = store->isFetching(AnalysisDataStore::Kind::Strings)
+                      ? QSharedPointer<const CompactStringList>()
+                      : store->getStrings();
+
+    if (indexTask) {
+        disconnect(indexTask.data(), nullptr, this, nullptr);
+        indexTask->interrupt();
+    }
+    FuzzyIndexTask *task = new FuzzyIndexTask(functionsSnapshot, symbolsSnapshot, flagsSnapshot,
+                                              stringsSnapshot);
+    indexTask = AsyncTask::Ptr(task);
+    connect(task, &AsyncTask::finished, this, [this, task]() {
+        if (indexTask.data() != task) {
+            return;
+        }
+        indexTask.clear();
+        if (task->getIndex()) {
+            index = task->getIndex();
+            resetCompletions();
+        }
+    });
+    Core()->getAsyncTaskManager()->start(indexTask);
+}
+
+const QHash<RVA, int> &Omnibar::recencyRanks()
+{
+    if (!recencyValid) {
+        // The history is ordered from the oldest to the newest seek
+        QList<RVA> history = Core()->getSeekHistory();
+        recency.clear();
+        int rank = 0;
+        for (int i = history.size() - 1; i >= 0; i--) {
+            if (!recency.contains(history.at(i))) {
+                recency.insert(history.at(i), rank++);
+            }
+        }
+        recencyValid = true;
+    }
+    return recency;
+}
+
+void Omnibar::updateCompletions(const QString &text)
+{
+    if (!index || text.trimmed().isEmpty()) {
+        resetCompletions();
         return;
     }
-    completer->setFilterMode(Qt::MatchContains);
+
+    bool narrow = !lastQuery.isEmpty() && text.startsWith(lastQuery);
+    std::vector<quint32> matching;
+    QVector<FuzzyIndex::Match> matches = index->search(text, maxCompletions, recencyRanks(),
+                                                       narrow ? &lastMatching : nullptr,
+                                                       &matching);
+    lastQuery = text;
+    lastMatching.swap(matching);
+
+    completionModel->clear();
+    completionAddresses.clear();
+    for (const FuzzyIndex::Match &match : matches) {
+        const FuzzyIndex::Entry &entry = index->entry(match.entry);
+        QStandardItem *item = new QStandardItem(entry.name);
+        item->setToolTip(QString("%1 @ %2").arg(FuzzyIndex::kindName(entry.kind),
+                                                RAddressString(entry.address)));
+        completionModel->appendRow(item);
+        if (!completionAddresses.contains(entry.name)) {
+            completionAddresses.insert(entry.name, entry.address);
+        }
+    }
+
+    if (matches.isEmpty()) {
+        completer()->popup()->hide();
+    } else {
+        completer()->complete();
+    }
+}
+
+void Omnibar::resetCompletions()
+{
+    lastQuery.clear();
+    lastMatching.clear();
+    completionModel->clear();
+    completionAddresses.clear();
 }
 
 void Omnibar::clear()
 {
     QLineEdit::clear();
+    resetCompletions();
 
     // Close the potential shown completer popup
     clearFocus();
@@ -69,10 +204,15 @@ void Omnibar::on_gotoEntry_returnPressed()
 {
     QString str = this->text();
     if (!str.isEmpty()) {
-        Core()->seek(str);
+        auto it = completionAddresses.constFind(str);
+        if (it != completionAddresses.constEnd()) {
+            Core()->seek(it.value());
+        } else {
+            Core()->seek(str);
+        }
     }
 
     this->setText("");
     this->clearFocus();
-    this->restoreCompleter();
+    resetCompletions();
 }
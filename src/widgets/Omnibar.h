@@ -2,8 +2,15 @@
 #define OMNIBAR_H
 
 #include <QLineEdit>
+#include <QTimer>
+
+#include <vector>
+
+#include "core/AnalysisDataStore.h"
+#include "common/FuzzyIndex.h"
 
 class MainWindow;
+class QStandardItemModel;
 
 class Omnibar : public QLineEdit
 {
@@ -11,21 +18,41 @@ class Omnibar : public QLineEdit
 public:
     explicit Omnibar(MainWindow *main, QWidget *parent = nullptr);
 
-    void refresh(const QStringList &flagList);
-
 private slots:
+    void refreshIndex();
+    void onDataReady(AnalysisDataStore::Kind kind);
+    void rebuildIndex();
+    void updateCompletions(const QString &text);
     void on_gotoEntry_returnPressed();
 
-    void restoreCompleter();
-
 public slots:
     void clear();
 
 private:
     void setupCompleter();
+    void resetCompletions();
+    const QHash<RVA, int> &recencyRanks();
 
     MainWindow          *main;
-    QStringList         flags;
+
+    QList<FunctionDescription> functionsSnapshot;
+    QList<SymbolDescription> symbolsSnapshot;
+    QList<FlagDescription> flagsSnapshot;
+    QSharedPointer<const CompactStringList> stringsSnapshot;
+
+    QSharedPointer<const FuzzyIndex> index;
+    AsyncTask::Ptr      indexTask;
+    QTimer              rebuildTimer;
+
+    QStandardItemModel  *completionModel;
+    // Address of each completion shown, strings can't be seeked to by their text
+    QHash<QString, RVA> completionAddresses;
+    // Entries matching lastQuery, the next query is searched among these if it extends it
+    QString             lastQuery;
+    std::vector<quint32> lastMatching;
+
+    QHash<RVA, int>     recency;
+    bool                recencyValid = false;
 };
 
 #endif // OMNIBAR_H
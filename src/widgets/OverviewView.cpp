@@ -14,14 +14,14 @@ OverviewView::OverviewView(QWidget *parent)
     colorsUpdatedSlot();
 }
 
-void OverviewView::setData(int baseWidth, int baseHeight,
-                           std::unordered_map<ut64, GraphBlock> baseBlocks,
-                           DisassemblerGraphView::EdgeConfigurationMapping baseEdgeConfigurations)
+void OverviewView::setData(GraphSnapshotPtr snapshot)
 {
-    width = baseWidth;
-    height = baseHeight;
-    blocks = baseBlocks;
-    edgeConfigurations = baseEdgeConfigurations;
+    if (snapshot != graphSnapshot) {
+        graphSnapshot = snapshot;
+        width = graphSnapshot ? graphSnapshot->width : 0;
+        height = graphSnapshot ? graphSnapshot->height : 0;
+        cacheValid = false;
+    }
     scaleAndCenter();
 }
 
@@ -31,12 +31,20 @@ OverviewView::~OverviewView()
 
 void OverviewView::scaleAndCenter()
 {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    qreal oldScale = current_scale;
+    QPoint oldOffset = offset;
     current_scale = (qreal)viewport()->width() / width;
     qreal h_scale = (qreal)viewport()->height() / height;
     if (current_scale > h_scale) {
         current_scale = h_scale;
     }
     center();
+    if (!qFuzzyCompare(oldScale, current_scale) || oldOffset != offset) {
+        cacheValid = false;
+    }
 }
 
 void OverviewView::refreshView()
@@ -45,43 +53,91 @@ void OverviewView::refreshView()
     viewport()->update();
 }
 
-void OverviewView::drawBlock(QPainter &p, GraphView::GraphBlock &block)
+void OverviewView::renderCache()
 {
-    int blockX = block.x - offset.x();
-    int blockY = block.y - offset.y();
-
-    p.setPen(Qt::black);
-    p.setBrush(Qt::gray);
-    p.drawRect(blockX, blockY, block.width, block.height);
-    p.setBrush(QColor(0, 0, 0, 100));
-    p.drawRect(blockX + 2, blockY + 2,
-               block.width, block.height);
-
-    // Draw basic block highlighting/tracing
-    auto bb = Core()->getBBHighlighter()->getBasicBlock(block.entry);
-    if (bb) {
-        QColor color(bb->color);
-        color.setAlphaF(0.5);
-        p.setBrush(color);
-    } else {
-        p.setBrush(disassemblyBackgroundColor);
+    qreal dpr = devicePixelRatioF();
+    cache = QImage(int(viewport()->width() * dpr), int(viewport()->height() * dpr),
+                   QImage::Format_ARGB32_Premultiplied);
+    cache.setDevicePixelRatio(dpr);
+    cache.fill(backgroundColor);
+    cacheValid = true;
+    cacheHighlightGeneration = Core()->getBBHighlighter()->getGeneration();
+    if (!graphSnapshot) {
+        return;
+    }
+
+    QPainter p(&cache);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.scale(current_scale, current_scale);
+    p.translate(-offset.x(), -offset.y());
+
+    for (const auto &blockIt : graphSnapshot->blocks) {
+        const GraphBlock &block = blockIt.second;
+        for (const GraphEdge &edge : block.edges) {
+            if (edge.polyline.empty()) {
+                continue;
+            }
+            EdgeConfiguration ec;
+            auto ecIt = graphSnapshot->edgeConfigurations.find({block.entry, edge.target});
+            if (ecIt != graphSnapshot->edgeConfigurations.end()) {
+                ec = ecIt->second;
+            }
+            QPen pen(ec.color);
+            pen.setCosmetic(true);
+            p.setPen(pen);
+            p.setBrush(Qt::NoBrush);
+            p.drawPolyline(edge.polyline);
+        }
+    }
+
+    for (const auto &blockIt : graphSnapshot->blocks) {
+        const GraphBlock &block = blockIt.second;
+        p.setPen(Qt::NoPen);
+        p.setBrush(QColor(0, 0, 0, 100));
+        p.drawRect(block.x + 2, block.y + 2, block.width, block.height);
+
+        // Draw basic block highlighting/tracing
+        auto bb = Core()->getBBHighlighter()->getBasicBlock(block.entry);
+        if (bb) {
+            QColor color(bb->color);
+            color.setAlphaF(0.5);
+            p.setBrush(color);
+        } else {
+            p.setBrush(disassemblyBackgroundColor);
+        }
+        QPen pen(graphNodeColor, 1);
+        pen.setCosmetic(true);
+        p.setPen(pen);
+        p.drawRect(block.x, block.y, block.width, block.height);
     }
-    p.setPen(QPen(graphNodeColor, 1));
-    p.drawRect(blockX, blockY,
-               block.width, block.height);
 }
 
 void OverviewView::paintEvent(QPaintEvent *event)
 {
-    GraphView::paintEvent(event);
+    Q_UNUSED(event);
+    qreal dpr = devicePixelRatioF();
+    if (!cacheValid || cacheHighlightGeneration != Core()->getBBHighlighter()->getGeneration()
+            || !qFuzzyCompare(dpr, cache.devicePixelRatioF())
+            || cache.width() != int(viewport()->width() * dpr)
+            || cache.height() != int(viewport()->height() * dpr)) {
+        renderCache();
+    }
+
+    QPainter p(viewport());
+    p.drawImage(QPointF(0, 0), cache);
     if (rangeRect.width() == 0 && rangeRect.height() == 0) {
         return;
     }
-    QPainter p(viewport());
     p.setPen(Qt::red);
     p.drawRect(rangeRect);
 }
 
+void OverviewView::resizeEvent(QResizeEvent *event)
+{
+    GraphView::resizeEvent(event);
+    scaleAndCenter();
+}
+
 bool OverviewView::mouseContainsRect(QMouseEvent *event)
 {
     if (rangeRect.contains(event->pos())) {
@@ -102,7 +158,6 @@ void OverviewView::mousePressEvent(QMouseEvent *event)
     qreal x = event->localPos().x() - w / 2;
     qreal y = event->localPos().y() - h / 2;
     rangeRect = QRectF(x, y, w, h);
-    useCache = true;
     viewport()->update();
     emit mouseMoved();
     mouseContainsRect(event);
@@ -122,7 +177,6 @@ void OverviewView::mouseMoveEvent(QMouseEvent *event)
     qreal x = event->localPos().x() - initialDiff.x();
     qreal y = event->localPos().y() - initialDiff.y();
     rangeRect = QRectF(x, y, rangeRect.width(), rangeRect.height());
-    useCache = true;
     viewport()->update();
     emit mouseMoved();
 }
@@ -132,21 +186,11 @@ void OverviewView::wheelEvent(QWheelEvent *event)
     event->ignore();
 }
 
-GraphView::EdgeConfiguration OverviewView::edgeConfiguration(GraphView::GraphBlock &from,
-                                                             GraphView::GraphBlock *to)
-{
-    EdgeConfiguration ec;
-    auto baseEcIt = edgeConfigurations.find({from.entry, to->entry});
-    if (baseEcIt != edgeConfigurations.end())
-        ec = baseEcIt->second;
-    ec.width_scale = current_scale;
-    return ec;
-}
-
 void OverviewView::colorsUpdatedSlot()
 {
     disassemblyBackgroundColor = ConfigColor("gui.overview.node");
     graphNodeColor = ConfigColor("gui.border");
     backgroundColor = ConfigColor("gui.background");
+    cacheValid = false;
     refreshView();
 }
@@ -4,6 +4,7 @@
 #include <QWidget>
 #include <QPainter>
 #include <QRect>
+#include <QImage>
 #include "widgets/GraphView.h"
 #include "widgets/DisassemblerGraphView.h"
 
@@ -28,14 +29,11 @@ public:
     QRectF rangeRect;
 
     /**
-     * @brief Graph access this function to set minimum set of the data
-     * @param baseWidth width of Graph when it computed the blocks
-     * @param baseHeigh height of Graph when it computed the blocks
-     * @param baseBlocks computed blocks passed by Graph
-     * @param baseEdgeConfigurations computed by DisassamblerGraphview
+     * @brief Graph access this function to share its current layout with Overview
+     * @param snapshot laid out blocks and edge styles of Graph, only referenced, not copied.
+     * Overview is only redrawn if this is a different snapshot than the previous one.
      */
-    void setData(int baseWidth, int baseHeight, std::unordered_map<ut64, GraphBlock> baseBlocks,
-                 DisassemblerGraphView::EdgeConfigurationMapping baseEdgeConfigurations);
+    void setData(GraphSnapshotPtr snapshot);
 
 public slots:
     /**
@@ -67,6 +65,10 @@ protected:
      * @brief override this to prevent scrolling
      */
     void wheelEvent(QWheelEvent *event) override;
+    /**
+     * @brief rescale the nodes to the new size
+     */
+    void resizeEvent(QResizeEvent *event) override;
 
 private:
     /**
@@ -88,20 +90,12 @@ private:
     void scaleAndCenter();
 
     /**
-     * @brief draw the computed blocks passed by Graph
-     */
-    virtual void drawBlock(QPainter &p, GraphView::GraphBlock &block) override;
-
-    /**
-     * @brief override the edgeConfiguration so as to
-     * adjust the width of the edges by the scale
-     * @return EdgeConfiguration
+     * @brief draw the blocks and edges of the snapshot scaled down into the cached image
      */
-    virtual GraphView::EdgeConfiguration edgeConfiguration(GraphView::GraphBlock &from,
-                                                           GraphView::GraphBlock *to) override;
+    void renderCache();
 
     /**
-     * @brief override the paintEvent to draw the rect on Overview
+     * @brief override the paintEvent to draw the cached image and the rect on Overview
      */
     void paintEvent(QPaintEvent *event) override;
 
@@ -121,9 +115,18 @@ private:
     QColor graphNodeColor;
 
     /**
-     * @brief edgeConfigurations edge styles computed by DisassemblerGraphView
+     * @brief graphSnapshot blocks and edge styles shared by DisassemblerGraphView
+     */
+    GraphSnapshotPtr graphSnapshot;
+
+    /**
+     * @brief cache downscaled rendering of graphSnapshot, only the rect is drawn on top of it
+     * while the graph is scrolled
      */
-    DisassemblerGraphView::EdgeConfigurationMapping edgeConfigurations;
+    QImage cache;
+    bool cacheValid = false;
+    // Generation of the basic block highlighter the cache was drawn with
+    quint64 cacheHighlightGeneration = 0;
 };
 
 #endif // OVERVIEWVIEW_H
@@ -2,11 +2,18 @@
 #include "ui_SearchWidget.h"
 #include "core/MainWindow.h"
 #include "common/Helpers.h"
+#include "core/ImmediateIndex.h"
+#include "core/TextIndex.h"
 
 #include <QDockWidget>
 #include <QTreeWidget>
 #include <QComboBox>
 #include <QShortcut>
+#include <QProgressBar>
+#include <QFileDialog>
+#include <QElapsedTimer>
+
+#include <algorithm>
 
 static const QMap<QString, QString> kSearchBoundariesValues {
     {"io.maps", "All maps"},
@@ -21,8 +28,12 @@ static const QMap<QString, QString> kSearchBoundariesValues {
     {"dbg.heap", "Heap"}
    };
 
+// Searched in the indexes of the data store instead of by r2
+static const char *const kImmediateIndexSpace = "immediates";
+static const char *const kTextIndexSpace = "text";
+
 SearchModel::SearchModel(QList<SearchDescription> *search, QObject *parent)
-    : QAbstractListModel(parent),
+    : KeyedListModel(parent),
       search(search)
 {
 }
@@ -86,6 +97,23 @@ QVariant SearchModel::headerData(int section, Qt::Orientation, int role) const
     }
 }
 
+void SearchModel::clear()
+{
+    beginResetModel();
+    search->clear();
+    endResetModel();
+}
+
+void SearchModel::append(const QList<SearchDescription> &hits)
+{
+    if (hits.isEmpty()) {
+        return;
+    }
+    beginInsertRows(QModelIndex(), search->count(), search->count() + hits.count() - 1);
+    search->append(hits);
+    endInsertRows();
+}
+
 
 SearchSortFilterProxyModel::SearchSortFilterProxyModel(SearchModel *source_model, QObject *parent)
     : QSortFilterProxyModel(parent)
@@ -145,6 +173,7 @@ SearchWidget::SearchWidget(MainWindow *main, QAction *action) :
     setScrollMode();
 
     connect(Core(), SIGNAL(refreshAll()), this, SLOT(refreshSearchspaces()));
+    connect(Core()->getDataStore(), &AnalysisDataStore::dataReady, this, &SearchWidget::onDataReady);
 
     QShortcut *enter_press = new QShortcut(QKeySequence(Qt::Key_Return), this);
     connect(enter_press, &QShortcut::activated, this, [this]() {
@@ -156,14 +185,35 @@ SearchWidget::SearchWidget(MainWindow *main, QAction *action) :
         refreshSearch();
     });
 
+    ui->patternFileButton->hide();
+    connect(ui->patternFileButton, &QAbstractButton::clicked, this, [this]() {
+        QString fileName = QFileDialog::getOpenFileName(this, tr("Choose a pattern set file"),
+                                                        ui->filterLineEdit->text());
+        if (!fileName.isEmpty()) {
+            ui->filterLineEdit->setText(fileName);
+            refreshSearch();
+        }
+    });
+
+    ui->searchProgressBar->hide();
+    ui->cancelSearchButton->hide();
+    connect(ui->cancelSearchButton, &QAbstractButton::clicked, this, &SearchWidget::cancelSearch);
+
     connect(ui->searchspaceCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
-    [ = ](int index) { updatePlaceholderText(index);});
+    [ = ](int index) {
+        updatePlaceholderText(index);
+        ui->patternFileButton->setVisible(ui->searchspaceCombo->itemData(index).toString()
+                                          == SearchTask::patternSetSpace);
+    });
 
     QString currentSearchBoundary = Core()->getConfig("search.in");
     ui->searchInCombo->setCurrentIndex(ui->searchInCombo->findData(currentSearchBoundary));
 }
 
-SearchWidget::~SearchWidget() {}
+SearchWidget::~SearchWidget()
+{
+    cancelSearch();
+}
 
 void SearchWidget::on_searchTreeView_doubleClicked(const QModelIndex &index)
 {
@@ -192,6 +242,9 @@ void SearchWidget::refreshSearchspaces()
     ui->searchspaceCombo->addItem(tr("hex string"), QVariant("/xj"));
     ui->searchspaceCombo->addItem(tr("ROP gadgets"), QVariant("/Rj"));
     ui->searchspaceCombo->addItem(tr("32bit value"), QVariant("/vj"));
+    ui->searchspaceCombo->addItem(tr("pattern set file"), QVariant(SearchTask::patternSetSpace));
+    ui->searchspaceCombo->addItem(tr("immediate value"), QVariant(kImmediateIndexSpace));
+    ui->searchspaceCombo->addItem(tr("disassembly text"), QVariant(kTextIndexSpace));
 
     if (cur_idx > 0)
         ui->searchspaceCombo->setCurrentIndex(cur_idx);
@@ -205,11 +258,285 @@ void SearchWidget::refreshSearch()
     QVariant searchspace_data = ui->searchspaceCombo->currentData();
     QString searchspace = searchspace_data.toString();
 
-    search_model->beginResetModel();
-    search = Core()->getAllSearch(search_for, searchspace);
-    search_model->endResetModel();
+    // The previous search is dropped entirely, so its last hits and its status can't end up
+    // in the new results
+    if (searchTask) {
+        disconnect(searchTask.data(), nullptr, this, nullptr);
+        searchTask->interrupt();
+        searchTask.clear();
+    }
+    ui->searchProgressBar->hide();
+    ui->cancelSearchButton->hide();
+    search_model->clear();
+    waitingForIndex = AnalysisDataStore::Kind::Count;
+    ui->searchStatusLabel->setToolTip(QString());
+    if (search_for.isEmpty()) {
+        ui->searchStatusLabel->clear();
+        return;
+    }
+    if (searchspace == kImmediateIndexSpace) {
+        searchImmediates();
+        return;
+    }
+    if (searchspace == kTextIndexSpace) {
+        searchText();
+        return;
+    }
+
+    QList<SearchTask::Range> ranges;
+    if (searchspace != SearchTask::patternSetSpace) {
+        ranges = searchRanges();
+    }
+    searchTask = QSharedPointer<SearchTask>(new SearchTask(search_for, searchspace, ranges,
+                                                           ui->hitLimitSpinBox->value()));
+    SearchTask *task = searchTask.data();
+    connect(task, &SearchTask::hitsAvailable, this, [this, task]() {
+        takeSearchHits(task);
+    });
+    connect(task, &AsyncTask::finished, this, [this, task]() {
+        searchFinished(task);
+    });
+
+    ui->searchProgressBar->setRange(0, task->getTotal());
+    ui->searchProgressBar->setValue(0);
+    ui->searchProgressBar->show();
+    ui->cancelSearchButton->show();
+    ui->searchStatusLabel->setText(tr("Searching..."));
+    Core()->getAsyncTaskManager()->start(searchTask);
+}
+
+void SearchWidget::onDataReady(AnalysisDataStore::Kind kind)
+{
+    if (kind != waitingForIndex) {
+        return;
+    }
+    waitingForIndex = AnalysisDataStore::Kind::Count;
+    if (kind == AnalysisDataStore::Kind::Immediates) {
+        searchImmediates();
+    } else if (kind == AnalysisDataStore::Kind::Text) {
+        searchText();
+    }
+}
+
+bool SearchWidget::waitForIndex(AnalysisDataStore::Kind kind, const QString &status)
+{
+    AnalysisDataStore *store = Core()->getDataStore();
+    if (store->isCurrent(kind)) {
+        return false;
+    }
+    // Continued by onDataReady
+    waitingForIndex = kind;
+    ui->searchStatusLabel->setText(status);
+    store->request(kind);
+    return true;
+}
+
+void SearchWidget::searchImmediates()
+{
+    if (waitForIndex(AnalysisDataStore::Kind::Immediates,
+                     tr("Indexing the immediates of all functions..."))) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QSharedPointer<const ImmediateIndex> index = Core()->getDataStore()->getImmediateIndex();
+    ut64 value = Core()->math(ui->filterLineEdit->text());
+    QVector<RVA> addresses = index ? index->find(value) : QVector<RVA>();
+    int limit = ui->hitLimitSpinBox->value();
+    bool limitReached = limit > 0 && addresses.size() > limit;
+    if (limitReached) {
+        addresses.resize(limit);
+    }
+
+    QList<QPair<int, QString>> instructions = Core()->disassembleInstructions(addresses);
+    QList<SearchDescription> hits;
+    for (int i = 0; i < addresses.size(); i++) {
+        SearchDescription hit;
+        hit.offset = addresses.at(i);
+        hit.size = static_cast<RVA>(instructions.at(i).first);
+        hit.code = instructions.at(i).second;
+        hit.data = RAddressString(value);
+        hits << hit;
+    }
+    search_model->append(hits);
+    qhelpers::adjustColumns(ui->searchTreeView, 3, 0);
+
+    QString summary = tr("%n hit(s) in %1 ms", nullptr, hits.size()).arg(timer.elapsed());
+    if (limitReached) {
+        summary += tr(", stopped at the hit limit");
+    }
+    ui->searchStatusLabel->setText(summary);
+    if (index) {
+        ui->searchStatusLabel->setToolTip(tr("%1 values in %2 functions indexed")
+                                          .arg(index->valueCount())
+                                          .arg(index->functionCount()));
+    }
+}
+
+void SearchWidget::searchText()
+{
+    if (waitForIndex(AnalysisDataStore::Kind::Text,
+                     tr("Indexing the disassembly of all functions..."))) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QSharedPointer<const TextIndex> index = Core()->getDataStore()->getTextIndex();
+    int limit = ui->hitLimitSpinBox->value();
+    QString error;
+    // One more than the limit, to tell whether it was reached
+    QList<TextIndex::Group> groups;
+    if (index) {
+        groups = index->search(ui->filterLineEdit->text(), limit > 0 ? limit + 1 : 0, &error);
+    }
+
+    // Lines of the same function are kept together, with its name in the data column
+    QList<SearchDescription> hits;
+    QVector<RVA> instructions;
+    QVector<int> instructionHits;
+    bool limitReached = false;
+    for (const TextIndex::Group &group : groups) {
+        QString name = group.offset == RVA_INVALID ? tr("(no function)") : group.name;
+        for (const TextIndex::Line &line : group.lines) {
+            if (limit > 0 && hits.size() == limit) {
+                limitReached = true;
+                break;
+            }
+            SearchDescription hit;
+            hit.offset = line.offset;
+            hit.size = 0;
+            switch (line.type) {
+            case TextIndex::LineType::Flag:
+                hit.code = QStringLiteral(";-- %1").arg(line.text);
+                break;
+            case TextIndex::LineType::Instruction:
+                hit.code = line.text;
+                instructions << line.offset;
+                instructionHits << hits.size();
+                break;
+            case TextIndex::LineType::Comment:
+                hit.code = QStringLiteral("; %1").arg(line.text);
+                break;
+            }
+            hit.data = name;
+            hits << hit;
+        }
+    }
+
+    // The index only keeps the text, the sizes of the instructions are decoded again
+    QList<QPair<int, QString>> decoded = Core()->disassembleInstructions(instructions);
+    for (int i = 0; i < instructionHits.size(); i++) {
+        hits[instructionHits.at(i)].size = decoded.at(i).first;
+    }
+    search_model->append(hits);
+    qhelpers::adjustColumns(ui->searchTreeView, 3, 0);
+
+    QString summary = tr("%n hit(s) in %1 ms", nullptr, hits.size()).arg(timer.elapsed());
+    if (limitReached) {
+        summary += tr(", stopped at the hit limit");
+    }
+    if (!error.isEmpty()) {
+        summary = error;
+    }
+    ui->searchStatusLabel->setText(summary);
+    if (index) {
+        ui->searchStatusLabel->setToolTip(tr("Found in %n function(s), %1 words indexed", nullptr,
+                                             groups.size())
+                                          .arg(index->tokenCount()));
+    }
+}
+
+void SearchWidget::cancelSearch()
+{
+    if (searchTask) {
+        searchTask->interrupt();
+    }
+}
+
+QList<SearchTask::Range> SearchWidget::searchRanges()
+{
+    // Boundaries made of several ranges are searched one range after the other, so there is
+    // something to show before the whole search is done
+    QList<SearchTask::Range> ranges;
+    QString boundary = ui->searchInCombo->currentData().toString();
+    if (boundary == "bin.sections") {
+        for (const SectionDescription &section : Core()->getAllSections()) {
+            if (section.vsize > 0) {
+                ranges.append({ section.vaddr, section.vaddr + section.vsize, section.name });
+            }
+        }
+    } else if (boundary == "dbg.maps") {
+        for (const MemoryMapDescription &map : Core()->getMemoryMap()) {
+            if (map.addrEnd > map.addrStart) {
+                ranges.append({ map.addrStart, map.addrEnd, map.name });
+            }
+        }
+    }
+    return ranges;
+}
+
+void SearchWidget::takeSearchHits(SearchTask *task)
+{
+    if (searchTask.data() != task) {
+        return;
+    }
+    bool wasEmpty = search.isEmpty();
+    search_model->append(task->takeHits());
+    if (wasEmpty && !search.isEmpty()) {
+        qhelpers::adjustColumns(ui->searchTreeView, 3, 0);
+    }
+
+    ui->searchProgressBar->setMaximum(task->getTotal());
+    ui->searchProgressBar->setValue(task->getDone());
+    QString range = task->getCurrentRange();
+    if (range.isEmpty()) {
+        ui->searchStatusLabel->setText(tr("Searching... %n hit(s)", nullptr, search.count()));
+    } else {
+        ui->searchStatusLabel->setText(tr("Searching %1 (%2/%3)... %n hit(s)", nullptr, search.count())
+                                       .arg(range)
+                                       .arg(qMin(task->getDone() + 1, task->getTotal()))
+                                       .arg(task->getTotal()));
+    }
+}
 
+void SearchWidget::searchFinished(SearchTask *task)
+{
+    if (searchTask.data() != task) {
+        return;
+    }
+    takeSearchHits(task);
+
+    QString summary = tr("%n hit(s) in %1 ms", nullptr, search.count())
+                      .arg(task->getElapsedTime());
+    if (task->isLimitReached()) {
+        summary += tr(", stopped at the hit limit");
+    } else if (task->isInterrupted()) {
+        summary += tr(", canceled");
+    }
+    QString error = task->getError();
+    if (!error.isEmpty()) {
+        summary = error;
+    }
+    ui->searchStatusLabel->setText(summary);
+
+    // Pattern sets are summed up per pattern, the ones found most often first
+    QList<QPair<QString, int>> patternHits = task->getPatternHits();
+    std::stable_sort(patternHits.begin(), patternHits.end(), [](const QPair<QString, int> &a,
+                                                                const QPair<QString, int> &b) {
+        return a.second > b.second;
+    });
+    QStringList patternLines;
+    for (const QPair<QString, int> &patternHit : patternHits) {
+        patternLines << tr("%1: %n hit(s)", nullptr, patternHit.second).arg(patternHit.first);
+    }
+    ui->searchStatusLabel->setToolTip(patternLines.join('\n'));
+
+    ui->searchProgressBar->hide();
+    ui->cancelSearchButton->hide();
     qhelpers::adjustColumns(ui->searchTreeView, 3, 0);
+    searchTask.clear();
 }
 
 void SearchWidget::setScrollMode()
@@ -232,6 +559,15 @@ void SearchWidget::updatePlaceholderText(int index)
     case 4: // 32bit value
         ui->filterLineEdit->setPlaceholderText("0xdeadbeef");
         break;
+    case 5: // pattern set file
+        ui->filterLineEdit->setPlaceholderText("patterns.txt");
+        break;
+    case 6: // immediate value
+        ui->filterLineEdit->setPlaceholderText("0x5f3759df");
+        break;
+    case 7: // disassembly text
+        ui->filterLineEdit->setPlaceholderText("call [rip+");
+        break;
     default:
         ui->filterLineEdit->setPlaceholderText("jmp rax");
     }
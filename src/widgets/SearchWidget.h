@@ -8,13 +8,16 @@
 
 #include "core/Cutter.h"
 #include "CutterDockWidget.h"
+#include "common/KeyedListModel.h"
+#include "common/SearchTask.h"
+#include "core/AnalysisDataStore.h"
 
 class MainWindow;
 class QTreeWidgetItem;
 class SearchWidget;
 
 
-class SearchModel: public QAbstractListModel
+class SearchModel: public KeyedListModel<QAbstractListModel>
 {
     Q_OBJECT
 
@@ -34,6 +37,9 @@ public:
 
     QVariant data(const QModelIndex &index, int role) const;
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+    void clear();
+    void append(const QList<SearchDescription> &hits);
 };
 
 
@@ -69,6 +75,7 @@ private slots:
     void on_searchInCombo_currentIndexChanged(int index);
     void searchChanged();
     void refreshSearchspaces();
+    void onDataReady(AnalysisDataStore::Kind kind);
 
 private:
     std::unique_ptr<Ui::SearchWidget> ui;
@@ -76,8 +83,18 @@ private:
     SearchModel *search_model;
     SearchSortFilterProxyModel *search_proxy_model;
     QList<SearchDescription> search;
+    QSharedPointer<SearchTask> searchTask;
+    // Index a search is waiting for, Kind::Count if none
+    AnalysisDataStore::Kind waitingForIndex = AnalysisDataStore::Kind::Count;
 
     void refreshSearch();
+    void cancelSearch();
+    QList<SearchTask::Range> searchRanges();
+    void takeSearchHits(SearchTask *task);
+    void searchFinished(SearchTask *task);
+    bool waitForIndex(AnalysisDataStore::Kind kind, const QString &status);
+    void searchImmediates();
+    void searchText();
     void setScrollMode();
     void updatePlaceholderText(int index);
 };
@@ -2,6 +2,7 @@
 #include "CutterTreeView.h"
 #include "QuickFilterView.h"
 #include "core/MainWindow.h"
+#include "core/EntropyMap.h"
 #include "common/Helpers.h"
 #include "common/Configuration.h"
 
@@ -230,6 +231,8 @@ void SectionsWidget::initConnects()
     connect(sectionsTable, SIGNAL(doubleClicked(const QModelIndex &)),
             this, SLOT(onSectionsDoubleClicked(const QModelIndex &)));
     connect(Core(), SIGNAL(refreshAll()), this, SLOT(refreshSections()));
+    connect(Core()->getDataStore(), &AnalysisDataStore::dataReady,
+            this, &SectionsWidget::onDataReady);
     connect(quickFilterView, SIGNAL(filterTextChanged(const QString &)), proxyModel,
             SLOT(setFilterWildcard(const QString &)));
     connect(quickFilterView, SIGNAL(filterClosed()), sectionsTable, SLOT(setFocus()));
@@ -256,13 +259,38 @@ void SectionsWidget::refreshSections()
 {
     sectionsModel->beginResetModel();
     sections = Core()->getAllSections();
+    applyEntropy();
     sectionsModel->endResetModel();
+    Core()->getDataStore()->request(AnalysisDataStore::Kind::Entropy);
     qhelpers::adjustColumns(sectionsTable, SectionsModel::ColumnCount, 0);
     rawAddrDock->updateDock();
     virtualAddrDock->updateDock();
     drawIndicatorOnAddrDocks();
 }
 
+void SectionsWidget::onDataReady(AnalysisDataStore::Kind kind)
+{
+    if (kind != AnalysisDataStore::Kind::Entropy || sections.isEmpty() || !applyEntropy()) {
+        return;
+    }
+    emit sectionsModel->dataChanged(sectionsModel->index(0, SectionsModel::EntropyColumn),
+                                    sectionsModel->index(sections.size() - 1,
+                                                         SectionsModel::EntropyColumn));
+}
+
+bool SectionsWidget::applyEntropy()
+{
+    QSharedPointer<const EntropyMap> map = Core()->getDataStore()->getEntropyMap();
+    if (!map) {
+        return false;
+    }
+    for (SectionDescription &section : sections) {
+        double entropy = map->getSectionEntropy(section.paddr, section.size);
+        section.entropy = entropy < 0 ? QString() : QString::number(entropy, 'f', 8);
+    }
+    return true;
+}
+
 void SectionsWidget::onSectionsDoubleClicked(const QModelIndex &index)
 {
     if (!index.isValid()) {
@@ -12,6 +12,7 @@
 #include <QHash>
 
 #include "core/Cutter.h"
+#include "core/AnalysisDataStore.h"
 #include "CutterDockWidget.h"
 
 class CutterTreeView;
@@ -70,6 +71,7 @@ public:
 
 private slots:
     void refreshSections();
+    void onDataReady(AnalysisDataStore::Kind kind);
     void onSectionsDoubleClicked(const QModelIndex &index);
     void onSectionsSeekChanged(RVA addr);
 
@@ -95,6 +97,10 @@ private:
     void initAddrMapDocks();
     void drawIndicatorOnAddrDocks();
     void updateToggle();
+    /**
+     * @brief Fill the entropy column from the entropy map of the data store, if there is one
+     */
+    bool applyEntropy();
 };
 
 class AbstractAddrDock : public QDockWidget
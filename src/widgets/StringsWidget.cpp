@@ -10,7 +10,7 @@
 #include <QModelIndex>
 #include <QShortcut>
 
-StringsModel::StringsModel(QList<StringDescription> *strings, QObject *parent)
+StringsModel::StringsModel(QSharedPointer<const CompactStringList> *strings, QObject *parent)
     : QAbstractListModel(parent),
       strings(strings)
 {
@@ -18,7 +18,7 @@ StringsModel::StringsModel(QList<StringDescription> *strings, QObject *parent)
 
 int StringsModel::rowCount(const QModelIndex &) const
 {
-    return strings->count();
+    return rows;
 }
 
 int StringsModel::columnCount(const QModelIndex &) const
@@ -28,31 +28,31 @@ int StringsModel::columnCount(const QModelIndex &) const
 
 QVariant StringsModel::data(const QModelIndex &index, int role) const
 {
-    if (index.row() >= strings->count())
+    const CompactStringList &list = **strings;
+    int row = index.row();
+    if (row >= rows)
         return QVariant();
 
-    const StringDescription &str = strings->at(index.row());
-
     switch (role) {
     case Qt::DisplayRole:
         switch (index.column()) {
         case StringsModel::OffsetColumn:
-            return RAddressString(str.vaddr);
+            return RAddressString(list.vaddr(row));
         case StringsModel::StringColumn:
-            return str.string;
+            return list.string(row);
         case StringsModel::TypeColumn:
-            return str.type.toUpper();
+            return list.type(row).toUpper();
         case StringsModel::LengthColumn:
-            return str.length;
+            return list.length(row);
         case StringsModel::SizeColumn:
-            return str.size;
+            return list.size(row);
         case StringsModel::SectionColumn:
-            return str.section;
+            return list.section(row);
         default:
             return QVariant();
         }
     case StringDescriptionRole:
-        return QVariant::fromValue(str);
+        return QVariant::fromValue(list.at(row));
     default:
         return QVariant();
     }
@@ -84,47 +84,56 @@ QVariant StringsModel::headerData(int section, Qt::Orientation, int role) const
 }
 
 StringsProxyModel::StringsProxyModel(StringsModel *sourceModel, QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : ParallelSortFilterProxyModel(StringsModel::StringColumn, Qt::DisplayRole, parent)
 {
     setSourceModel(sourceModel);
     setFilterCaseSensitivity(Qt::CaseInsensitive);
     setSortCaseSensitivity(Qt::CaseInsensitive);
 }
 
-bool StringsProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) const
+bool StringsProxyModel::filterAcceptsRow(int row, const QModelIndex &) const
 {
-    QModelIndex index = sourceModel()->index(row, 0, parent);
-    StringDescription str = index.data(StringsModel::StringDescriptionRole).value<StringDescription>();
-    if (selectedSection.isEmpty())
-        return str.string.contains(filterRegExp());
-    else
-        return selectedSection == str.section && str.string.contains(filterRegExp());
+    if (!filterMatches(row))
+        return false;
+
+    // filterMatches() cached the keys of all rows up to this one
+    return selectedSection.isEmpty() || selectedSection == sortStrings->section(row);
+}
+
+bool StringsProxyModel::sourceRowMatches(int row, QRegExp &regExp) const
+{
+    return sortStrings->stringContains(row, regExp);
 }
 
-bool StringsProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+void StringsProxyModel::cacheSortKeys()
 {
-    auto leftStr = left.data(StringsModel::StringDescriptionRole).value<StringDescription>();
-    auto rightStr = right.data(StringsModel::StringDescriptionRole).value<StringDescription>();
+    // The columns already are typed keys, holding on to the list is enough
+    sortStrings = static_cast<StringsModel *>(sourceModel())->getStrings();
+}
 
-    switch (left.column()) {
+bool StringsProxyModel::sourceRowLessThan(int leftRow, int rightRow, int column) const
+{
+    const CompactStringList &strings = *sortStrings;
+
+    switch (column) {
     case StringsModel::OffsetColumn:
-        return leftStr.vaddr < rightStr.vaddr;
+        return strings.vaddr(leftRow) < strings.vaddr(rightRow);
     case StringsModel::StringColumn: // sort by string
-        return leftStr.string < rightStr.string;
+        return strings.stringLess(leftRow, rightRow);
     case StringsModel::TypeColumn: // sort by type
-        return leftStr.type < rightStr.type;
+        return strings.type(leftRow) < strings.type(rightRow);
     case StringsModel::SizeColumn: // sort by size
-        return leftStr.size < rightStr.size;
+        return strings.size(leftRow) < strings.size(rightRow);
     case StringsModel::LengthColumn: // sort by length
-        return leftStr.length < rightStr.length;
+        return strings.length(leftRow) < strings.length(rightRow);
     case StringsModel::SectionColumn:
-        return leftStr.section < rightStr.section;
+        return strings.section(leftRow) < strings.section(rightRow);
     default:
         break;
     }
 
     // fallback
-    return leftStr.vaddr < rightStr.vaddr;
+    return strings.vaddr(leftRow) < strings.vaddr(rightRow);
 }
 
 
@@ -139,6 +148,20 @@ StringsWidget::StringsWidget(MainWindow *main, QAction *action) :
     // Add Status Bar footer
     tree->addStatusBar(ui->verticalLayout);
 
+    fetchProgressBar = new QProgressBar(this);
+    fetchProgressBar->setMaximumWidth(150);
+    fetchProgressBar->setTextVisible(false);
+    fetchProgressBar->setVisible(false);
+    tree->addPermanentWidget(fetchProgressBar);
+
+    cancelFetchButton = new QToolButton(this);
+    cancelFetchButton->setText(tr("Cancel"));
+    cancelFetchButton->setVisible(false);
+    tree->addPermanentWidget(cancelFetchButton);
+    connect(cancelFetchButton, &QToolButton::clicked, this, []() {
+        Core()->getDataStore()->cancel(AnalysisDataStore::Kind::Strings);
+    });
+
     qhelpers::setVerticalScrollMode(ui->stringsTreeView);
 
     // Shift-F12 to toggle strings window
@@ -158,6 +181,7 @@ StringsWidget::StringsWidget(MainWindow *main, QAction *action) :
 
     ui->stringsTreeView->setContextMenuPolicy(Qt::CustomContextMenu);
 
+    strings = QSharedPointer<const CompactStringList>(new CompactStringList());
     model = new StringsModel(&strings, this);
     proxyModel = new StringsProxyModel(model, this);
     ui->stringsTreeView->setModel(proxyModel);
@@ -184,6 +208,14 @@ StringsWidget::StringsWidget(MainWindow *main, QAction *action) :
     clearShortcut->setContext(Qt::WidgetWithChildrenShortcut);
 
     connect(Core(), SIGNAL(refreshAll()), this, SLOT(refreshStrings()));
+    connect(Core()->getDataStore(), &AnalysisDataStore::dataReady, this,
+            &StringsWidget::onDataReady);
+    connect(Core()->getDataStore(), &AnalysisDataStore::stringsAppended, this,
+            &StringsWidget::onStringsAppended);
+    connect(Core()->getDataStore(), &AnalysisDataStore::fetchingChanged, this,
+            &StringsWidget::onFetchingChanged);
+    connect(Core()->getDataStore(), &AnalysisDataStore::stringsProgress, this,
+            &StringsWidget::onStringsProgress);
 
     connect(
         ui->quickFilterView->comboBox(), &QComboBox::currentTextChanged, this,
@@ -209,14 +241,7 @@ void StringsWidget::on_stringsTreeView_doubleClicked(const QModelIndex &index)
 
 void StringsWidget::refreshStrings()
 {
-    if (task) {
-        task->wait();
-    }
-
-    task = QSharedPointer<StringsTask>(new StringsTask());
-    connect(task.data(), &StringsTask::stringSearchFinished, this,
-            &StringsWidget::stringSearchFinished);
-    Core()->getAsyncTaskManager()->start(task);
+    Core()->getDataStore()->request(AnalysisDataStore::Kind::Strings);
 
     refreshSectionCombo();
 }
@@ -235,19 +260,68 @@ void StringsWidget::refreshSectionCombo()
     proxyModel->selectedSection.clear();
 }
 
-void StringsWidget::stringSearchFinished(const QList<StringDescription> &strings)
+void StringsWidget::onDataReady(AnalysisDataStore::Kind kind)
 {
-    model->beginResetModel();
-    this->strings = strings;
-    model->endResetModel();
+    if (kind != AnalysisDataStore::Kind::Strings) {
+        return;
+    }
+    QSharedPointer<const CompactStringList> newStrings = Core()->getDataStore()->getStrings();
+    if (!newStrings) {
+        return;
+    }
+    if (newStrings != strings || model->rows != newStrings->count()) {
+        setStrings(newStrings);
+    }
 
     qhelpers::adjustColumns(ui->stringsTreeView, 5, 0);
     if (ui->stringsTreeView->columnWidth(1) > 300)
         ui->stringsTreeView->setColumnWidth(1, 300);
 
     tree->showItemsNumber(proxyModel->rowCount());
+}
+
+void StringsWidget::onStringsAppended(int first, int last)
+{
+    QSharedPointer<const CompactStringList> newStrings = Core()->getDataStore()->getStrings();
+    if (!strings || model->rows != first || !newStrings->startsWith(*strings)) {
+        // First batch of a new list
+        setStrings(newStrings);
+        qhelpers::adjustColumns(ui->stringsTreeView, 5, 0);
+        if (ui->stringsTreeView->columnWidth(1) > 300)
+            ui->stringsTreeView->setColumnWidth(1, 300);
+    } else {
+        // The next snapshot of the same list, the proxy may still sort the previous one
+        strings = newStrings;
+        model->beginInsertRows(QModelIndex(), first, last);
+        model->rows = last + 1;
+        model->endInsertRows();
+    }
+
+    tree->showItemsNumber(proxyModel->rowCount());
+}
 
-    task = nullptr;
+void StringsWidget::onFetchingChanged(AnalysisDataStore::Kind kind, bool fetching)
+{
+    if (kind != AnalysisDataStore::Kind::Strings) {
+        return;
+    }
+    fetchProgressBar->setVisible(fetching);
+    cancelFetchButton->setVisible(fetching);
+}
+
+void StringsWidget::onStringsProgress(int done, int total)
+{
+    // A busy indicator while the total is unknown
+    fetchProgressBar->setRange(0, total);
+    fetchProgressBar->setValue(done);
+}
+
+void StringsWidget::setStrings(const QSharedPointer<const CompactStringList> &newStrings)
+{
+    model->beginResetModel();
+    strings = newStrings;
+    model->rows = strings->count();
+    model->endResetModel();
 }
 
 void StringsWidget::showStringsContextMenu(const QPoint &pt)
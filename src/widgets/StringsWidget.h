@@ -5,11 +5,14 @@
 
 #include "core/Cutter.h"
 #include "CutterDockWidget.h"
-#include "common/StringsTask.h"
+#include "core/AnalysisDataStore.h"
 #include "CutterTreeWidget.h"
+#include "common/ParallelSortFilterProxyModel.h"
 
 #include <QAbstractListModel>
 #include <QSortFilterProxyModel>
+#include <QProgressBar>
+#include <QToolButton>
 
 class MainWindow;
 class QTreeWidgetItem;
@@ -26,13 +29,17 @@ class StringsModel: public QAbstractListModel
     friend StringsWidget;
 
 private:
-    QList<StringDescription> *strings;
+    QSharedPointer<const CompactStringList> *strings;
+    // Rows of strings the views know about, the list may already have grown while being fetched
+    int rows = 0;
 
 public:
     enum Column { OffsetColumn = 0, StringColumn, TypeColumn, LengthColumn, SizeColumn, SectionColumn, ColumnCount };
     static const int StringDescriptionRole = Qt::UserRole;
 
-    StringsModel(QList<StringDescription> *strings, QObject *parent = nullptr);
+    StringsModel(QSharedPointer<const CompactStringList> *strings, QObject *parent = nullptr);
+
+    QSharedPointer<const CompactStringList> getStrings() const  { return *strings; }
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
@@ -43,7 +50,7 @@ public:
 
 
 
-class StringsProxyModel : public QSortFilterProxyModel
+class StringsProxyModel : public ParallelSortFilterProxyModel
 {
     Q_OBJECT
 
@@ -54,9 +61,14 @@ public:
 
 protected:
     bool filterAcceptsRow(int row, const QModelIndex &parent) const override;
-    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+    void cacheSortKeys() override;
+    bool sourceRowLessThan(int leftRow, int rightRow, int column) const override;
+    bool sourceRowMatches(int row, QRegExp &regExp) const override;
 
     QString selectedSection;
+
+private:
+    QSharedPointer<const CompactStringList> sortStrings;
 };
 
 
@@ -72,7 +84,10 @@ private slots:
     void on_stringsTreeView_doubleClicked(const QModelIndex &index);
 
     void refreshStrings();
-    void stringSearchFinished(const QList<StringDescription> &strings);
+    void onDataReady(AnalysisDataStore::Kind kind);
+    void onStringsAppended(int first, int last);
+    void onFetchingChanged(AnalysisDataStore::Kind kind, bool fetching);
+    void onStringsProgress(int done, int total);
     void refreshSectionCombo();
 
     void showStringsContextMenu(const QPoint &pt);
@@ -82,12 +97,14 @@ private slots:
 private:
     std::unique_ptr<Ui::StringsWidget> ui;
 
-    QSharedPointer<StringsTask> task;
-
     StringsModel *model;
     StringsProxyModel *proxyModel;
-    QList<StringDescription> strings;
+    QSharedPointer<const CompactStringList> strings;
     CutterTreeWidget *tree;
+    QProgressBar *fetchProgressBar;
+    QToolButton *cancelFetchButton;
+
+    void setStrings(const QSharedPointer<const CompactStringList> &newStrings);
 };
 
 #endif // STRINGSWIDGET_H
@@ -68,27 +68,49 @@ QVariant SymbolsModel::headerData(int section, Qt::Orientation, int role) const
 }
 
 SymbolsProxyModel::SymbolsProxyModel(SymbolsModel *sourceModel, QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : ParallelSortFilterProxyModel(SymbolsModel::NameColumn, Qt::DisplayRole, parent)
 {
     setSourceModel(sourceModel);
     setFilterCaseSensitivity(Qt::CaseInsensitive);
     setSortCaseSensitivity(Qt::CaseInsensitive);
 }
 
-bool SymbolsProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) const
+bool SymbolsProxyModel::filterAcceptsRow(int row, const QModelIndex &) const
 {
-    QModelIndex index = sourceModel()->index(row, 0, parent);
-    auto symbol = index.data(SymbolsModel::SymbolDescriptionRole).value<SymbolDescription>();
+    return filterMatches(row);
+}
+
+bool SymbolsProxyModel::sourceRowMatches(int row, QRegExp &regExp) const
+{
+    return sortSymbols[row].name.contains(regExp);
+}
 
-    return symbol.name.contains(filterRegExp());
+void SymbolsProxyModel::cacheSortKeys()
+{
+    int rowCount = sourceModel()->rowCount();
+    sortSymbols.clear();
+    sortSymbols.reserve(rowCount);
+    for (int row = 0; row < rowCount; row++) {
+        QModelIndex index = sourceModel()->index(row, 0);
+        sortSymbols.push_back(index.data(
+                                  SymbolsModel::SymbolDescriptionRole).value<SymbolDescription>());
+    }
 }
 
-bool SymbolsProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+void SymbolsProxyModel::updateSortKeys(int first, int last)
 {
-    auto leftSymbol = left.data(SymbolsModel::SymbolDescriptionRole).value<SymbolDescription>();
-    auto rightSymbol = right.data(SymbolsModel::SymbolDescriptionRole).value<SymbolDescription>();
+    for (int row = first; row <= last && row < static_cast<int>(sortSymbols.size()); row++) {
+        QModelIndex index = sourceModel()->index(row, 0);
+        sortSymbols[row] = index.data(SymbolsModel::SymbolDescriptionRole).value<SymbolDescription>();
+    }
+}
 
-    switch (left.column()) {
+bool SymbolsProxyModel::sourceRowLessThan(int leftRow, int rightRow, int column) const
+{
+    const SymbolDescription &leftSymbol = sortSymbols[leftRow];
+    const SymbolDescription &rightSymbol = sortSymbols[rightRow];
+
+    switch (column) {
     case SymbolsModel::AddressColumn:
         return leftSymbol.vaddr < rightSymbol.vaddr;
     case SymbolsModel::TypeColumn:
@@ -138,6 +160,8 @@ SymbolsWidget::SymbolsWidget(MainWindow *main, QAction *action) :
     setScrollMode();
 
     connect(Core(), SIGNAL(refreshAll()), this, SLOT(refreshSymbols()));
+    connect(Core()->getDataStore(), &AnalysisDataStore::dataReady, this,
+            &SymbolsWidget::onDataReady);
 }
 
 SymbolsWidget::~SymbolsWidget() {}
@@ -155,8 +179,21 @@ void SymbolsWidget::on_symbolsTreeView_doubleClicked(const QModelIndex &index)
 
 void SymbolsWidget::refreshSymbols()
 {
+    Core()->getDataStore()->request(AnalysisDataStore::Kind::Symbols);
+}
+
+void SymbolsWidget::onDataReady(AnalysisDataStore::Kind kind)
+{
+    if (kind != AnalysisDataStore::Kind::Symbols) {
+        return;
+    }
+    QList<SymbolDescription> newSymbols = Core()->getDataStore()->getSymbols();
+    if (newSymbols.isSharedWith(symbols)) {
+        return;
+    }
+
     symbolsModel->beginResetModel();
-    symbols = Core()->getAllSymbols();
+    symbols = newSymbols;
     symbolsModel->endResetModel();
 
     qhelpers::adjustColumns(ui->symbolsTreeView, SymbolsModel::ColumnCount, 0);
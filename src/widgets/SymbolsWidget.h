@@ -6,8 +6,10 @@
 #include <QSortFilterProxyModel>
 
 #include "core/Cutter.h"
+#include "core/AnalysisDataStore.h"
 #include "CutterDockWidget.h"
 #include "CutterTreeWidget.h"
+#include "common/ParallelSortFilterProxyModel.h"
 
 class MainWindow;
 class QTreeWidgetItem;
@@ -39,7 +41,7 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
 };
 
-class SymbolsProxyModel : public QSortFilterProxyModel
+class SymbolsProxyModel : public ParallelSortFilterProxyModel
 {
     Q_OBJECT
 
@@ -48,7 +50,13 @@ public:
 
 protected:
     bool filterAcceptsRow(int row, const QModelIndex &parent) const override;
-    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+    void cacheSortKeys() override;
+    void updateSortKeys(int first, int last) override;
+    bool sourceRowLessThan(int leftRow, int rightRow, int column) const override;
+    bool sourceRowMatches(int row, QRegExp &regExp) const override;
+
+private:
+    std::vector<SymbolDescription> sortSymbols;
 };
 
 
@@ -64,6 +72,7 @@ private slots:
     void on_symbolsTreeView_doubleClicked(const QModelIndex &index);
 
     void refreshSymbols();
+    void onDataReady(AnalysisDataStore::Kind kind);
 
 private:
     std::unique_ptr<Ui::SymbolsWidget> ui;
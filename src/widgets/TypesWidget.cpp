@@ -88,13 +88,17 @@ bool TypesModel::removeRows(int row, int count, const QModelIndex &parent)
 
 
 TypesSortFilterProxyModel::TypesSortFilterProxyModel(TypesModel *source_model, QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : IndexedFilterProxyModel(TypesModel::TYPE, Qt::DisplayRole, parent)
 {
     setSourceModel(source_model);
 }
 
 bool TypesSortFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) const
 {
+    if (!mayMatchFilter(row, parent)) {
+        return false;
+    }
+
     QModelIndex index = sourceModel()->index(row, 0, parent);
     TypeDescription exp = index.data(TypesModel::TypeDescriptionRole).value<TypeDescription>();
     if (selectedCategory.isEmpty()) {
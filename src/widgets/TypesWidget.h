@@ -6,6 +6,7 @@
 #include "core/Cutter.h"
 #include "CutterDockWidget.h"
 #include "CutterTreeWidget.h"
+#include "common/IndexedFilterProxyModel.h"
 
 #include <QAbstractListModel>
 #include <QSortFilterProxyModel>
@@ -49,7 +50,7 @@ public:
 
 
 
-class TypesSortFilterProxyModel : public QSortFilterProxyModel
+class TypesSortFilterProxyModel : public IndexedFilterProxyModel
 {
     Q_OBJECT
 
@@ -1,26 +1,29 @@
 #include "VisualNavbar.h"
 #include "core/MainWindow.h"
 #include "common/TempConfig.h"
+#include "core/AnalysisDataStore.h"
+#include "core/EntropyMap.h"
 
-#include <QGraphicsView>
-#include <QComboBox>
-#include <QGraphicsScene>
-#include <QGraphicsRectItem>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
-#include <QJsonParseError>
+#include <QAction>
+#include <QContextMenuEvent>
+#include <QMenu>
+#include <QPainter>
 #include <QToolTip>
 #include <QMouseEvent>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 
+namespace {
+
+const int cursorWidth = 2;
+
+}
+
 VisualNavbar::VisualNavbar(MainWindow *main, QWidget *parent) :
     QToolBar(main),
-    graphicsView(new QGraphicsView),
-    seekGraphicsItem(nullptr),
-    PCGraphicsItem(nullptr),
+    strip(new QWidget),
     main(main)
 {
     Q_UNUSED(parent);
@@ -33,207 +36,351 @@ VisualNavbar::VisualNavbar(MainWindow *main, QWidget *parent) :
     // and the result is wrong. Something to do with overwriting the style sheet :/
     //setStyleSheet("QToolBar { border: 0px; border-bottom: 0px; border-top: 0px; border-width: 0px;}");
 
-    /*
-    QComboBox *addsCombo = new QComboBox();
-    addsCombo->addItem("");
-    addsCombo->addItem("Entry points");
-    addsCombo->addItem("Marks");
-    */
-    addWidget(this->graphicsView);
-    //addWidget(addsCombo);
+    // The strip is painted, resized and clicked through eventFilter()
+    strip->setMinimumHeight(15);
+    strip->setMaximumHeight(15);
+    strip->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    strip->setAttribute(Qt::WA_OpaquePaintEvent);
+    strip->setMouseTracking(true);
+    strip->installEventFilter(this);
+    addWidget(strip);
+
+    entropyAction = new QAction(tr("Show entropy"), this);
+    entropyAction->setCheckable(true);
+    connect(entropyAction, &QAction::toggled, this, [this](bool checked) {
+        if (checked) {
+            Core()->getDataStore()->request(AnalysisDataStore::Kind::Entropy);
+        }
+        updateImage();
+    });
 
     connect(Core(), SIGNAL(seekChanged(RVA)), this, SLOT(on_seekChanged(RVA)));
     connect(Core(), SIGNAL(registersChanged()), this, SLOT(drawPCCursor()));
     connect(Core(), SIGNAL(refreshAll()), this, SLOT(fetchAndPaintData()));
     connect(Core(), SIGNAL(functionsChanged()), this, SLOT(fetchAndPaintData()));
     connect(Core(), SIGNAL(flagsChanged()), this, SLOT(fetchAndPaintData()));
+    connect(Core(), SIGNAL(commentsChanged(RVA)), this, SLOT(fetchComments()));
+    connect(Core()->getDataStore(), &AnalysisDataStore::dataReady,
+            this, &VisualNavbar::onDataReady);
+    connect(Core()->getDataStore(), &AnalysisDataStore::stringsAppended,
+            this, &VisualNavbar::onStringsAppended);
+}
+
+bool VisualNavbar::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched != strip) {
+        return QToolBar::eventFilter(watched, event);
+    }
+    switch (event->type()) {
+    case QEvent::Resize:
+        // Binning the density index again is cheap, no need to keep blocks for other widths
+        if (statsWidth != strip->width()) {
+            updateImage();
+        }
+        break;
+    case QEvent::Paint:
+        paintStrip();
+        return true;
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseMove:
+        stripMouseEvent(static_cast<QMouseEvent *>(event));
+        return true;
+    case QEvent::ContextMenu: {
+        QMenu menu(strip);
+        menu.addAction(entropyAction);
+        menu.exec(static_cast<QContextMenuEvent *>(event)->globalPos());
+        return true;
+    }
+    default:
+        break;
+    }
+    return QToolBar::eventFilter(watched, event);
+}
 
-    graphicsScene = new QGraphicsScene(this);
-
-    const QBrush bg = QBrush(QColor(74, 74, 74));
-
-    graphicsScene->setBackgroundBrush(bg);
-
-    this->graphicsView->setAlignment(Qt::AlignLeft);
-    this->graphicsView->setMinimumHeight(15);
-    this->graphicsView->setMaximumHeight(15);
-    this->graphicsView->setFrameShape(QFrame::NoFrame);
-    this->graphicsView->setRenderHints(0);
-    this->graphicsView->setScene(graphicsScene);
-    this->graphicsView->setRenderHints(QPainter::Antialiasing);
-    this->graphicsView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    this->graphicsView->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    // So the graphicsView doesn't intercept mouse events.
-    this->graphicsView->setEnabled(false);
-    this->graphicsView->setMouseTracking(true);
-    setMouseTracking(true);
+void VisualNavbar::fetchAndPaintData()
+{
+    // The density index is filled kind by kind in onDataReady, the comments aren't in the store
+    AnalysisDataStore *store = Core()->getDataStore();
+    store->request(AnalysisDataStore::Kind::Sections);
+    store->request(AnalysisDataStore::Kind::Functions);
+    store->request(AnalysisDataStore::Kind::Symbols);
+    store->request(AnalysisDataStore::Kind::Flags);
+    store->request(AnalysisDataStore::Kind::Strings);
+    fetchComments();
 }
 
-unsigned int nextPow2(unsigned int n)
+void VisualNavbar::fetchComments()
 {
-    unsigned int b = 0;
-    while (n) {
-        n >>= 1;
-        b++;
+    std::vector<RVA> comments;
+    for (RVA offset : Core()->getCommentOffsets()) {
+        comments.push_back(offset);
     }
-    return (1u << b);
+    density.setAddresses(AddressDensityIndex::Comments, comments);
+    updateImage();
 }
 
-void VisualNavbar::paintEvent(QPaintEvent *event)
+void VisualNavbar::onDataReady(AnalysisDataStore::Kind kind)
 {
-    Q_UNUSED(event);
-
-    QPainter painter(this);
-
-    auto w = static_cast<unsigned int>(width());
-    bool fetch = false;
-    if (statsWidth < w) {
-        statsWidth = nextPow2(w);
-        fetch = true;
-    } else if (statsWidth > w * 4) {
-        statsWidth = statsWidth > 0 ? statsWidth / 2 : 0;
-        fetch = true;
+    if (kind == AnalysisDataStore::Kind::Entropy) {
+        if (entropyAction->isChecked()) {
+            updateImage();
+        }
+        return;
+    }
+    if (kind == AnalysisDataStore::Kind::Sections) {
+        // The range changed, which clears all columns
+        density.setSections(Core()->getDataStore()->getSections());
+        fillDensity(AnalysisDataStore::Kind::Functions);
+        fillDensity(AnalysisDataStore::Kind::Symbols);
+        fillDensity(AnalysisDataStore::Kind::Flags);
+        fillDensity(AnalysisDataStore::Kind::Strings);
+        fetchComments();
+        return;
     }
+    fillDensity(kind);
+    updateImage();
+}
 
-    if (fetch) {
-        fetchAndPaintData();
-    } else if (previousWidth != w) {
-        this->previousWidth = w;
-        updateGraphicsScene();
+void VisualNavbar::onStringsAppended(int first, int last)
+{
+    Q_UNUSED(last);
+    countStrings(first);
+    updateImage();
+}
+
+void VisualNavbar::fillDensity(AnalysisDataStore::Kind kind)
+{
+    AnalysisDataStore *store = Core()->getDataStore();
+    std::vector<RVA> addresses;
+    switch (kind) {
+    case AnalysisDataStore::Kind::Functions:
+        density.setFunctions(store->getFunctions());
+        break;
+    case AnalysisDataStore::Kind::Symbols:
+        for (const SymbolDescription &symbol : store->getSymbols()) {
+            addresses.push_back(symbol.vaddr);
+        }
+        density.setAddresses(AddressDensityIndex::Symbols, addresses);
+        break;
+    case AnalysisDataStore::Kind::Flags:
+        for (const FlagDescription &flag : store->getFlags()) {
+            addresses.push_back(flag.offset);
+        }
+        density.setAddresses(AddressDensityIndex::Flags, addresses);
+        break;
+    case AnalysisDataStore::Kind::Strings:
+        countedStrings.clear();
+        countStrings(0);
+        break;
+    default:
+        break;
     }
 }
 
-void VisualNavbar::fetchAndPaintData()
+void VisualNavbar::countStrings(int first)
 {
-    fetchStats();
-    updateGraphicsScene();
+    QSharedPointer<const CompactStringList> strings = Core()->getDataStore()->getStrings();
+    bool append = strings && countedStrings && first == countedStringsRows
+                  && strings->startsWith(*countedStrings);
+    int begin = append ? first : 0;
+
+    std::vector<RVA> addresses;
+    int count = strings ? strings->count() : 0;
+    addresses.reserve(static_cast<size_t>(count - begin));
+    for (int i = begin; i < count; i++) {
+        addresses.push_back(strings->vaddr(i));
+    }
+    if (append) {
+        density.addAddresses(AddressDensityIndex::Strings, addresses);
+    } else {
+        density.setAddresses(AddressDensityIndex::Strings, addresses);
+    }
+    countedStrings = strings;
+    countedStringsRows = count;
 }
 
-void VisualNavbar::fetchStats()
+void VisualNavbar::updateStats()
 {
-    stats = Core()->getBlockStatistics(statsWidth);
+    statsWidth = strip->width();
+    stats = density.statistics(statsWidth);
 }
 
 enum class DataType : int { Empty, Code, String, Symbol, Count };
 
-void VisualNavbar::updateGraphicsScene()
+void VisualNavbar::updateImage()
 {
-    graphicsScene->clear();
+    updateStats();
     xToAddress.clear();
-    seekGraphicsItem = nullptr;
-    PCGraphicsItem = nullptr;
-    graphicsScene->setBackgroundBrush(QBrush(Config()->getColor("gui.navbar.empty")));
+    seekAddress = Core()->getOffset();
+
+    int w = strip->width();
+    int h = strip->height();
+    image = QImage(std::max(w, 1), std::max(h, 1), QImage::Format_RGB32);
+    image.fill(Config()->getColor("gui.navbar.empty"));
+
+    if (stats.to > stats.from && w > 0) {
+        RVA totalSize = stats.to - stats.from;
+        RVA beginAddr = stats.from;
+
+        double widthPerByte = (double)w / (double)totalSize;
+        auto xFromAddr = [widthPerByte, beginAddr] (RVA addr) -> double {
+            return (addr - beginAddr) * widthPerByte;
+        };
+
+        std::array<QColor, static_cast<int>(DataType::Count)> dataTypeColors;
+        dataTypeColors[static_cast<int>(DataType::Code)] = Config()->getColor("gui.navbar.code");
+        dataTypeColors[static_cast<int>(DataType::String)] = Config()->getColor("gui.navbar.str");
+        dataTypeColors[static_cast<int>(DataType::Symbol)] = Config()->getColor("gui.navbar.sym");
+
+        QPainter painter(&image);
+        xToAddress.reserve(static_cast<size_t>(stats.blocks.size()));
+
+        // Runs of blocks of the same type are filled at once
+        DataType runType = DataType::Empty;
+        double runStart = 0.0;
+        double runEnd = 0.0;
+        auto fillRun = [&]() {
+            if (runType == DataType::Empty) {
+                return;
+            }
+            int left = static_cast<int>(std::floor(runStart));
+            int right = std::max(left + 1, static_cast<int>(std::ceil(runEnd)));
+            painter.fillRect(left, 0, right - left, h, dataTypeColors[static_cast<int>(runType)]);
+        };
+
+        for (const BlockDescription &block : stats.blocks) {
+            // Keep track of where which memory segment is mapped so we are able to convert from
+            // address to X coordinate and vice versa.
+            XToAddress x2a;
+            x2a.x_start = xFromAddr(block.addr);
+            x2a.x_end = xFromAddr(block.addr + block.size);
+            x2a.address_from = block.addr;
+            x2a.address_to = block.addr + block.size;
+            xToAddress.push_back(x2a);
+
+            DataType dataType;
+            if (block.functions > 0) {
+                dataType = DataType::Code;
+            } else if (block.strings > 0) {
+                dataType = DataType::String;
+            } else if (block.symbols > 0) {
+                dataType = DataType::Symbol;
+            } else if (block.inFunctions > 0) {
+                dataType = DataType::Code;
+            } else {
+                dataType = DataType::Empty;
+            }
 
-    if (stats.to <= stats.from) {
-        return;
-    }
+            if (dataType == runType) {
+                runEnd = x2a.x_end;
+                continue;
+            }
+            fillRun();
+            runType = dataType;
+            runStart = x2a.x_start;
+            runEnd = x2a.x_end;
+        }
+        fillRun();
 
-    int w = graphicsView->width();
-    int h = graphicsView->height();
-
-    RVA totalSize = stats.to - stats.from;
-    RVA beginAddr = stats.from;
-
-    double widthPerByte = (double)w / (double)totalSize;
-    auto xFromAddr = [widthPerByte, beginAddr] (RVA addr) -> double {
-        return (addr - beginAddr) * widthPerByte;
-    };
-
-    std::array<QBrush, static_cast<int>(DataType::Count)> dataTypeBrushes;
-    dataTypeBrushes[static_cast<int>(DataType::Code)] = QBrush(Config()->getColor("gui.navbar.code"));
-    dataTypeBrushes[static_cast<int>(DataType::String)] = QBrush(Config()->getColor("gui.navbar.str"));
-    dataTypeBrushes[static_cast<int>(DataType::Symbol)] = QBrush(Config()->getColor("gui.navbar.sym"));
-
-    DataType lastDataType = DataType::Empty;
-    QGraphicsRectItem *dataItem = nullptr;
-    QRectF dataItemRect(0.0, 0.0, 0.0, h);
-    for (const BlockDescription &block : stats.blocks) {
-        // Keep track of where which memory segment is mapped so we are able to convert from
-        // address to X coordinate and vice versa.
-        XToAddress x2a;
-        x2a.x_start = xFromAddr(block.addr);
-        x2a.x_end = xFromAddr(block.addr + block.size);
-        x2a.address_from = block.addr;
-        x2a.address_to = block.addr + block.size;
-        xToAddress.append(x2a);
-
-        DataType dataType;
-        if (block.functions > 0) {
-            dataType = DataType::Code;
-        } else if (block.strings > 0) {
-            dataType = DataType::String;
-        } else if (block.symbols > 0) {
-            dataType = DataType::Symbol;
-        } else if (block.inFunctions > 0) {
-            dataType = DataType::Code;
-        } else {
-            lastDataType = DataType::Empty;
-            continue;
+        if (entropyAction->isChecked()) {
+            paintEntropy(painter);
         }
+    }
+
+    strip->update();
+}
 
-        if (dataType == lastDataType) {
-            double r = xFromAddr(block.addr + block.size);
-            if (r > dataItemRect.right()) {
-                dataItemRect.setRight(r);
-                dataItem->setRect(dataItemRect);
+void VisualNavbar::paintEntropy(QPainter &painter)
+{
+    QSharedPointer<const EntropyMap> map = Core()->getDataStore()->getEntropyMap();
+    if (!map) {
+        return;
+    }
+    QList<SectionDescription> sections = Core()->getDataStore()->getSections();
+
+    // Bars as high as the entropy, colored by the class of most bytes
+    const QColor zeroColor(149, 165, 166, 180);
+    const QColor printableColor(46, 204, 113, 180);
+    const QColor highBitColor(231, 76, 60, 180);
+    int h = image.height();
+    for (size_t i = 0; i < xToAddress.size(); i++) {
+        const XToAddress &x2a = xToAddress[i];
+        RVA addr = x2a.address_from;
+        const SectionDescription *section = nullptr;
+        for (const SectionDescription &s : sections) {
+            if (addr >= s.vaddr && addr < s.vaddr + s.size) {
+                section = &s;
+                break;
             }
-            dataItem->setRect(dataItemRect);
+        }
+        if (!section) {
+            continue;
+        }
+        const EntropyMap::Sample *sample = map->sampleAt(section->paddr + (addr - section->vaddr),
+                                                         x2a.address_to - x2a.address_from);
+        if (!sample || sample->entropy == 0) {
             continue;
         }
 
-        dataItemRect.setX(xFromAddr(block.addr));
-        dataItemRect.setRight(xFromAddr(block.addr + block.size));
-
-        dataItem = new QGraphicsRectItem();
-        dataItem->setPen(Qt::NoPen);
-        dataItem->setBrush(dataTypeBrushes[static_cast<int>(dataType)]);
-        graphicsScene->addItem(dataItem);
-
-        lastDataType = dataType;
+        int left = static_cast<int>(std::floor(x2a.x_start));
+        int right = std::max(left + 1, static_cast<int>(std::ceil(x2a.x_end)));
+        int barHeight = std::max(1, sample->entropy * h / 255);
+        QColor color = sample->zero >= 128 ? zeroColor
+                       : (sample->highBit > sample->printable ? highBitColor : printableColor);
+        painter.fillRect(left, h - barHeight, right - left, barHeight, color);
     }
+}
 
-    // Update scene width
-    graphicsScene->setSceneRect(0, 0, w, h);
+void VisualNavbar::paintStrip()
+{
+    QPainter painter(strip);
+    painter.drawImage(0, 0, image);
 
-    drawSeekCursor();
+    QRect pcRect = cursorRect(pcAddress);
+    if (!pcRect.isNull()) {
+        painter.fillRect(pcRect, Config()->getColor("gui.navbar.pc"));
+    }
+    QRect seekRect = cursorRect(seekAddress);
+    if (!seekRect.isNull()) {
+        painter.fillRect(seekRect, Config()->getColor("gui.navbar.seek"));
+    }
 }
 
-void VisualNavbar::drawCursor(RVA addr, QColor color, QGraphicsRectItem *&graphicsItem)
+QRect VisualNavbar::cursorRect(RVA addr)
 {
-    double cursor_x = addressToLocalX(addr);
-    if (graphicsItem != nullptr) {
-        graphicsScene->removeItem(graphicsItem);
-        delete graphicsItem;
-        graphicsItem = nullptr;
+    if (addr == RVA_INVALID) {
+        return QRect();
     }
-    if (std::isnan(cursor_x)) {
-        return;
+    double x = addressToLocalX(addr);
+    if (std::isnan(x)) {
+        return QRect();
     }
-    int h = this->graphicsView->height();
-    graphicsItem = new QGraphicsRectItem(cursor_x, 0, 2, h);
-    graphicsItem->setPen(Qt::NoPen);
-    graphicsItem->setBrush(QBrush(color));
-    graphicsScene->addItem(graphicsItem);
+    return QRect(static_cast<int>(x), 0, cursorWidth, strip->height());
 }
 
-void VisualNavbar::drawPCCursor()
+void VisualNavbar::updateCursor(RVA &cursor, RVA addr)
 {
-    drawCursor(Core()->getProgramCounterValue(), Config()->getColor("gui.navbar.pc"), PCGraphicsItem);
+    // Only the old and the new position of the cursor are painted again
+    QRect oldRect = cursorRect(cursor);
+    cursor = addr;
+    QRect newRect = cursorRect(cursor);
+    if (oldRect != newRect) {
+        strip->update(oldRect);
+        strip->update(newRect);
+    }
 }
 
-void VisualNavbar::drawSeekCursor()
+void VisualNavbar::drawPCCursor()
 {
-    drawCursor(Core()->getOffset(), Config()->getColor("gui.navbar.seek"), seekGraphicsItem);
+    updateCursor(pcAddress, Core()->getProgramCounterValue());
 }
 
 void VisualNavbar::on_seekChanged(RVA addr)
 {
-    Q_UNUSED(addr);
-    // Update cursor
-    this->drawSeekCursor();
+    updateCursor(seekAddress, addr);
 }
 
-void VisualNavbar::mousePressEvent(QMouseEvent *event)
+void VisualNavbar::stripMouseEvent(QMouseEvent *event)
 {
     qreal x = event->localPos().x();
     RVA address = localXToAddress(x);
@@ -246,40 +393,48 @@ void VisualNavbar::mousePressEvent(QMouseEvent *event)
     }
 }
 
-void VisualNavbar::mouseMoveEvent(QMouseEvent *event)
-{
-    event->accept();
-    mousePressEvent(event);
-}
-
 RVA VisualNavbar::localXToAddress(double x)
 {
-    for (const XToAddress &x2a : xToAddress) {
-        if ((x2a.x_start <= x) && (x <= x2a.x_end)) {
-            double offset = (x - x2a.x_start) / (x2a.x_end - x2a.x_start);
-            double size = x2a.address_to - x2a.address_from;
-            return x2a.address_from + (offset * size);
-        }
+    // The last block starting at or before x
+    auto it = std::upper_bound(xToAddress.begin(), xToAddress.end(), x,
+    [](double value, const XToAddress & x2a) {
+        return value < x2a.x_start;
+    });
+    if (it == xToAddress.begin()) {
+        return RVA_INVALID;
     }
-    return RVA_INVALID;
+    const XToAddress &x2a = *(it - 1);
+    if (x > x2a.x_end) {
+        return RVA_INVALID;
+    }
+    double offset = (x - x2a.x_start) / (x2a.x_end - x2a.x_start);
+    double size = x2a.address_to - x2a.address_from;
+    return x2a.address_from + (offset * size);
 }
 
 double VisualNavbar::addressToLocalX(RVA address)
 {
-    for (const XToAddress &x2a : xToAddress) {
-        if ((x2a.address_from <= address) && (address < x2a.address_to)) {
-            double offset = (double)(address - x2a.address_from) / (double)(x2a.address_to - x2a.address_from);
-            double size = x2a.x_end - x2a.x_start;
-            return x2a.x_start + (offset * size);
-        }
+    // The last block starting at or before address
+    auto it = std::upper_bound(xToAddress.begin(), xToAddress.end(), address,
+    [](RVA value, const XToAddress & x2a) {
+        return value < x2a.address_from;
+    });
+    if (it == xToAddress.begin()) {
+        return nan("");
+    }
+    const XToAddress &x2a = *(it - 1);
+    if (address >= x2a.address_to) {
+        return nan("");
     }
-    return nan("");
+    double offset = (double)(address - x2a.address_from) / (double)(x2a.address_to - x2a.address_from);
+    double size = x2a.x_end - x2a.x_start;
+    return x2a.x_start + (offset * size);
 }
 
 QList<QString> VisualNavbar::sectionsForAddress(RVA address)
 {
     QList<QString> ret;
-    QList<SectionDescription> sections = Core()->getAllSections();
+    QList<SectionDescription> sections = Core()->getDataStore()->getSections();
     for (const SectionDescription &section : sections) {
         if (address >= section.vaddr && address < section.vaddr + section.vsize) {
             ret << section.name;
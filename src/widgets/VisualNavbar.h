@@ -2,12 +2,15 @@
 #define VISUALNAVBAR_H
 
 #include <QToolBar>
-#include <QGraphicsScene>
+#include <QImage>
+
+#include <vector>
 
 #include "core/Cutter.h"
+#include "core/AnalysisDataStore.h"
+#include "common/AddressDensityIndex.h"
 
 class MainWindow;
-class QGraphicsView;
 
 class VisualNavbar : public QToolBar
 {
@@ -24,37 +27,59 @@ public:
     explicit VisualNavbar(MainWindow *main, QWidget *parent = nullptr);
 
 public slots:
-    void paintEvent(QPaintEvent *event) override;
-    void updateGraphicsScene();
+    /**
+     * @brief Render the blocks again, e.g. after the colors changed
+     */
+    void updateImage();
 
 private slots:
     void fetchAndPaintData();
-    void fetchStats();
-    void drawSeekCursor();
+    void fetchComments();
+    void onDataReady(AnalysisDataStore::Kind kind);
+    void onStringsAppended(int first, int last);
     void drawPCCursor();
-    void drawCursor(RVA addr, QColor color, QGraphicsRectItem *&graphicsItem);
     void on_seekChanged(RVA addr);
 
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private:
-    QGraphicsView     *graphicsView;
-    QGraphicsScene    *graphicsScene;
-    QGraphicsRectItem *seekGraphicsItem;
-    QGraphicsRectItem *PCGraphicsItem;
+    // The blocks are painted into a cached image, only the cursors are painted on every update
+    QWidget           *strip;
+    QImage             image;
     MainWindow        *main;
 
+    AddressDensityIndex density;
     BlockStatistics    stats;
-    unsigned int       statsWidth = 0;
-    unsigned int       previousWidth = 0;
+    int                statsWidth = 0;
+    // Strings already counted in density, the list grows while it is fetched
+    QSharedPointer<const CompactStringList> countedStrings;
+    int                countedStringsRows = 0;
+
+    // Entropy and byte classes of the file painted over the blocks
+    QAction           *entropyAction;
+
+    RVA                seekAddress = RVA_INVALID;
+    RVA                pcAddress = RVA_INVALID;
+
+    // Sorted by address and by x, the blocks are contiguous
+    std::vector<XToAddress> xToAddress;
+
+    void fillDensity(AnalysisDataStore::Kind kind);
+    void countStrings(int first);
+    void updateStats();
 
-    QList<XToAddress> xToAddress;
+    void paintStrip();
+    void paintEntropy(QPainter &painter);
+    QRect cursorRect(RVA addr);
+    void updateCursor(RVA &cursor, RVA addr);
 
     RVA localXToAddress(double x);
     double addressToLocalX(RVA address);
     QList<QString> sectionsForAddress(RVA address);
     QString toolTipForAddress(RVA address);
 
-    void mousePressEvent(QMouseEvent *event) override;
-    void mouseMoveEvent(QMouseEvent *event) override;
+    void stripMouseEvent(QMouseEvent *event);
 };
 
 #endif // VISUALNAVBAR_H